@@ -52,6 +52,24 @@ std::string calculateSHA256Text(std::filesystem::path const& path) {
     return picosha2::bytes_to_hex_string(hash.begin(), hash.end());
 }
 
+class IncrementalHash::Impl final {
+public:
+    picosha2::hash256_one_by_one hasher;
+};
+
+IncrementalHash::IncrementalHash() : m_impl(std::make_unique<Impl>()) {}
+IncrementalHash::~IncrementalHash() = default;
+IncrementalHash::IncrementalHash(IncrementalHash&&) = default;
+IncrementalHash& IncrementalHash::operator=(IncrementalHash&&) = default;
+
+void IncrementalHash::update(std::span<const uint8_t> data) {
+    m_impl->hasher.process(data.begin(), data.end());
+}
+std::string IncrementalHash::finish() {
+    m_impl->hasher.finish();
+    return picosha2::get_hash_hex_string(m_impl->hasher);
+}
+
 std::string calculateHash(std::span<const uint8_t> data) {
     std::vector<uint8_t> hash(picosha2::k_digest_size);
     picosha2::hash256(data.begin(), data.end(), hash);
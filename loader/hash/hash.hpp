@@ -3,6 +3,7 @@
 #include <string>
 #include <filesystem>
 #include <span>
+#include <memory>
 
 std::string calculateSHA3_256(std::filesystem::path const& path);
 
@@ -15,3 +16,26 @@ std::string calculateSHA256Text(std::filesystem::path const& path);
  * used for verifying mods.
  */
 std::string calculateHash(std::span<const uint8_t> data);
+
+/**
+ * Calculates the SHA256 hash of data that arrives in chunks, for verifying 
+ * mods as they are downloaded
+ */
+class IncrementalHash final {
+private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+
+public:
+    IncrementalHash();
+    ~IncrementalHash();
+    IncrementalHash(IncrementalHash&&);
+    IncrementalHash& operator=(IncrementalHash&&);
+
+    void update(std::span<const uint8_t> data);
+    /**
+     * Get the hash of all the data so far, in the same format as 
+     * calculateHash
+     */
+    std::string finish();
+};
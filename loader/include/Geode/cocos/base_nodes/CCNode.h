@@ -998,10 +998,24 @@ public:
     GEODE_DLL geode::Layout* getLayout();
     /**
      * Update the layout of this node using the current Layout. If no layout is 
-     * set, nothing happens
+     * set, nothing happens. If the layout has deferred updates enabled, the 
+     * node is only marked dirty and the layout is applied before the next 
+     * frame is drawn
      * @note Geode addition
      */
     GEODE_DLL void updateLayout(bool updateChildOrder = true);
+    /**
+     * Update the layout of this node using the current Layout right away, 
+     * even if the layout has deferred updates enabled. If no layout is set, 
+     * nothing happens
+     * @note Geode addition
+     */
+    GEODE_DLL void updateLayoutImmediate(bool updateChildOrder = true);
+    /**
+     * Check if this node has a pending deferred layout update
+     * @note Geode addition
+     */
+    GEODE_DLL bool isLayoutDirty();
     /**
      * Set the layout options for this node. Layout options can be used to 
      * control how this node is positioned in its parent's Layout, for example 
@@ -22,6 +22,7 @@ protected:
     cocos2d::CCArray* getNodesToPosition(cocos2d::CCNode* forNode) const;
 
     bool m_ignoreInvisibleChildren = false;
+    bool m_deferUpdates = false;
 
 public:
     /**
@@ -41,6 +42,26 @@ public:
     void ignoreInvisibleChildren(bool ignore);
     bool isIgnoreInvisibleChildren() const;
 
+    /**
+     * If enabled, CCNode::updateLayout on a node with this layout only marks 
+     * the node as dirty instead of applying the layout immediately. All dirty 
+     * nodes are resolved once per frame right before the scene is drawn, 
+     * parents before their children. Useful for nodes whose content changes 
+     * many times while a screen is being built
+     * @note Use CCNode::updateLayoutImmediate if you need the layout to be 
+     * applied synchronously (for example to read back the resulting content 
+     * size)
+     */
+    void deferUpdates(bool defer);
+    bool isDeferUpdates() const;
+
+    /**
+     * Apply the layouts of all nodes that have been marked dirty through 
+     * deferred updates. This is automatically called once per frame, so 
+     * there is usually no need to call this manually
+     */
+    static void applyDeferred();
+
     virtual ~Layout() = default;
 };
 
@@ -36,8 +36,10 @@ namespace geode {
         cocos2d::ccColor3B m_secondaryCellColor;
         GLubyte m_cellOpacity;
         cocos2d::ccColor4B m_cellBorderColor;
+        size_t m_culledCellCount = 0;
 
         void setupList(float) override;
+        void visit() override;
         TableViewCell* getListCell(char const* key) override;
         void loadCell(TableViewCell* cell, int index) override;
         void updateAllCells();
@@ -62,5 +64,11 @@ namespace geode {
         void setSecondaryCellColor(cocos2d::ccColor3B color);
         void setCellOpacity(GLubyte opacity);
         void setCellBorderColor(cocos2d::ccColor4B color);
+
+        /**
+         * Get the number of cells outside of the visible area that were 
+         * skipped during the last visit
+         */
+        size_t getCulledCellCount() const;
     };
 }
@@ -4,8 +4,11 @@
 #include "TextRenderer.hpp"
 
 #include <Geode/binding/FLAlertLayerProtocol.hpp>
+#include "../loader/Event.hpp"
+#include "../utils/Task.hpp"
 
 struct MDParser;
+struct MDRenderPlan;
 class CCScrollLayerExt;
 
 namespace geode {
@@ -42,6 +45,13 @@ namespace geode {
         CCScrollLayerExt* m_scrollLayer = nullptr;
         TextRenderer* m_renderer = nullptr;
 
+        using MDParseTask = Task<std::shared_ptr<MDRenderPlan const>>;
+
+        bool m_asyncRendering = false;
+        bool m_renderInProgress = false;
+        size_t m_renderGeneration = 0;
+        EventListener<MDParseTask> m_parseListener;
+
         bool init(std::string const& str, cocos2d::CCSize const& size);
 
         virtual ~MDTextArea();
@@ -51,6 +61,7 @@ namespace geode {
         void onGDLevel(CCObject*);
         void onGeodeMod(CCObject*);
         void FLAlert_Clicked(FLAlertLayer*, bool btn) override;
+        void onParsed(MDParseTask::Event* event);
 
         friend struct ::MDParser;
 
@@ -66,10 +77,24 @@ namespace geode {
 
         /**
          * Update the label's content; call
-         * sparingly as rendering may be slow
+         * sparingly as rendering may be slow.
+         * Parsed strings are cached, so showing
+         * the same string again only has to
+         * create the nodes
          */
         void updateLabel();
 
+        /**
+         * Parse markdown on a background thread
+         * and create the nodes over multiple
+         * frames instead of all at once, so long
+         * strings don't freeze the game. The old
+         * content stays until parsing is done.
+         * Disabled by default
+         */
+        void setAsyncRendering(bool async);
+        bool isAsyncRendering() const;
+
         void setString(char const* text) override;
         char const* getString() override;
 
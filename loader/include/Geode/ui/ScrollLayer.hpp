@@ -10,10 +10,23 @@ namespace geode {
      * a generic content layer
      */
     class GEODE_DLL GenericContentLayer : public CCContentLayer {
+    protected:
+        size_t m_culledChildCount = 0;
+
     public:
         static GenericContentLayer* create(float width, float height);
 
         void setPosition(cocos2d::CCPoint const& pos) override;
+        /**
+         * Children that are entirely outside of the parent scroll layer's 
+         * clipped area are skipped when drawing
+         */
+        void visit() override;
+
+        /**
+         * Get the number of children skipped during the last visit
+         */
+        size_t getCulledChildCount() const;
     };
 
     class GEODE_DLL ScrollLayer : public CCScrollLayerExt {
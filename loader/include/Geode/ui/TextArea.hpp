@@ -2,6 +2,7 @@
 
 #include <Geode/DefaultInclude.hpp>
 #include <cocos2d.h>
+#include <string_view>
 
 namespace geode {
     enum WrappingMode {
@@ -67,12 +68,13 @@ namespace geode {
         float m_lineHeight = 0.f;
         float m_linePadding = 0.f;
 
+        bool addLine(std::vector<std::string>& lines, std::string line);
         cocos2d::CCLabelBMFont* createLabel(const std::string& text, float top);
         float calculateOffset(cocos2d::CCLabelBMFont* label);
-        void charIteration(const std::function<cocos2d::CCLabelBMFont*(cocos2d::CCLabelBMFont* line, char c, float top)>& overflowHandling);
-        void updateLinesNoWrap();
-        void updateLinesWordWrap(bool spaceWrap);
-        void updateLinesCutoffWrap();
+        std::vector<std::string> charIteration(const std::function<bool(std::vector<std::string>& lines, std::string_view c)>& overflowHandling);
+        std::vector<std::string> updateLinesNoWrap();
+        std::vector<std::string> updateLinesWordWrap(bool spaceWrap);
+        std::vector<std::string> updateLinesCutoffWrap();
         void updateContainer();
     };
 }
@@ -843,6 +843,24 @@ namespace geode {
          */
         template <std::invocable<Type*> Mapper>
         auto chain(Mapper mapper, std::string_view name = "<Chained Task>") const -> decltype(mapper(std::declval<Type*>())) {
+            return this->chain(std::move(mapper), nullptr, name);
+        }
+
+        /**
+         * Create a new Task that listens to this Task and maps the values using
+         * the provided function. The new Task will only start when this Task finishes.
+         * @param mapper Function that makes a new task given the finished value of this task.
+         * The function signature should be `Task<NewType, NewProgress>(T*)`, and it will be executed
+         * on the main thread.
+         * @param progressMapper Function that converts the progress values of this 
+         * task to the progress type of the new task, so progress is reported 
+         * for the whole chain
+         * @param name The name of the Task; used for debugging.
+         * @return The new Task that will run when this Task finishes.
+         */
+        template <std::invocable<Type*> Mapper, class ProgressMapper>
+            requires std::is_null_pointer_v<ProgressMapper> || std::invocable<ProgressMapper, P*>
+        auto chain(Mapper mapper, ProgressMapper progressMapper, std::string_view name = "<Chained Task>") const -> decltype(mapper(std::declval<Type*>())) {
             using NewTask = decltype(mapper(std::declval<Type*>()));
             using NewType = typename NewTask::Value;
             using NewProgress = typename NewTask::Progress;
@@ -868,7 +886,11 @@ namespace geode {
             task.m_handle->m_extraData = std::make_unique<typename NewTask::Handle::ExtraData>(
                 // make the first event listener that waits for the current task
                 static_cast<void*>(new EventListener<Task>(
-                    [handle = std::weak_ptr(task.m_handle), mapper = std::move(mapper)](Event* event) mutable {
+                    [
+                        handle = std::weak_ptr(task.m_handle),
+                        mapper = std::move(mapper),
+                        progressMapper = std::move(progressMapper)
+                    ](Event* event) mutable {
                         if (auto v = event->getValue()) {
                             auto newInnerTask = mapper(v);
                             // this is scary.. but it doesn't seem to crash lol
@@ -898,9 +920,12 @@ namespace geode {
                             );
                         }
                         else if (auto p = event->getProgress()) {
-                            // no guarantee P and NewProgress are compatible
-                            // nor does it seem like the intended behavior?
-                            // TODO: maybe add a mapper for progress?
+                            // no guarantee P and NewProgress are compatible, 
+                            // so progress is only sent through if there's a 
+                            // mapper for it
+                            if constexpr (!std::is_null_pointer_v<ProgressMapper>) {
+                                NewTask::progress(handle.lock(), std::move(progressMapper(p)));
+                            }
                         }
                         else if (event->isCancelled()) {
                             NewTask::cancel(handle.lock());
@@ -9,6 +9,7 @@
 #include <Geode/DefaultInclude.hpp>
 #include <Geode/utils/string.hpp>
 #include <filesystem>
+#include <span>
 #include <string>
 #include <unordered_set>
 
@@ -67,8 +68,6 @@ namespace geode::utils::file {
         std::filesystem::path const& path, bool recursive = false
     );
 
-    class Unzip;
-
     class GEODE_DLL Zip final {
     public:
         using Path = std::filesystem::path;
@@ -83,9 +82,6 @@ namespace geode::utils::file {
         Result<> addAllFromRecurse(
             Path const& dir, Path const& entry
         );
-
-        // for sharing Impl
-        friend class Unzip;
     
     public:
         Zip(Zip const&) = delete;
@@ -144,9 +140,14 @@ namespace geode::utils::file {
         Result<> addFolder(Path const& entry);
     };
 
+    /**
+     * Reads zips by mapping them into memory and indexing their central 
+     * directory once. Reading entries doesn't change any state, so a single 
+     * Unzip can be read from multiple threads at once
+     */
     class GEODE_DLL Unzip final {
     private:
-        using Impl = Zip::Impl;
+        class Impl;
         std::unique_ptr<Impl> m_impl;
 
         Unzip();
@@ -179,6 +180,14 @@ namespace geode::utils::file {
             std::function<void(uint32_t, uint32_t)> callback
         );
 
+        /**
+         * Limit how many threads Unzip::extractAllTo may use. Zips with fewer 
+         * than 32 files are always extracted on the calling thread
+         * @param count Maximum number of threads, or 0 (the default) to use 
+         * up to one per hardware thread
+         */
+        void setMaxWorkerCount(size_t count);
+
         /**
          * Path to the opened zip
          * @returns The path to the zip that is being read, or an empty path 
@@ -196,6 +205,27 @@ namespace geode::utils::file {
          */
         bool hasEntry(Path const& name);
 
+        /**
+         * Get the size of an entry once extracted
+         * @param name Entry path in zip
+         */
+        Result<size_t> getEntrySize(Path const& name) const;
+        /**
+         * Get the contents of an entry that is stored without compression, 
+         * without copying them
+         * @param name Entry path in zip
+         * @returns A span into the zip that is valid for as long as this 
+         * Unzip is, or an error if the entry is compressed
+         */
+        Result<std::span<const uint8_t>> view(Path const& name) const;
+        /**
+         * Extract entry into a buffer provided by the caller, decompressing 
+         * it directly into the buffer if needed
+         * @param name Entry path in zip
+         * @param buffer Buffer exactly as large as the entry (see 
+         * Unzip::getEntrySize)
+         */
+        Result<> extractInto(Path const& name, std::span<uint8_t> buffer) const;
         /**
          * Extract entry to memory
          * @param name Entry path in zip
@@ -208,7 +238,9 @@ namespace geode::utils::file {
          */
         Result<> extractTo(Path const& name, Path const& path);
         /**
-         * Extract all entries to directory
+         * Extract all entries to directory. Larger zips are written out on 
+         * multiple threads, but the progress callback is only ever called 
+         * from the thread this is called on
          * @param dir Directory to unzip the contents to
          */
         Result<> extractAllTo(Path const& dir);
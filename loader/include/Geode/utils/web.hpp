@@ -5,7 +5,9 @@
 #include <Geode/Result.hpp>
 #include "Task.hpp"
 #include <chrono>
+#include <functional>
 #include <optional>
+#include <span>
 
 namespace geode::utils::web {
     GEODE_DLL void openLinkInBrowser(std::string const& url);
@@ -37,6 +39,19 @@ namespace geode::utils::web {
         VERSION_3ONLY = 31
     };
 
+    // How a WebRequest uses the response cache on disk
+    enum class CachePolicy {
+        // Don't use the cache
+        None,
+        // Use a cached response without asking the server while it's fresh 
+        // according to its Cache-Control or Expires headers, and revalidate 
+        // it with the server once it's stale
+        Default,
+        // Always revalidate cached responses with the server, which can then 
+        // answer with 304 Not Modified instead of the whole response
+        Revalidate,
+    };
+
     // https://curl.se/libcurl/c/CURLOPT_PROXYTYPE.html
     enum class ProxyType {
         HTTP, // HTTP
@@ -79,6 +94,11 @@ namespace geode::utils::web {
         Result<std::string> string() const;
         Result<matjson::Value> json() const;
         ByteVector data() const;
+        /**
+         * Size of the response body in bytes, without copying it like 
+         * `data().size()` would
+         */
+        size_t size() const;
         Result<> into(std::filesystem::path const& path) const;
 
         std::vector<std::string> headers() const;
@@ -117,6 +137,56 @@ namespace geode::utils::web {
 
     using WebTask = Task<WebResponse, WebProgress>;
 
+    /**
+     * The parts of a multipart/form-data request body. Parts are sent in 
+     * the order they're added, and are streamed to the server one at a time 
+     * instead of being put together in memory first
+     */
+    class GEODE_DLL MultipartForm final {
+    private:
+        class Impl;
+
+        std::shared_ptr<Impl> m_impl;
+
+        friend class WebRequest;
+
+    public:
+        MultipartForm();
+
+        /**
+         * Add a plain text field
+         * @param name The name of the field
+         * @param value The value of the field
+         * @return MultipartForm&
+         */
+        MultipartForm& param(std::string_view name, std::string_view value);
+        /**
+         * Add a file from memory. Pass the data as an rvalue to avoid 
+         * copying it
+         * @param name The name of the field
+         * @param data The contents of the file
+         * @param filename The filename sent to the server
+         * @param mimeType The MIME type of the file
+         * @return MultipartForm&
+         */
+        MultipartForm& data(
+            std::string_view name, ByteVector data, std::string_view filename,
+            std::string_view mimeType = "application/octet-stream"
+        );
+        /**
+         * Add a file from disk. The file is read while the request is sent, 
+         * so it must still exist then
+         * @param name The name of the field
+         * @param path The file to send; its filename is sent to the server
+         * @param mimeType The MIME type of the file
+         * @return MultipartForm&
+         */
+        MultipartForm& file(
+            std::string_view name, std::filesystem::path const& path,
+            std::string_view mimeType = "application/octet-stream"
+        );
+    };
+
     class GEODE_DLL WebRequest final {
     private:
         class Impl;
@@ -249,7 +319,24 @@ namespace geode::utils::web {
         WebRequest& version(HttpVersion httpVersion);
 
         /**
-         * Sets the body of the request to a byte vector.
+         * Sets how the request uses the response cache on disk, which keeps 
+         * responses between launches. Only GET requests without a range, 
+         * whose body isn't streamed through onResponseChunk or downloadInto, 
+         * and that don't send an Authorization or Cookie header, are cached. 
+         * Responses are stored unless they're marked no-store, or have no 
+         * lifetime and nothing to revalidate them with, and are only reused 
+         * for requests that send the same headers they Vary on. A 304 
+         * from the server is turned into the cached response, so the caller 
+         * always sees the full response. The default is CachePolicy::None
+         *
+         * @param policy
+         * @return WebRequest&
+         */
+        WebRequest& cachePolicy(CachePolicy policy);
+
+        /**
+         * Sets the body of the request to a byte vector. Pass the vector as 
+         * an rvalue to avoid copying it.
          *
          * @param raw The raw bytes to set as the body.
          * @return WebRequest&
@@ -269,6 +356,67 @@ namespace geode::utils::web {
          * @return WebRequest&
          */
         WebRequest& bodyJSON(matjson::Value const& json);
+        /**
+         * Sets the body of the request to the contents of a file. The file 
+         * is streamed while the request is sent instead of being read into 
+         * memory, so it must still exist then.
+         *
+         * @param path The file to send as the body.
+         * @return WebRequest&
+         */
+        WebRequest& bodyFile(std::filesystem::path const& path);
+        /**
+         * Sets the body of the request to a multipart/form-data form. The 
+         * Content-Type header is set automatically.
+         *
+         * @param form The form to send as the body.
+         * @return WebRequest&
+         */
+        WebRequest& bodyMultipart(MultipartForm const& form);
+
+        /**
+         * Receive the body of a successful (2xx) response in chunks as it is 
+         * downloaded, instead of collecting it into the WebResponse. The 
+         * callback is called in order on a thread of this request's own, so 
+         * it may block (for example to write to disk or hash the data) 
+         * without holding up other requests; the download is paused while 
+         * it falls behind. Bodies of error responses are still collected 
+         * into the WebResponse as usual
+         *
+         * @param callback Called with every received chunk; return false to 
+         * abort the request
+         * @return WebRequest&
+         */
+        WebRequest& onResponseChunk(std::function<bool(std::span<const uint8_t>)> callback);
+
+        /**
+         * Called on the same thread as onResponseChunk once the body of a 
+         * successful (2xx) response starts arriving, before any of it is 
+         * passed to onResponseChunk. Useful for checking the status code and 
+         * headers of a streamed response, for example whether a range 
+         * request was honored. If the body isn't streamed through 
+         * onResponseChunk or downloadInto, it's still collected into the 
+         * WebResponse as usual after this returns true. Requests with this 
+         * set are never served from or stored in the cache
+         *
+         * @param callback Called with the response's code and headers (the 
+         * body is not available yet); return false to abort the request
+         * @return WebRequest&
+         */
+        WebRequest& onResponseStart(std::function<bool(WebResponse const&)> callback);
+
+        /**
+         * Write the body of a successful (2xx) response straight into a file 
+         * as it is downloaded, instead of keeping it in memory. The 
+         * WebResponse then only carries the status code and headers. The 
+         * file is overwritten if it exists, and removed again if the request 
+         * fails or is cancelled. Bodies of error responses are still 
+         * collected into the WebResponse as usual
+         *
+         * @param path The file to write the body into
+         * @return WebRequest&
+         */
+        WebRequest& downloadInto(std::filesystem::path const& path);
 
         /**
          * Gets the unique request ID
@@ -307,7 +455,8 @@ namespace geode::utils::web {
         std::unordered_map<std::string, std::string> getUrlParams() const;
 
         /**
-         * Gets the post body stream
+         * Gets the post body stream. Bodies set through bodyFile or 
+         * bodyMultipart aren't kept in memory, so this is nullopt for them
          *
          * @return std::optional<ByteVector>
          */
@@ -327,4 +476,18 @@ namespace geode::utils::web {
          */
         HttpVersion getHttpVersion() const;
     };
+
+    /**
+     * Get the number of requests that are currently in flight, from being 
+     * sent until they finish or are cancelled. Cache lookups count as well
+     */
+    GEODE_DLL size_t getActiveRequestCount();
+
+    /**
+     * Posted on the main thread when the last request in flight finishes, 
+     * which makes it a good moment to start low priority background work. 
+     * Check getActiveRequestCount again when it arrives, since another 
+     * request may have been sent in the meantime
+     */
+    class GEODE_DLL WebIdleEvent final : public Event {};
 }
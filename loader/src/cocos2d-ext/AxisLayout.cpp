@@ -8,7 +8,9 @@
 using namespace geode::prelude;
 
 // if 5k iterations isn't enough to fit the layout, then something is wrong
-static size_t RECURSION_DEPTH_LIMIT = 5000;
+static size_t FIT_ITERATION_LIMIT = 5000;
+// same but for fitting the nodes in a single row
+static size_t ROW_FIT_ITERATION_LIMIT = 1001;
 
 static AxisLayoutOptions const* axisOpts(CCNode* node) {
     if (!node) return nullptr;
@@ -302,111 +304,172 @@ public:
         return gap.value_or(ix ? m_gap : 0);
     }
 
-    Row* fitInRow(
-        CCNode* on, CCArray* nodes,
+    struct RowMetrics {
+        float axisUnsquishedLength = 0.f;
+        float axisLength = 0.f;
+        float crossLength = 0.f;
+        // how many nodes made it into the row
+        unsigned int count = 0;
+    };
+
+    // Measure the nodes in [begin, end) laid out as a single row with the 
+    // given scale, squish and prio. Stops at the first node that would 
+    // overflow the row (or right after a node that forces a line break) if 
+    // growing the cross axis is enabled
+    RowMetrics measureRow(
+        CCArray* nodes, unsigned int begin, unsigned int end,
+        float availableLength,
         std::pair<int, int> const& minMaxPrios,
-        bool doAutoScale,
         float scale, float squish, int prio
     ) const {
-        float nextAxisScalableLength;
-        float nextAxisUnscalableLength;
-        float axisUnsquishedLength;
-        float axisLength;
-        float crossLength;
-        auto res = CCArray::create();
-
-        auto available = nodeAxis(on, m_axis, 1.f / on->getScale());
-
-        auto fit = [&](CCArray* nodes) {
-            nextAxisScalableLength = 0.f;
-            nextAxisUnscalableLength = 0.f;
-            axisUnsquishedLength = 0.f;
-            axisLength = 0.f;
-            crossLength = 0.f;
-            AxisLayoutOptions const* prev = nullptr;
-            size_t ix = 0;
-            for (auto& node : CCArrayExt<CCNode*>(nodes)) {
-                auto opts = axisOpts(node);
-                if (this->shouldAutoScale(opts)) {
-                    node->setScale(1.f);
-                }
-                auto nodeScale = scaleByOpts(opts, scale, prio, false, m_defaultScaleLimits.first, m_defaultScaleLimits.second);
-                auto pos = nodeAxis(node, m_axis, nodeScale * squish);
-                auto squishPos = nodeAxis(node, m_axis, scaleByOpts(opts, scale, prio, true, m_defaultScaleLimits.first, m_defaultScaleLimits.second));
-                if (prio == optsScalePrio(opts)) {
-                    nextAxisScalableLength += pos.axisLength;
+        RowMetrics res;
+        float nextAxisScalableLength = 0.f;
+        float nextAxisUnscalableLength = 0.f;
+        AxisLayoutOptions const* prev = nullptr;
+        size_t ix = 0;
+        for (auto i = begin; i < end; i++) {
+            auto node = static_cast<CCNode*>(nodes->objectAtIndex(i));
+            auto opts = axisOpts(node);
+            if (this->shouldAutoScale(opts)) {
+                node->setScale(1.f);
+            }
+            auto nodeScale = scaleByOpts(opts, scale, prio, false, m_defaultScaleLimits.first, m_defaultScaleLimits.second);
+            auto pos = nodeAxis(node, m_axis, nodeScale * squish);
+            auto squishPos = nodeAxis(node, m_axis, scaleByOpts(opts, scale, prio, true, m_defaultScaleLimits.first, m_defaultScaleLimits.second));
+            if (prio == optsScalePrio(opts)) {
+                nextAxisScalableLength += pos.axisLength;
+            }
+            else {
+                nextAxisUnscalableLength += pos.axisLength;
+            }
+            // if multiple rows are allowed and this row is full, time for the 
+            // next row
+            // also force at least one object to be added to this row, because if 
+            // it's too large for this row it's gonna be too large for all rows
+            if (
+                m_growCrossAxis && (
+                    (nextAxisScalableLength + nextAxisUnscalableLength > availableLength) && 
+                    ix != 0 && !isOptsSameLine(opts)
+                )
+            ) {
+                break;
+            }
+            res.count += 1;
+            if (ix) {
+                auto gap = nextGap(prev, opts, ix);
+                // if we've exhausted all priority scale options, scale gap too
+                if (prio == minMaxPrios.first) {
+                    nextAxisScalableLength += gap * scale * squish;
+                    res.axisLength += gap * scale * squish;
+                    res.axisUnsquishedLength += gap * scale;
                 }
                 else {
-                    nextAxisUnscalableLength += pos.axisLength;
-                }
-                // if multiple rows are allowed and this row is full, time for the 
-                // next row
-                // also force at least one object to be added to this row, because if 
-                // it's too large for this row it's gonna be too large for all rows
-                if (
-                    m_growCrossAxis && (
-                        (nextAxisScalableLength + nextAxisUnscalableLength > available.axisLength) && 
-                        ix != 0 && !isOptsSameLine(opts)
-                    )
-                ) {
-                    break;
-                }
-                if (nodes != res) {
-                    res->addObject(node);
-                }
-                if (ix) {
-                    auto gap = nextGap(prev, opts, ix);
-                    // if we've exhausted all priority scale options, scale gap too
-                    if (prio == minMaxPrios.first) {
-                        nextAxisScalableLength += gap * scale * squish;
-                        axisLength += gap * scale * squish;
-                        axisUnsquishedLength += gap * scale;
-                    }
-                    else {
-                        nextAxisUnscalableLength += gap * squish;
-                        axisLength += gap * squish;
-                        axisUnsquishedLength += gap;
-                    }
-                }
-                axisLength += pos.axisLength;
-                axisUnsquishedLength += squishPos.axisLength;
-                // squishing doesn't affect cross length, that's done separately
-                if (pos.crossLength / squish > crossLength) {
-                    crossLength = pos.crossLength / squish;
+                    nextAxisUnscalableLength += gap * squish;
+                    res.axisLength += gap * squish;
+                    res.axisUnsquishedLength += gap;
                 }
-                prev = opts;
-                if (m_growCrossAxis && isOptsBreakLine(opts)) {
-                    break;
-                }
-                ix++;
             }
-        };
+            res.axisLength += pos.axisLength;
+            res.axisUnsquishedLength += squishPos.axisLength;
+            // squishing doesn't affect cross length, that's done separately
+            if (pos.crossLength / squish > res.crossLength) {
+                res.crossLength = pos.crossLength / squish;
+            }
+            prev = opts;
+            if (m_growCrossAxis && isOptsBreakLine(opts)) {
+                break;
+            }
+            ix++;
+        }
+        return res;
+    }
+
+    // Fit as many nodes as possible starting from `offset` into a row, and 
+    // advance `offset` past them
+    Row* fitInRow(
+        CCNode* on, CCArray* nodes, unsigned int& offset,
+        std::pair<int, int> const& minMaxPrios,
+        bool doAutoScale,
+        float scale, float squish, int prio
+    ) const {
+        auto available = nodeAxis(on, m_axis, 1.f / on->getScale());
 
-        fit(nodes);
+        auto begin = offset;
+        auto fit = this->measureRow(
+            nodes, begin, nodes->count(), available.axisLength,
+            minMaxPrios, scale, squish, prio
+        );
+        auto end = begin + fit.count;
+        offset = end;
 
-        // whoops! removing objects from a CCArray while iterating is totes potes UB
-        for (int i = 0; i < res->count(); i++) {
-            nodes->removeFirstObject();
+        auto res = CCArray::createWithCapacity(fit.count);
+        for (auto i = begin; i < end; i++) {
+            res->addObject(nodes->objectAtIndex(i));
         }
 
-        // todo: make this calculation more smart to avoid so much unnecessary recursion
         auto scaleDownFactor = scale - .002f;
-        auto squishFactor = available.axisLength / (axisUnsquishedLength + .01f) * squish;
+        auto squishFactor = available.axisLength / (fit.axisUnsquishedLength + .01f) * squish;
 
         // calculate row scale, squish, and prio
-        int tries = 1000;
-        while (axisLength > available.axisLength) {
-            if (this->canTryScalingDown(res, prio, scale, scale - .002f, minMaxPrios)) {
-                scale -= .002f;
+        // the row only gets shorter as the scale goes down, so rather than 
+        // trying every scale step one by one, the steps available in the 
+        // current prio are binary searched for the first one that fits
+        auto const minScale = this->minScaleForPrio(res, prio);
+        size_t iterations = 0;
+        std::vector<float> steps;
+        while (fit.axisLength > available.axisLength && iterations < ROW_FIT_ITERATION_LIMIT) {
+            steps.clear();
+            for (auto s = scale; iterations + steps.size() < ROW_FIT_ITERATION_LIMIT;) {
+                auto next = s - .002f;
+                if (next < minScale || fabsf(next - s) < .001f) {
+                    break;
+                }
+                s = next - .002f;
+                steps.push_back(s);
             }
-            else {
-                squish = available.axisLength / axisUnsquishedLength;
+            if (steps.size()) {
+                size_t lo = 0;
+                size_t hi = steps.size();
+                while (lo < hi) {
+                    auto mid = lo + (hi - lo) / 2;
+                    auto probe = this->measureRow(
+                        nodes, begin, end, available.axisLength,
+                        minMaxPrios, steps[mid], squish, prio
+                    );
+                    if (probe.axisLength > available.axisLength) {
+                        lo = mid + 1;
+                    }
+                    else {
+                        hi = mid;
+                    }
+                }
+                auto step = std::min(lo, steps.size() - 1);
+                scale = steps[step];
+                iterations += step + 1;
             }
-            fit(res);
-            // Avoid infinite loops
-            if (tries-- <= 0) {
-                break;
+            // out of scale steps in this prio, so either move on to the next 
+            // prio or squish
+            else {
+                auto prevScale = scale;
+                auto prevSquish = squish;
+                auto prevPrio = prio;
+                if (this->canTryScalingDown(res, prio, scale, scale - .002f, minMaxPrios)) {
+                    scale -= .002f;
+                }
+                else {
+                    squish = available.axisLength / fit.axisUnsquishedLength;
+                }
+                iterations += 1;
+                // nothing changed, so trying again would just give the same 
+                // result over and over again
+                if (scale == prevScale && squish == prevSquish && prio == prevPrio) {
+                    break;
+                }
             }
+            fit = this->measureRow(
+                nodes, begin, end, available.axisLength,
+                minMaxPrios, scale, squish, prio
+            );
         }
 
         // reverse row if needed
@@ -435,120 +498,169 @@ public:
             // how much should the nodes be squished to fit the next item in this 
             // row
             squishFactor,
-            axisLength, crossLength, axisEndsLength,
+            fit.axisLength, fit.crossLength, axisEndsLength,
             res,
             scale, squish, prio
         );
     }
 
-    void tryFitLayout(
+    struct RowsFit {
+        CCArray* rows;
+        float totalRowCrossLength = 0.f;
+        float crossScaleDownFactor = 0.f;
+        float crossSquishFactor = 0.f;
+    };
+
+    RowsFit fitRows(
         CCNode* on, CCArray* nodes,
         std::pair<int, int> const& minMaxPrios,
         bool doAutoScale,
-        float scale, float squish, int prio,
-        size_t depth
+        float scale, float squish, int prio
     ) const {
-        // where do all of these magical calculations come from?
-        // idk i got tired of doing the math but they work so ¯\_(ツ)_/¯ 
-        // like i genuinely have no clue fr why some of these work tho, 
-        // i just threw in random equations and numbers until it worked
+        RowsFit res;
+        res.rows = CCArray::create();
 
-        auto rows = CCArray::create();
-        float maxRowAxisLength = 0.f;
-        float totalRowCrossLength = 0.f;
-        float crossScaleDownFactor = 0.f;
-        float crossSquishFactor = 0.f;
-
-        // make spacers have zero size so they don't affect spacing calculations
-        for (auto& node : CCArrayExt<CCNode*>(nodes)) {
-            if (auto spacer = typeinfo_cast<SpacerNode*>(node)) {
-                spacer->setContentSize(CCSizeZero);
-            }
-        }
-        
         // fit everything into rows while possible
-        size_t ix = 0;
-        auto newNodes = nodes->shallowCopy();
-        while (newNodes->count()) {
+        unsigned int offset = 0;
+        while (offset < nodes->count()) {
             auto row = this->fitInRow(
-                on, newNodes,
+                on, nodes, offset,
                 minMaxPrios, doAutoScale,
                 scale, squish, prio
             );
-            rows->addObject(row);
             if (
-                row->nextOverflowScaleDownFactor > crossScaleDownFactor &&
+                row->nextOverflowScaleDownFactor > res.crossScaleDownFactor &&
                 row->nextOverflowScaleDownFactor < scale
             ) {
-                crossScaleDownFactor = row->nextOverflowScaleDownFactor;
+                res.crossScaleDownFactor = row->nextOverflowScaleDownFactor;
             }
             if (
-                row->nextOverflowSquishFactor > crossSquishFactor &&
+                row->nextOverflowSquishFactor > res.crossSquishFactor &&
                 row->nextOverflowSquishFactor < squish
             ) {
-                crossSquishFactor = row->nextOverflowSquishFactor;
-            }
-            totalRowCrossLength += row->crossLength;
-            if (ix) {
-                totalRowCrossLength += m_gap;
+                res.crossSquishFactor = row->nextOverflowSquishFactor;
             }
-            if (row->axisLength > maxRowAxisLength) {
-                maxRowAxisLength = row->axisLength;
+            res.totalRowCrossLength += row->crossLength;
+            if (res.rows->count()) {
+                res.totalRowCrossLength += m_gap;
             }
-            ix++;
+            res.rows->addObject(row);
         }
-        newNodes->release();
+        return res;
+    }
 
-        if (!rows->count()) {
-            return;
+    void tryFitLayout(
+        CCNode* on, CCArray* nodes,
+        std::pair<int, int> const& minMaxPrios,
+        bool doAutoScale,
+        float scale, float squish, int prio
+    ) const {
+        // where do all of these magical calculations come from?
+        // idk i got tired of doing the math but they work so ¯\_(ツ)_/¯ 
+        // like i genuinely have no clue fr why some of these work tho, 
+        // i just threw in random equations and numbers until it worked
+
+        // make spacers have zero size so they don't affect spacing calculations
+        for (auto& node : CCArrayExt<CCNode*>(nodes)) {
+            if (auto spacer = typeinfo_cast<SpacerNode*>(node)) {
+                spacer->setContentSize(CCSizeZero);
+            }
         }
 
         auto available = nodeAxis(on, m_axis, 1.f / on->getScale());
-        if (available.axisLength <= 0.f) {
-            return;
-        }
 
-        // if cross axis overflow not allowed and it's overflowing, try to scale 
-        // down layout if there are any nodes with auto-scale enabled (or 
-        // auto-scale is enabled by default)
-        if (
-            !m_allowCrossAxisOverflow && 
-            doAutoScale && 
-            totalRowCrossLength > available.crossLength && 
-            depth < RECURSION_DEPTH_LIMIT
-        ) {
-            if (this->canTryScalingDown(nodes, prio, scale, crossScaleDownFactor, minMaxPrios)) {
-                rows->release();
-                return this->tryFitLayout(
-                    on, nodes,
-                    minMaxPrios, doAutoScale,
-                    scale, squish, prio,
-                    depth + 1
-                );
+        // the scale goes down by the same step every time the layout 
+        // overflows on the cross axis, so mirror how the rows calculate it
+        auto nextCrossScale = [](float scale) {
+            auto next = scale - .002f;
+            return next > 0.f && next < scale ? next : 0.f;
+        };
+        auto const minScale = this->minScaleForPrio(nodes, prio);
+
+        size_t iterations = 0;
+        RowsFit fit;
+        std::vector<float> steps;
+        while (true) {
+            auto const prevScale = scale;
+            auto const prevSquish = squish;
+            auto const prevPrio = prio;
+
+            fit = this->fitRows(on, nodes, minMaxPrios, doAutoScale, scale, squish, prio);
+
+            if (!fit.rows->count()) {
+                return;
+            }
+            if (available.axisLength <= 0.f) {
+                return;
             }
-        }
 
-        // if we're still overflowing, squeeze nodes closer together
-        if (
-            !m_allowCrossAxisOverflow &&
-            totalRowCrossLength > available.crossLength && 
-            depth < RECURSION_DEPTH_LIMIT
-        ) {
-            // if squishing rows would take less squishing that squishing columns, 
-            // then squish rows
+            // if cross axis overflow not allowed and it's overflowing, try to scale 
+            // down layout if there are any nodes with auto-scale enabled (or 
+            // auto-scale is enabled by default)
             if (
-                !m_growCrossAxis ||
-                totalRowCrossLength / available.crossLength < crossSquishFactor
+                !m_allowCrossAxisOverflow && 
+                doAutoScale && 
+                fit.totalRowCrossLength > available.crossLength && 
+                iterations < FIT_ITERATION_LIMIT
             ) {
-                rows->release();
-                return this->tryFitLayout(
-                    on, nodes,
-                    minMaxPrios, doAutoScale,
-                    scale, crossSquishFactor, prio,
-                    depth + 1
-                );
+                // the rows get packed differently at every scale, so the total 
+                // cross length doesn't reliably go down along with the scale 
+                // and the steps have to be tried in order
+                steps.clear();
+                for (auto s = scale; iterations + steps.size() < FIT_ITERATION_LIMIT;) {
+                    auto next = nextCrossScale(s);
+                    if (next < minScale || fabsf(next - s) < .001f) {
+                        break;
+                    }
+                    s = next;
+                    steps.push_back(s);
+                }
+                if (steps.size()) {
+                    size_t step = 0;
+                    while (
+                        step + 1 < steps.size() &&
+                        this->fitRows(on, nodes, minMaxPrios, doAutoScale, steps[step], squish, prio)
+                            .totalRowCrossLength > available.crossLength
+                    ) {
+                        step += 1;
+                    }
+                    scale = steps[step];
+                    iterations += step + 1;
+                    continue;
+                }
+                if (this->canTryScalingDown(nodes, prio, scale, fit.crossScaleDownFactor, minMaxPrios)) {
+                    iterations += 1;
+                    continue;
+                }
             }
+
+            // if we're still overflowing, squeeze nodes closer together
+            if (
+                !m_allowCrossAxisOverflow &&
+                fit.totalRowCrossLength > available.crossLength && 
+                iterations < FIT_ITERATION_LIMIT
+            ) {
+                // if squishing rows would take less squishing that squishing columns, 
+                // then squish rows
+                if (
+                    !m_growCrossAxis ||
+                    fit.totalRowCrossLength / available.crossLength < fit.crossSquishFactor
+                ) {
+                    iterations += 1;
+                    squish = fit.crossSquishFactor;
+                    // if nothing changed, every remaining iteration would just 
+                    // give the exact same rows, so might as well stop here
+                    if (scale == prevScale && squish == prevSquish && prio == prevPrio) {
+                        break;
+                    }
+                    continue;
+                }
+            }
+
+            break;
         }
+        auto rows = fit.rows;
+        auto totalRowCrossLength = fit.totalRowCrossLength;
 
         // if we're here, the nodes are ready to be positioned
 
@@ -806,8 +918,7 @@ void AxisLayout::apply(CCNode* on) {
     m_impl->tryFitLayout(
         on, nodes,
         minMaxPrio, doAutoScale,
-        m_impl->maxScaleForPrio(nodes, minMaxPrio.second), 1.f, minMaxPrio.second,
-        0
+        m_impl->maxScaleForPrio(nodes, minMaxPrio.second), 1.f, minMaxPrio.second
     );
 }
 
@@ -97,3 +97,11 @@ void Layout::ignoreInvisibleChildren(bool ignore) {
 bool Layout::isIgnoreInvisibleChildren() const {
     return m_ignoreInvisibleChildren;
 }
+
+void Layout::deferUpdates(bool defer) {
+    m_deferUpdates = defer;
+}
+
+bool Layout::isDeferUpdates() const {
+    return m_deferUpdates;
+}
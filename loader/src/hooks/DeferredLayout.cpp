@@ -0,0 +1,27 @@
+#include <Geode/ui/Layout.hpp>
+
+using namespace geode::prelude;
+
+#include <Geode/modify/CCDirector.hpp>
+#include <Geode/modify/CCScheduler.hpp>
+
+// Deferred layouts are resolved once per frame, after input and scheduled 
+// callbacks have had the chance to mark nodes dirty but before anything is 
+// drawn
+
+struct DeferredLayoutDirector : Modify<DeferredLayoutDirector, CCDirector> {
+    void drawScene() {
+        // Catches anything dirtied by touch / keyboard handlers
+        Layout::applyDeferred();
+        CCDirector::drawScene();
+    }
+};
+
+struct DeferredLayoutScheduler : Modify<DeferredLayoutScheduler, CCScheduler> {
+    void update(float dt) {
+        CCScheduler::update(dt);
+        // Catches anything dirtied by scheduled updates, which CCDirector 
+        // runs inside drawScene right before visiting the scene
+        Layout::applyDeferred();
+    }
+};
@@ -21,6 +21,8 @@ private:
     std::string m_id = "";
     Ref<Layout> m_layout = nullptr;
     Ref<LayoutOptions> m_layoutOptions = nullptr;
+    bool m_layoutDirty = false;
+    bool m_layoutDirtySort = false;
     std::unordered_map<std::string, Ref<CCObject>> m_userObjects;
     std::unordered_set<std::unique_ptr<EventListenerProtocol>> m_eventListeners;
     std::unordered_map<std::string, std::unique_ptr<EventListenerProtocol>> m_idEventListeners;
@@ -327,15 +329,114 @@ LayoutOptions* CCNode::getLayoutOptions() {
     return GeodeNodeMetadata::set(this)->m_layoutOptions.data();
 }
 
+// Nodes whose layout update has been deferred until the next layout pass
+static std::vector<Ref<CCNode>> s_dirtyLayoutNodes;
+
+// if the layouts haven't settled after this many passes, then something is 
+// most likely invalidating itself in a loop
+static constexpr size_t DEFERRED_LAYOUT_PASS_LIMIT = 16;
+
 void CCNode::updateLayout(bool updateChildOrder) {
+    auto meta = GeodeNodeMetadata::set(this);
+    auto layout = meta->m_layout.data();
+    if (layout && layout->isDeferUpdates()) {
+        meta->m_layoutDirtySort |= updateChildOrder;
+        if (!meta->m_layoutDirty) {
+            meta->m_layoutDirty = true;
+            s_dirtyLayoutNodes.push_back(this);
+        }
+        return;
+    }
+    this->updateLayoutImmediate(updateChildOrder);
+}
+
+void CCNode::updateLayoutImmediate(bool updateChildOrder) {
+    auto meta = GeodeNodeMetadata::set(this);
+    // Applying the layout now also takes care of any pending deferred update
+    meta->m_layoutDirty = false;
+    if (std::exchange(meta->m_layoutDirtySort, false)) {
+        updateChildOrder = true;
+    }
     if (updateChildOrder) {
         this->sortAllChildren();
     }
-    if (auto layout = GeodeNodeMetadata::set(this)->m_layout.data()) {
+    if (auto layout = meta->m_layout.data()) {
         layout->apply(this);
     }
 }
 
+bool CCNode::isLayoutDirty() {
+    return GeodeNodeMetadata::set(this)->m_layoutDirty;
+}
+
+static bool hasDeferredLayout(CCNode* node) {
+    auto layout = node ? node->getLayout() : nullptr;
+    return layout && layout->isDeferUpdates();
+}
+
+static size_t getNodeDepth(CCNode* node) {
+    size_t depth = 0;
+    while ((node = node->getParent())) {
+        depth += 1;
+    }
+    return depth;
+}
+
+void Layout::applyDeferred() {
+    size_t pass = 0;
+    while (!s_dirtyLayoutNodes.empty()) {
+        if (pass++ >= DEFERRED_LAYOUT_PASS_LIMIT) {
+            log::warn(
+                "Deferred layouts did not settle after {} passes, {} nodes are still dirty",
+                DEFERRED_LAYOUT_PASS_LIMIT, s_dirtyLayoutNodes.size()
+            );
+            break;
+        }
+
+        // Resolve parents before their children, so a child whose size was 
+        // changed by its parent's layout only needs to be laid out once
+        std::vector<std::pair<size_t, Ref<CCNode>>> nodes;
+        nodes.reserve(s_dirtyLayoutNodes.size());
+        for (auto& node : s_dirtyLayoutNodes) {
+            nodes.emplace_back(getNodeDepth(node), std::move(node));
+        }
+        s_dirtyLayoutNodes.clear();
+        std::stable_sort(nodes.begin(), nodes.end(), [](auto const& a, auto const& b) {
+            return a.first < b.first;
+        });
+
+        std::vector<std::pair<CCNode*, CCSize>> childSizes;
+        for (auto& [_, node] : nodes) {
+            // Skip nodes that were updated synchronously in the meantime, and 
+            // nodes that nobody but this queue is holding onto anymore
+            if (!node->isLayoutDirty() || node->retainCount() == 1) {
+                continue;
+            }
+            auto size = node->getContentSize();
+            childSizes.clear();
+            for (auto child : CCArrayExt<CCNode*>(node->getChildren())) {
+                if (hasDeferredLayout(child)) {
+                    childSizes.emplace_back(child, child->getContentSize());
+                }
+            }
+
+            node->updateLayoutImmediate(false);
+
+            // Propagate size changes to other deferred layouts that depend on 
+            // this node: the parent positions based on its children's sizes, 
+            // and the children lay themselves out based on their own size
+            if (node->getContentSize() != size && hasDeferredLayout(node->getParent())) {
+                node->getParent()->updateLayout(false);
+            }
+            for (auto& [child, childSize] : childSizes) {
+                if (child->getParent() == node && child->getContentSize() != childSize) {
+                    child->updateLayout(false);
+                }
+            }
+        }
+    }
+}
+
 UserObjectSetEvent::UserObjectSetEvent(CCNode* node, std::string const& id, CCObject* value)
   : node(node), id(id), value(value) {}
 
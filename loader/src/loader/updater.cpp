@@ -300,13 +300,16 @@ void updater::downloadLoaderUpdate(std::string const& url) {
     if (RUNNING_REQUESTS.contains("@downloadLoaderUpdate")) return;
 
     auto req = web::WebRequest();
+    // The update is large, so write it straight to disk instead of keeping 
+    // it in memory
+    req.downloadInto(updateZip);
     RUNNING_REQUESTS.emplace(
         "@downloadLoaderUpdate",
         req.get(url).map(
-            [targetDir](web::WebResponse* response) {
+            [targetDir, updateZip](web::WebResponse* response) {
                 if (response->ok()) {
                     // unzip resources zip
-                    auto unzip = file::Unzip::create(response->data());
+                    auto unzip = file::Unzip::create(updateZip);
                     if (unzip) {
                         auto ok = unzip.unwrap().extractAllTo(targetDir);
                         if (ok) {
@@ -336,6 +339,8 @@ void updater::downloadLoaderUpdate(std::string const& url) {
 
                     Mod::get()->setSavedValue("last-modified-auto-update-check", std::string());
                 }
+                std::error_code ec;
+                std::filesystem::remove(updateZip, ec);
                 RUNNING_REQUESTS.erase("@downloadLoaderUpdate");
                 return *response;
             },
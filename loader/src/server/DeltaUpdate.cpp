@@ -0,0 +1,465 @@
+#include "DeltaUpdate.hpp"
+#include "ResumableDownload.hpp"
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+
+using namespace server;
+
+// The end of central directory record is 22 bytes, followed by a comment of
+// up to 65535 bytes
+static constexpr size_t EOCD_SIZE = 22;
+static constexpr size_t TAIL_SIZE = EOCD_SIZE + 0xFFFF;
+static constexpr size_t CENTRAL_HEADER_SIZE = 46;
+static constexpr size_t LOCAL_HEADER_SIZE = 30;
+static constexpr uint32_t EOCD_SIGNATURE = 0x06054b50;
+static constexpr uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static constexpr uint16_t FLAG_ENCRYPTED = 0x1;
+static constexpr uint16_t FLAG_DATA_DESCRIPTOR = 0x8;
+
+// Unchanged data smaller than this is downloaded anyway, to save requests
+static constexpr size_t MIN_REUSED_SIZE = 64 * 1024;
+// Give up if more ranges than this would have to be downloaded...
+static constexpr size_t MAX_RANGES = 32;
+// ...or if most of the package has changed anyway
+static constexpr double MAX_CHANGED_RATIO = 0.75;
+
+struct ZipEntry {
+    std::string name;
+    uint16_t flags;
+    uint16_t method;
+    uint32_t crc;
+    uint32_t compressedSize;
+    uint32_t size;
+    uint32_t headerOffset;
+};
+struct ZipDirectory {
+    size_t offset;
+    size_t size;
+};
+struct InstalledEntry {
+    ZipEntry entry;
+    // Where the entry's compressed data starts in the installed package
+    size_t dataOffset;
+};
+
+struct ContentRange {
+    size_t start;
+    // Inclusive, like in the header
+    size_t end;
+    size_t total;
+};
+
+struct Segment {
+    enum class Source {
+        // Has to be downloaded
+        Remote,
+        // Copied from the installed package
+        Installed,
+        // Already downloaded while looking for the central directory
+        Known,
+    };
+
+    Source source;
+    // Position in the new package
+    size_t start;
+    size_t end;
+    // Position in the installed package, for installed segments
+    size_t installedOffset = 0;
+};
+
+struct DeltaState {
+    std::string url;
+    std::string userAgent;
+    std::filesystem::path installed;
+    std::function<bool(std::span<const uint8_t>)> write;
+
+    size_t size = 0;
+    // The end of the new package, starting from knownStart
+    ByteVector known;
+    size_t knownStart = 0;
+
+    std::vector<Segment> segments;
+    size_t changedBytes = 0;
+    size_t fetchedBytes = 0;
+    std::ifstream installedFile;
+};
+
+static uint16_t read16(uint8_t const* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+static uint32_t read32(uint8_t const* data) {
+    return static_cast<uint32_t>(data[0]) |
+        (static_cast<uint32_t>(data[1]) << 8) |
+        (static_cast<uint32_t>(data[2]) << 16) |
+        (static_cast<uint32_t>(data[3]) << 24);
+}
+
+// Find the central directory given the last bytes of a zip
+static Result<ZipDirectory> findDirectory(std::span<const uint8_t> tail) {
+    if (tail.size() < EOCD_SIZE) {
+        return Err("Package is too small to be a zip");
+    }
+    for (size_t i = tail.size() - EOCD_SIZE + 1; i-- > 0;) {
+        auto record = tail.data() + i;
+        // The comment has to reach the end of the file, otherwise this is
+        // just something that happens to look like the signature
+        if (read32(record) != EOCD_SIGNATURE || i + EOCD_SIZE + read16(record + 20) != tail.size()) {
+            continue;
+        }
+        auto entries = read16(record + 10);
+        auto size = read32(record + 12);
+        auto offset = read32(record + 16);
+        if (read16(record + 4) != 0 || entries == 0xFFFF || size == 0xFFFFFFFF || offset == 0xFFFFFFFF) {
+            return Err("Split and zip64 packages are not supported");
+        }
+        return Ok(ZipDirectory { .offset = offset, .size = size });
+    }
+    return Err("End of central directory not found");
+}
+
+static Result<std::vector<ZipEntry>> parseDirectory(std::span<const uint8_t> data) {
+    std::vector<ZipEntry> entries;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        if (pos + CENTRAL_HEADER_SIZE > data.size()) {
+            return Err("Truncated central directory");
+        }
+        auto header = data.data() + pos;
+        if (read32(header) != CENTRAL_HEADER_SIGNATURE) {
+            return Err("Invalid central directory entry");
+        }
+        size_t nameLength = read16(header + 28);
+        auto next = pos + CENTRAL_HEADER_SIZE + nameLength + read16(header + 30) + read16(header + 32);
+        if (next > data.size()) {
+            return Err("Truncated central directory");
+        }
+        entries.push_back(ZipEntry {
+            .name = std::string(reinterpret_cast<const char*>(header + CENTRAL_HEADER_SIZE), nameLength),
+            .flags = read16(header + 8),
+            .method = read16(header + 10),
+            .crc = read32(header + 16),
+            .compressedSize = read32(header + 20),
+            .size = read32(header + 24),
+            .headerOffset = read32(header + 42),
+        });
+        pos = next;
+    }
+    return Ok(std::move(entries));
+}
+
+static Result<std::unordered_map<std::string, InstalledEntry>> readInstalledEntries(std::ifstream& file) {
+    file.seekg(0, std::ios::end);
+    auto fileSize = static_cast<size_t>(file.tellg());
+    auto readAt = [&](size_t offset, size_t size) -> Result<ByteVector> {
+        ByteVector data(size);
+        file.seekg(offset);
+        if (offset + size > fileSize || !file.read(reinterpret_cast<char*>(data.data()), size)) {
+            return Err("Unable to read the installed package");
+        }
+        return Ok(std::move(data));
+    };
+
+    auto tailSize = std::min(fileSize, TAIL_SIZE);
+    GEODE_UNWRAP_INTO(auto tail, readAt(fileSize - tailSize, tailSize));
+    GEODE_UNWRAP_INTO(auto dir, findDirectory(tail));
+    GEODE_UNWRAP_INTO(auto directory, readAt(dir.offset, dir.size));
+    GEODE_UNWRAP_INTO(auto entries, parseDirectory(directory));
+
+    std::unordered_map<std::string, InstalledEntry> installed;
+    for (auto& entry : entries) {
+        GEODE_UNWRAP_INTO(auto header, readAt(entry.headerOffset, LOCAL_HEADER_SIZE));
+        if (read32(header.data()) != LOCAL_HEADER_SIGNATURE) {
+            return Err("Invalid local file header in the installed package");
+        }
+        auto dataOffset = entry.headerOffset + LOCAL_HEADER_SIZE + read16(header.data() + 26) + read16(header.data() + 28);
+        auto name = entry.name;
+        installed.insert({ name, InstalledEntry { .entry = std::move(entry), .dataOffset = dataOffset } });
+    }
+    return Ok(std::move(installed));
+}
+
+static bool isSameEntry(ZipEntry const& a, ZipEntry const& b) {
+    return a.crc == b.crc &&
+        a.compressedSize == b.compressedSize &&
+        a.size == b.size &&
+        a.method == b.method;
+}
+
+// Figure out which parts of the new package can be copied from the installed
+// one. Entries without a data descriptor end right where the next one
+// starts, which is how the position of their data is found without
+// downloading their local headers. If that guess is wrong, the final hash
+// won't match
+static Result<> planSegments(DeltaState& state) {
+    GEODE_UNWRAP_INTO(auto dir, findDirectory(state.known));
+    if (dir.offset < state.knownStart || dir.offset + dir.size > state.size) {
+        return Err("Central directory is out of bounds");
+    }
+    GEODE_UNWRAP_INTO(auto entries, parseDirectory(
+        std::span(state.known).subspan(dir.offset - state.knownStart, dir.size)
+    ));
+
+    state.installedFile.open(state.installed, std::ios::binary);
+    if (!state.installedFile) {
+        return Err("Unable to open the installed package");
+    }
+    GEODE_UNWRAP_INTO(auto installed, readInstalledEntries(state.installedFile));
+
+    std::sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+        return a.headerOffset < b.headerOffset;
+    });
+    std::vector<Segment> planned;
+    size_t cursor = 0;
+    for (size_t i = 0; i < entries.size(); i += 1) {
+        auto const& entry = entries[i];
+        auto end = i + 1 < entries.size() ? entries[i + 1].headerOffset : dir.offset;
+        auto old = installed.find(entry.name);
+        if (
+            old == installed.end() || !isSameEntry(entry, old->second.entry) ||
+            (entry.flags & (FLAG_ENCRYPTED | FLAG_DATA_DESCRIPTOR)) ||
+            end < entry.compressedSize
+        ) {
+            continue;
+        }
+        auto dataStart = end - entry.compressedSize;
+        if (dataStart < cursor || dataStart < entry.headerOffset + LOCAL_HEADER_SIZE + entry.name.size()) {
+            continue;
+        }
+        planned.push_back({ Segment::Source::Remote, cursor, dataStart });
+        planned.push_back({ Segment::Source::Installed, dataStart, end, old->second.dataOffset });
+        cursor = end;
+    }
+    planned.push_back({ Segment::Source::Remote, cursor, state.size });
+
+    auto append = [&](Segment segment) {
+        if (segment.end <= segment.start) {
+            return;
+        }
+        auto& segments = state.segments;
+        if (
+            !segments.empty() && segment.source != Segment::Source::Installed &&
+            segments.back().source == segment.source && segments.back().end == segment.start
+        ) {
+            segments.back().end = segment.end;
+        }
+        else {
+            segments.push_back(segment);
+        }
+    };
+    for (auto segment : planned) {
+        if (segment.source == Segment::Source::Installed && segment.end - segment.start < MIN_REUSED_SIZE) {
+            segment.source = Segment::Source::Remote;
+        }
+        if (segment.source == Segment::Source::Remote && segment.end > state.knownStart) {
+            if (segment.start < state.knownStart) {
+                append({ Segment::Source::Remote, segment.start, state.knownStart });
+                segment.start = state.knownStart;
+            }
+            segment.source = Segment::Source::Known;
+        }
+        append(segment);
+    }
+
+    size_t ranges = 0;
+    for (auto const& segment : state.segments) {
+        if (segment.source == Segment::Source::Remote) {
+            ranges += 1;
+            state.changedBytes += segment.end - segment.start;
+        }
+    }
+    if (ranges > MAX_RANGES || state.changedBytes > state.size * MAX_CHANGED_RATIO) {
+        return Err(fmt::format(
+            "Not worth it, {} of {} bytes changed in {} ranges",
+            state.changedBytes, state.size, ranges
+        ));
+    }
+    return Ok();
+}
+
+static Result<> copySegment(DeltaState& state, Segment const& segment) {
+    auto length = segment.end - segment.start;
+    if (segment.source == Segment::Source::Known) {
+        if (!state.write(std::span(state.known).subspan(segment.start - state.knownStart, length))) {
+            return Err("Unable to write the package");
+        }
+        return Ok();
+    }
+    ByteVector buffer(std::min<size_t>(length, 64 * 1024));
+    state.installedFile.seekg(segment.installedOffset);
+    for (size_t remaining = length; remaining > 0;) {
+        auto size = std::min(remaining, buffer.size());
+        if (!state.installedFile.read(reinterpret_cast<char*>(buffer.data()), size)) {
+            return Err("Unable to read the installed package");
+        }
+        if (!state.write(std::span(buffer.data(), size))) {
+            return Err("Unable to write the package");
+        }
+        remaining -= size;
+    }
+    return Ok();
+}
+
+static std::optional<ContentRange> parseContentRange(web::WebResponse const& response) {
+    // bytes <start>-<end>/<total>
+    auto header = findResponseHeader(response, "Content-Range");
+    if (!header || !header->starts_with("bytes ")) {
+        return std::nullopt;
+    }
+    auto range = std::string_view(*header).substr(6);
+    auto dash = range.find('-');
+    auto slash = range.find('/');
+    if (dash == std::string_view::npos || slash == std::string_view::npos || slash < dash) {
+        return std::nullopt;
+    }
+    auto start = utils::numFromString<size_t>(range.substr(0, dash));
+    auto end = utils::numFromString<size_t>(range.substr(dash + 1, slash - dash - 1));
+    auto total = utils::numFromString<size_t>(range.substr(slash + 1));
+    if (!start || !end || !total || end.unwrap() < start.unwrap()) {
+        return std::nullopt;
+    }
+    return ContentRange { .start = start.unwrap(), .end = end.unwrap(), .total = total.unwrap() };
+}
+
+static web::WebRequest createRangeRequest(DeltaState const& state, std::string const& range, std::optional<size_t> start) {
+    auto req = web::WebRequest();
+    req.userAgent(state.userAgent);
+    req.header("Range", "bytes=" + range);
+    // Don't download the whole package if the server ignores the range
+    req.onResponseStart([start](web::WebResponse const& response) {
+        auto range = parseContentRange(response);
+        return response.code() == 206 && range && (!start || range->start == *start);
+    });
+    return req;
+}
+
+// Download a range of the new package that ends where the known part of it
+// starts, so it becomes known too
+static DeltaUpdateTask fetchKnown(std::shared_ptr<DeltaState> state, std::string const& range, std::optional<size_t> start) {
+    return createRangeRequest(*state, range, start).get(state->url).map(
+        [state](web::WebResponse* response) -> Result<> {
+            if (response->code() != 206) {
+                return Err(fmt::format("Range request failed with code {}", response->code()));
+            }
+            auto range = parseContentRange(*response);
+            auto data = response->data();
+            if (
+                !range || data.size() != range->end - range->start + 1 ||
+                range->end + 1 != (state->known.empty() ? range->total : state->knownStart)
+            ) {
+                return Err("Server returned an unexpected range");
+            }
+            state->size = range->total;
+            state->known.insert(state->known.begin(), data.begin(), data.end());
+            state->knownStart = range->start;
+            return Ok();
+        },
+        [](web::WebProgress*) -> uint8_t {
+            return 0;
+        }
+    );
+}
+
+// Download a changed part of the new package straight into it
+static DeltaUpdateTask fetchSegment(std::shared_ptr<DeltaState> state, Segment const& segment) {
+    auto received = std::make_shared<size_t>(0);
+    auto req = createRangeRequest(*state, fmt::format("{}-{}", segment.start, segment.end - 1), segment.start);
+    req.onResponseChunk([state, received](std::span<const uint8_t> chunk) {
+        *received += chunk.size();
+        return state->write(chunk);
+    });
+    return req.get(state->url).map(
+        [state, received, length = segment.end - segment.start](web::WebResponse* response) -> Result<> {
+            if (response->code() != 206) {
+                return Err(fmt::format("Range request failed with code {}", response->code()));
+            }
+            if (*received != length) {
+                return Err("Server returned an incomplete range");
+            }
+            state->fetchedBytes += length;
+            return Ok();
+        },
+        [state](web::WebProgress* progress) -> uint8_t {
+            auto fetched = state->fetchedBytes + progress->downloaded();
+            return static_cast<uint8_t>(std::min<size_t>(fetched * 100 / std::max<size_t>(state->changedBytes, 1), 100));
+        }
+    );
+}
+
+// Put the new package together in order, starting from the given segment
+static DeltaUpdateTask assemble(std::shared_ptr<DeltaState> state, size_t index) {
+    using CopyTask = Task<Result<size_t>>;
+
+    // Copy everything up to the next changed part on a worker thread
+    return CopyTask::run([state, index](auto, auto hasBeenCancelled) -> CopyTask::Result {
+        auto i = index;
+        for (; i < state->segments.size() && state->segments[i].source != Segment::Source::Remote; i += 1) {
+            if (hasBeenCancelled()) {
+                return CopyTask::Cancel();
+            }
+            if (auto res = copySegment(*state, state->segments[i]); !res) {
+                return CopyTask::Value(Err(res.unwrapErr()));
+            }
+        }
+        return CopyTask::Value(Ok(i));
+    }, "Copy unchanged mod files").chain([state](Result<size_t>* result) -> DeltaUpdateTask {
+        if (result->isErr()) {
+            return DeltaUpdateTask::immediate(Err(result->unwrapErr()));
+        }
+        auto next = result->unwrap();
+        if (next >= state->segments.size()) {
+            return DeltaUpdateTask::immediate(Ok());
+        }
+        return fetchSegment(state, state->segments[next]).chain([state, next](Result<>* result) -> DeltaUpdateTask {
+            if (result->isErr()) {
+                return DeltaUpdateTask::immediate(Err(result->unwrapErr()));
+            }
+            return assemble(state, next + 1);
+        });
+    });
+}
+
+DeltaUpdateTask server::downloadDeltaUpdate(
+    std::string const& url,
+    std::filesystem::path const& installed,
+    std::string const& userAgent,
+    std::function<bool(std::span<const uint8_t>)> write
+) {
+    auto state = std::make_shared<DeltaState>();
+    state->url = url;
+    state->userAgent = userAgent;
+    state->installed = installed;
+    state->write = std::move(write);
+
+    // The central directory is at the end of the package, so start by
+    // downloading enough of the end to be sure to find where it starts
+    return fetchKnown(state, fmt::format("-{}", TAIL_SIZE), std::nullopt).chain([state](Result<>* result) -> DeltaUpdateTask {
+        if (result->isErr()) {
+            return DeltaUpdateTask::immediate(Err(result->unwrapErr()));
+        }
+        auto dir = findDirectory(state->known);
+        if (!dir) {
+            return DeltaUpdateTask::immediate(Err(dir.unwrapErr()));
+        }
+        if (dir.unwrap().offset >= state->knownStart) {
+            return DeltaUpdateTask::immediate(Ok());
+        }
+        // Large packages have central directories that don't fit in the end
+        return fetchKnown(
+            state, fmt::format("{}-{}", dir.unwrap().offset, state->knownStart - 1), dir.unwrap().offset
+        );
+    }).chain([state](Result<>* result) -> DeltaUpdateTask {
+        if (result->isErr()) {
+            return DeltaUpdateTask::immediate(Err(result->unwrapErr()));
+        }
+        return DeltaUpdateTask::run([state](auto, auto) -> DeltaUpdateTask::Result {
+            return planSegments(*state);
+        }, "Plan mod delta update");
+    }).chain([state](Result<>* result) -> DeltaUpdateTask {
+        if (result->isErr()) {
+            return DeltaUpdateTask::immediate(Err(result->unwrapErr()));
+        }
+        return assemble(state, 0);
+    });
+}
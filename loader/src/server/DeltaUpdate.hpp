@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Geode/utils/web.hpp>
+#include <filesystem>
+#include <functional>
+#include <span>
+
+using namespace geode::prelude;
+
+namespace server {
+    // Progress is the percentage of the changed data downloaded so far
+    using DeltaUpdateTask = Task<Result<>, uint8_t>;
+
+    /**
+     * Download a new version of an installed package by only fetching the
+     * zip entries that changed between them, and copying the rest from the
+     * installed package. Uses range requests to read the new package's
+     * central directory and then the changed parts
+     * @param url URL of the new package
+     * @param installed Path to the installed package
+     * @param userAgent User agent to send with the range requests
+     * @param write Called in order with the contents of the new package as
+     * it's put together, on worker threads. Return false to abort
+     * @returns A task that fails if the server doesn't support range
+     * requests, either package is laid out in a way this can't handle, or
+     * too little is shared between them for it to be worth it. In that case
+     * the whole package should be downloaded instead. The result must still
+     * be checked against the expected hash
+     */
+    DeltaUpdateTask downloadDeltaUpdate(
+        std::string const& url,
+        std::filesystem::path const& installed,
+        std::string const& userAgent,
+        std::function<bool(std::span<const uint8_t>)> write
+    );
+}
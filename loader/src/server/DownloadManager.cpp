@@ -1,9 +1,12 @@
 #include "DownloadManager.hpp"
+#include "DeltaUpdate.hpp"
+#include "ResumableDownload.hpp"
 #include "Geode/loader/Mod.hpp"
 #include <Geode/loader/Dirs.hpp>
 #include <Geode/utils/map.hpp>
+#include <Geode/utils/JsonValidation.hpp>
+#include <deque>
 #include <optional>
-#include <hash/hash.hpp>
 #include <loader/ModImpl.hpp>
 
 using namespace server;
@@ -19,6 +22,147 @@ ListenerResult ModDownloadFilter::handle(std::function<Callback> fn, ModDownload
 ModDownloadFilter::ModDownloadFilter() {}
 ModDownloadFilter::ModDownloadFilter(std::string const& id) : m_id(id) {}
 
+static Result<> installDownload(
+    DownloadFile& file, std::optional<std::filesystem::path> const& oldPackage,
+    std::filesystem::path const& target
+) {
+    // If this was an update, delete the old file first
+    std::error_code ec;
+    if (oldPackage) {
+        std::filesystem::remove(*oldPackage, ec);
+        if (ec) {
+            return Err(fmt::format("Unable to delete existing .geode package (code {})", ec));
+        }
+    }
+    std::filesystem::rename(file.path, target, ec);
+    if (ec) {
+        return Err(fmt::format("Unable to move the downloaded package into place (code {})", ec));
+    }
+    file.committed = true;
+    std::filesystem::remove(getPartialInfoPath(file.path), ec);
+    return Ok();
+}
+
+$on_mod(Loaded) {
+    // Clean up partial downloads that were never resumed
+    removeStalePartialDownloads(dirs::getModsDir());
+}
+
+using CommitTask = Task<Result<>>;
+
+/**
+ * Limits how many mod downloads run at once, so updating dozens of mods 
+ * doesn't split a slow connection between all of them. Downloads are 
+ * started in the order they were confirmed, except for ones the user is 
+ * looking at, which are moved to the front of the queue
+ */
+class DownloadScheduler final {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Queued {
+        std::string id;
+        // The download this entry belongs to; retrying a download creates a 
+        // new one with the same ID
+        void const* owner;
+        std::function<void()> start;
+    };
+    std::deque<Queued> m_queue;
+    // Running downloads and how many bytes they've received
+    std::unordered_map<void const*, size_t> m_running;
+    bool m_starting = false;
+    size_t m_totalBytes = 0;
+    // Total bytes received at points in time, for measuring speed
+    std::deque<std::pair<Clock::time_point, size_t>> m_samples;
+
+    static constexpr auto SPEED_WINDOW = std::chrono::seconds(3);
+
+    size_t getMaxRunning() const {
+        auto max = Mod::get()->getSettingValue<int64_t>("max-concurrent-downloads");
+        return static_cast<size_t>(std::max<int64_t>(max, 1));
+    }
+
+    void startQueued() {
+        // Starting a download may finish another one (for example if it 
+        // fails immediately), which would call this again
+        if (m_starting) return;
+        m_starting = true;
+        while (m_running.size() < this->getMaxRunning() && !m_queue.empty()) {
+            auto next = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_running.insert({ next.owner, 0 });
+            next.start();
+        }
+        m_starting = false;
+    }
+
+public:
+    static DownloadScheduler* get() {
+        static auto inst = new DownloadScheduler();
+        return inst;
+    }
+
+    void enqueue(std::string const& id, void const* owner, std::function<void()> start) {
+        m_queue.push_back(Queued { .id = id, .owner = owner, .start = std::move(start) });
+        this->startQueued();
+    }
+    /**
+     * Remove a download from the queue, or free up its slot if it's running
+     */
+    void remove(void const* owner) {
+        std::erase_if(m_queue, [owner](auto const& queued) { return queued.owner == owner; });
+        if (m_running.erase(owner)) {
+            this->startQueued();
+        }
+    }
+    void prioritize(std::string const& id) {
+        auto it = std::find_if(m_queue.begin(), m_queue.end(), [&](auto const& queued) {
+            return queued.id == id;
+        });
+        if (it != m_queue.end() && it != m_queue.begin()) {
+            auto queued = std::move(*it);
+            m_queue.erase(it);
+            m_queue.push_front(std::move(queued));
+        }
+    }
+    bool isQueued(void const* owner) const {
+        return std::any_of(m_queue.begin(), m_queue.end(), [owner](auto const& queued) {
+            return queued.owner == owner;
+        });
+    }
+
+    void progress(void const* owner, size_t downloaded) {
+        auto it = m_running.find(owner);
+        if (it == m_running.end() || downloaded < it->second) {
+            return;
+        }
+        m_totalBytes += downloaded - it->second;
+        it->second = downloaded;
+
+        auto now = Clock::now();
+        m_samples.push_back({ now, m_totalBytes });
+        while (m_samples.size() > 2 && now - m_samples.front().first > SPEED_WINDOW) {
+            m_samples.pop_front();
+        }
+    }
+
+    DownloadStats getStats() const {
+        auto stats = DownloadStats {
+            .running = m_running.size(),
+            .queued = m_queue.size(),
+            .totalBytes = m_totalBytes,
+        };
+        // Only count speed while something is actually downloading
+        if (!m_running.empty() && m_samples.size() >= 2) {
+            auto time = std::chrono::duration<double>(m_samples.back().first - m_samples.front().first);
+            if (time.count() > 0) {
+                stats.bytesPerSecond = (m_samples.back().second - m_samples.front().second) / time.count();
+            }
+        }
+        return stats;
+    }
+};
+
 class ModDownload::Impl final {
 public:
     std::string m_id;
@@ -28,6 +172,9 @@ public:
     DownloadStatus m_status;
     EventListener<ServerRequest<ServerModVersion>> m_infoListener;
     EventListener<web::WebTask> m_downloadListener;
+    EventListener<DeltaUpdateTask> m_deltaListener;
+    EventListener<CommitTask> m_commitListener;
+    std::optional<ServerModVersion> m_queuedVersion;
     unsigned int m_scheduledEventForFrame = 0;
 
     Impl(
@@ -84,14 +231,7 @@ public:
             }
 
             if (!ModDownloadManager::get()->checkAutoConfirm()) {
-                // Throttle events to only once per frame to not cause a 
-                // billion UI updates at once 
-                if (m_scheduledEventForFrame != CCDirector::get()->getTotalFrames()) {
-                    m_scheduledEventForFrame = CCDirector::get()->getTotalFrames();
-                    Loader::get()->queueInMainThread([id = m_id]() {
-                        ModDownloadEvent(id).post();
-                    });
-                }
+                this->postThrottledEvent();
             }
         });
         auto fetchVersion = version.has_value() ? ModVersion(*version) : ModVersion(ModVersionLatest());
@@ -101,57 +241,136 @@ public:
         });
     }
 
+    ~Impl() {
+        DownloadScheduler::get()->remove(this);
+    }
+
+    // Throttle events to only once per frame to not cause a billion UI 
+    // updates at once 
+    void postThrottledEvent() {
+        if (m_scheduledEventForFrame != CCDirector::get()->getTotalFrames()) {
+            m_scheduledEventForFrame = CCDirector::get()->getTotalFrames();
+            Loader::get()->queueInMainThread([id = m_id]() {
+                ModDownloadEvent(id).post();
+            });
+        }
+    }
+
     void confirm() {
         auto confirm = std::get_if<DownloadStatusConfirm>(&m_status);
         if (!confirm) return;
 
-        auto version = confirm->version;
+        // Queued downloads show up as downloading at 0%
+        m_queuedVersion = confirm->version;
         m_status = DownloadStatusDownloading {
             .percentage = 0,
         };
+        DownloadScheduler::get()->enqueue(m_id, this, [this] {
+            this->start();
+        });
+        ModDownloadEvent(m_id).post();
+    }
+
+    void start() {
+        if (!m_queuedVersion) return;
+        auto version = std::move(*m_queuedVersion);
+        m_queuedVersion.reset();
+
+        auto [file, partial] = claimDownloadFile(dirs::getModsDir(), m_id, version.hash);
+        if (!file->open(partial ? partial->size : 0)) {
+            m_status = DownloadStatusError {
+                .details = "Unable to create file for the download",
+            };
+            DownloadScheduler::get()->remove(this);
+            ModDownloadEvent(m_id).post();
+            return;
+        }
+
+        // Updates only need the parts of the package that changed, unless 
+        // there's a partial download of the whole thing to continue instead
+        auto installed = Loader::get()->getInstalledMod(m_id);
+        if (!partial && !m_replacesMod && installed && std::filesystem::exists(installed->getPackagePath())) {
+            this->downloadDelta(file, version, installed->getPackagePath());
+        }
+        else {
+            this->download(file, version, partial);
+        }
+        ModDownloadEvent(m_id).post();
+    }
 
-        m_downloadListener.bind([this, hash = version.hash, version = version](web::WebTask::Event* event) {
+    void downloadDelta(
+        std::shared_ptr<DownloadFile> file, ServerModVersion const& version,
+        std::filesystem::path const& installed
+    ) {
+        // Delta updates can't be resumed, so their data is only worth 
+        // keeping if it turns into a regular download
+        bool keep = file->keep;
+        file->keep = false;
+
+        m_deltaListener.bind([this, file, version, keep](DeltaUpdateTask::Event* event) {
             if (auto value = event->getValue()) {
-                if (value->ok()) {
-                    if (auto actualHash = ::calculateHash(value->data()); actualHash != hash) {
-                        log::error("Failed to download {}, hash mismatch ({} != {})", m_id, actualHash, hash);
+                if (value->isOk() && file->finishHash() == version.hash) {
+                    DownloadScheduler::get()->remove(this);
+                    m_status = DownloadStatusDownloading {
+                        .percentage = 100,
+                    };
+                    this->commit(file, version);
+                }
+                else {
+                    log::info(
+                        "Delta update of {} failed, downloading the whole package instead: {}",
+                        m_id, value->isOk() ? "Hash mismatch" : value->unwrapErr()
+                    );
+                    file->keep = keep;
+                    if (file->restart()) {
+                        this->download(file, version, std::nullopt);
+                    }
+                    else {
+                        DownloadScheduler::get()->remove(this);
                         m_status = DownloadStatusError {
-                            .details = "Hash mismatch, downloaded file did not match what was expected",
+                            .details = "Unable to create file for the download",
                         };
-                        ModDownloadEvent(m_id).post();
-                        return;
                     }
+                }
+            }
+            else if (auto progress = event->getProgress()) {
+                m_status = DownloadStatusDownloading {
+                    .percentage = *progress,
+                };
+            }
+            else if (event->isCancelled()) {
+                DownloadScheduler::get()->remove(this);
+                m_status = DownloadStatusCancelled();
+            }
+            this->postThrottledEvent();
+        });
+        m_deltaListener.setFilter(downloadDeltaUpdate(
+            version.downloadURL, installed, getServerUserAgent(),
+            [file](std::span<const uint8_t> chunk) {
+                return file->write(chunk);
+            }
+        ));
+    }
 
-                    bool removingInstalledWasError = false;
-                    std::string id = m_replacesMod.has_value() ? m_replacesMod.value() : m_id;
-                    if (auto mod = Loader::get()->getInstalledMod(id)) {
-                        std::error_code ec;
-                        std::filesystem::remove(mod->getPackagePath(), ec);
-                        if (ec) {
-                            removingInstalledWasError = true;
-                            m_status = DownloadStatusError {
-                                .details = fmt::format("Unable to delete existing .geode package (code {})", ec),
-                            };
-                        }
-                        // Mark mod as updated
-                        ModImpl::getImpl(mod)->m_requestedAction = ModRequestedAction::Update;
-                    }
-                    // If this was an update, delete the old file first
-                    if (!removingInstalledWasError) {
-                        auto ok = file::writeBinary(dirs::getModsDir() / (m_id + ".geode"), value->data());
-                        if (!ok) {
-                            m_status = DownloadStatusError {
-                                .details = ok.unwrapErr(),
-                            };
-                        }
-                        else {
-                            m_status = DownloadStatusDone {
-                                .version = version
-                            };
-                        }
-                    }
+    void download(
+        std::shared_ptr<DownloadFile> file, ServerModVersion const& version,
+        std::optional<PartialDownload> const& partial
+    ) {
+        m_downloadListener.bind([this, file, version = version](web::WebTask::Event* event) {
+            if (auto value = event->getValue()) {
+                // Let the next queued download start while this one is 
+                // being installed
+                DownloadScheduler::get()->remove(this);
+                if (value->ok()) {
+                    // Verifying and moving the file into place happens off 
+                    // the main thread; the download stays at 100% until then
+                    m_status = DownloadStatusDownloading {
+                        .percentage = 100,
+                    };
+                    this->commit(file, version);
                 }
                 else {
+                    handleFailedDownload(*file, *value);
                     m_status = DownloadStatusError {
                         .details = fmt::format("Server returned error {}", event->getValue()->code()),
                     };
@@ -160,27 +379,73 @@ public:
                 }
             }
             else if (auto progress = event->getProgress()) {
+                DownloadScheduler::get()->progress(this, progress->downloaded());
+                // Resumed downloads only report the progress of the rest of 
+                // the package
+                size_t offset = file->offset;
+                uint8_t percentage = 0;
+                if (progress->downloadTotal() > 0) {
+                    percentage = static_cast<uint8_t>(
+                        (offset + progress->downloaded()) * 100 / (offset + progress->downloadTotal())
+                    );
+                }
                 m_status = DownloadStatusDownloading {
-                    .percentage = static_cast<uint8_t>(progress->downloadProgress().value_or(0)),
+                    .percentage = percentage,
                 };
             }
             else if (event->isCancelled()) {
+                DownloadScheduler::get()->remove(this);
                 m_status = DownloadStatusCancelled();
             }
-            // Throttle events to only once per frame to not cause a 
-            // billion UI updates at once 
-            if (m_scheduledEventForFrame != CCDirector::get()->getTotalFrames()) {
-                m_scheduledEventForFrame = CCDirector::get()->getTotalFrames();
-                Loader::get()->queueInMainThread([id = m_id]() {
-                    ModDownloadEvent(id).post();
-                });
-            }
+            this->postThrottledEvent();
         });
 
         auto req = web::WebRequest();
         req.userAgent(getServerUserAgent());
+        setUpDownloadRequest(req, file, partial, version.hash);
         m_downloadListener.setFilter(req.get(version.downloadURL));
-        ModDownloadEvent(m_id).post();
+    }
+
+    void commit(std::shared_ptr<DownloadFile> file, ServerModVersion const& version) {
+        std::string id = m_replacesMod.has_value() ? m_replacesMod.value() : m_id;
+        std::optional<std::filesystem::path> oldPackage;
+        if (auto mod = Loader::get()->getInstalledMod(id)) {
+            oldPackage = mod->getPackagePath();
+        }
+
+        m_commitListener.bind([this, id, version](CommitTask::Event* event) {
+            if (auto value = event->getValue()) {
+                if (value->isOk()) {
+                    // Mark mod as updated
+                    if (auto mod = Loader::get()->getInstalledMod(id)) {
+                        ModImpl::getImpl(mod)->m_requestedAction = ModRequestedAction::Update;
+                    }
+                    m_status = DownloadStatusDone {
+                        .version = version
+                    };
+                }
+                else {
+                    m_status = DownloadStatusError {
+                        .details = value->unwrapErr(),
+                    };
+                }
+                ModDownloadEvent(m_id).post();
+            }
+        });
+        m_commitListener.setFilter(CommitTask::run(
+            [
+                file, id = m_id, hash = version.hash, oldPackage,
+                target = dirs::getModsDir() / (m_id + ".geode")
+            ](auto, auto) -> CommitTask::Result {
+                // This isn't cancellable (see ModDownload::cancel), so the 
+                // result is always reported
+                if (auto res = verifyDownload(*file, id, hash); !res) {
+                    return std::move(res);
+                }
+                return installDownload(*file, oldPackage, target);
+            },
+            fmt::format("Install {}", m_id)
+        ));
     }
 };
 
@@ -225,6 +490,12 @@ DownloadStatus ModDownload::getStatus() const {
 std::optional<VersionInfo> ModDownload::getVersion() const {
     return m_impl->m_version;
 }
+bool ModDownload::isQueued() const {
+    return DownloadScheduler::get()->isQueued(m_impl.get());
+}
+void ModDownload::prioritize() {
+    DownloadScheduler::get()->prioritize(m_impl->m_id);
+}
 
 class ModDownloadManager::Impl {
 public:
@@ -245,26 +516,46 @@ public:
                     // d.cancel() will cause cancelOrphanedDependencies() to be called again
                     // We want that anyway because cancelling one dependency might cause
                     // dependencies down the chain to become orphaned
-                    return d.cancel();
+                    // Downloads that are being installed or have already stopped 
+                    // don't cancel, so keep looking for orphans past them
+                    if (d.cancel()) {
+                        return;
+                    }
                 }
             }
         }
     }
 };
 
-void ModDownload::cancel() {
-    if (!std::holds_alternative<DownloadStatusDone>(m_impl->m_status)) {
+bool ModDownload::cancel() {
+    // Once the package is being verified and moved into place, stopping 
+    // halfway could leave the old package deleted, or the mod replaced 
+    // without asking for a restart. It only takes a moment, so let it finish
+    if (m_impl->m_commitListener.getFilter().isPending()) {
+        return false;
+    }
+    if (
+        !std::holds_alternative<DownloadStatusDone>(m_impl->m_status) &&
+        !std::holds_alternative<DownloadStatusCancelled>(m_impl->m_status)
+    ) {
         m_impl->m_status = DownloadStatusCancelled();
         m_impl->m_infoListener.getFilter().cancel();
         m_impl->m_infoListener.setFilter(ServerRequest<ServerModVersion>());
         m_impl->m_downloadListener.getFilter().cancel();
         m_impl->m_downloadListener.setFilter({});
+        m_impl->m_deltaListener.getFilter().cancel();
+        m_impl->m_deltaListener.setFilter({});
+        m_impl->m_commitListener.setFilter({});
+        m_impl->m_queuedVersion.reset();
+        DownloadScheduler::get()->remove(m_impl.get());
 
         // Cancel any dependencies of this mod left over (unless some other
         // installation depends on them still)
         ModDownloadManager::get()->m_impl->cancelOrphanedDependencies();
         ModDownloadEvent(m_impl->m_id).post();
+        return true;
     }
+    return false;
 }
 
 std::optional<ModDownload> ModDownloadManager::startDownload(
@@ -390,6 +681,9 @@ std::optional<ModDownload> ModDownloadManager::getDownload(std::string const& id
     }
     return std::nullopt;
 }
+DownloadStats ModDownloadManager::getStats() const {
+    return DownloadScheduler::get()->getStats();
+}
 bool ModDownloadManager::hasActiveDownloads() const {
     for (auto& [_, download] : m_impl->m_downloads) {
         if (download.isActive()) {
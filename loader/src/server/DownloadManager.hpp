@@ -57,6 +57,15 @@ namespace server {
 
     using DependencyFor = std::pair<std::string, ModMetadata::Dependency::Importance>;
 
+    struct DownloadStats {
+        size_t running = 0;
+        size_t queued = 0;
+        // Bytes received by all downloads so far
+        size_t totalBytes = 0;
+        // Combined speed of all running downloads over the last few seconds
+        double bytesPerSecond = 0;
+    };
+
     class ModDownload final {
     private:
         class Impl;
@@ -74,10 +83,25 @@ namespace server {
     
     public:
         void confirm();
-        void cancel();
+        /**
+         * Stop the download. Does nothing once the downloaded package is 
+         * being installed, or if the download is already done or cancelled
+         * @returns Whether the download was cancelled by this call
+         */
+        bool cancel();
 
         bool isDone() const;
         bool isActive() const;
+        /**
+         * Whether this download has been confirmed but is waiting for other 
+         * downloads to finish before starting
+         */
+        bool isQueued() const;
+        /**
+         * Start this download before other queued downloads, for example 
+         * because the user is looking at it
+         */
+        void prioritize();
         bool canRetry() const;
         std::optional<std::string> getReplacesMod() const;
         std::optional<DependencyFor> getDependencyFor() const;
@@ -115,6 +139,7 @@ namespace server {
         std::optional<ModDownload> getDownload(std::string const& id) const;
         std::vector<ModDownload> getDownloads() const;
         bool hasActiveDownloads() const;
+        DownloadStats getStats() const;
 
         bool wantsRestart() const;
     };
@@ -0,0 +1,461 @@
+#include "ModIndexMirror.hpp"
+#include <Geode/loader/Mod.hpp>
+#include <Geode/loader/SettingV3.hpp>
+#include <Geode/utils/JsonValidation.hpp>
+#include <Geode/utils/string.hpp>
+
+using namespace server;
+
+#define GEODE_GD_VERSION_STR GEODE_STR(GEODE_GD_VERSION)
+
+// Bump whenever the format of the saved file changes
+static constexpr int MIRROR_FORMAT_VERSION = 1;
+// How many mods are fetched per request while syncing
+static constexpr size_t SYNC_PAGE_SIZE = 100;
+// Incremental syncs only pick up updated mods, so download counts and
+// removed mods are only refreshed by redownloading the whole index
+static constexpr auto FULL_SYNC_INTERVAL = std::chrono::hours(24);
+
+struct MirroredMod final {
+    ServerModMetadata metadata;
+    // The JSON the mod was parsed from, for saving it back to disk
+    matjson::Value raw;
+    // Lowercased name, ID and developers, for searching
+    std::string searchText;
+};
+
+struct server::ModIndexSnapshot final {
+    // The server this copy is of
+    std::string baseURL;
+    std::chrono::system_clock::time_point syncedAt;
+    std::chrono::system_clock::time_point fullSyncedAt;
+    std::optional<ServerDateTime> newestUpdate;
+    std::unordered_map<std::string, MirroredMod> mods;
+    std::vector<ServerTag> tags;
+    matjson::Value rawTags;
+    // Mods that were added, changed or removed by the sync that produced 
+    // this copy, so only their cached server results need to be dropped
+    std::unordered_set<std::string> changedMods;
+};
+
+using SnapshotTask = Task<std::shared_ptr<ModIndexSnapshot const>>;
+
+static std::filesystem::path getMirrorPath() {
+    return Mod::get()->getSaveDir() / "mod-index.json";
+}
+
+// How long the copy is used before checking for updated mods. Can be 
+// shortened for testing against a local server with 
+// `--geode:mod-index-sync-interval=<seconds>`
+static std::chrono::seconds getSyncInterval() {
+    static const auto value = Loader::get()->parseLaunchArgument<int>("mod-index-sync-interval")
+        .map([](int seconds) { return std::chrono::seconds(seconds); })
+        .unwrapOr(std::chrono::minutes(30));
+    return value;
+}
+
+static int64_t toUnixSeconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+static std::chrono::system_clock::time_point fromUnixSeconds(int64_t seconds) {
+    return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+}
+
+static void addMod(ModIndexSnapshot& snapshot, matjson::Value const& raw) {
+    auto res = ServerModMetadata::parse(raw);
+    if (!res) {
+        log::error("Unable to parse mirrored mod: {}", res.unwrapErr());
+        return;
+    }
+    auto mod = MirroredMod {
+        .metadata = std::move(res).unwrap(),
+        .raw = raw,
+    };
+    mod.searchText = mod.metadata.versions.front().metadata.getName() + "\n" + mod.metadata.id;
+    for (auto const& dev : mod.metadata.developers) {
+        mod.searchText += "\n" + dev.username + "\n" + dev.displayName;
+    }
+    utils::string::toLowerIP(mod.searchText);
+
+    if (auto updated = mod.metadata.updatedAt) {
+        if (!snapshot.newestUpdate || snapshot.newestUpdate->value < updated->value) {
+            snapshot.newestUpdate = updated;
+        }
+    }
+    auto id = mod.metadata.id;
+    snapshot.mods.insert_or_assign(std::move(id), std::move(mod));
+}
+
+static void setTags(ModIndexSnapshot& snapshot, matjson::Value const& raw) {
+    snapshot.rawTags = raw;
+    if (auto tags = ServerTag::parseList(raw)) {
+        snapshot.tags = std::move(tags).unwrap();
+    }
+    else {
+        log::error("Unable to parse mirrored tags: {}", tags.unwrapErr());
+    }
+}
+
+static Result<std::shared_ptr<ModIndexSnapshot const>> loadSnapshot() {
+    GEODE_UNWRAP_INTO(auto json, file::readJson(getMirrorPath()));
+    auto root = checkJson(json, "ModIndexMirror");
+
+    auto snapshot = std::make_shared<ModIndexSnapshot>();
+    if (root.needs("version").get<int>() != MIRROR_FORMAT_VERSION) {
+        return Err("Mirror was saved in an outdated format");
+    }
+    root.needs("base-url").into(snapshot->baseURL);
+    snapshot->syncedAt = fromUnixSeconds(root.needs("synced-at").get<int64_t>());
+    snapshot->fullSyncedAt = fromUnixSeconds(root.needs("full-synced-at").get<int64_t>());
+    for (auto& item : root.needs("mods").items()) {
+        addMod(*snapshot, item.json());
+    }
+    setTags(*snapshot, root.needs("tags").json());
+
+    GEODE_UNWRAP(root.ok());
+    return Ok(snapshot);
+}
+
+static Result<> saveSnapshot(ModIndexSnapshot const& snapshot) {
+    std::vector<matjson::Value> mods;
+    mods.reserve(snapshot.mods.size());
+    for (auto const& [id, mod] : snapshot.mods) {
+        mods.push_back(mod.raw);
+    }
+    auto json = matjson::makeObject({
+        { "version", MIRROR_FORMAT_VERSION },
+        { "base-url", snapshot.baseURL },
+        { "synced-at", toUnixSeconds(snapshot.syncedAt) },
+        { "full-synced-at", toUnixSeconds(snapshot.fullSyncedAt) },
+        { "mods", mods },
+        { "tags", snapshot.rawTags },
+    });
+    return file::writeString(getMirrorPath(), json.dump(matjson::NO_INDENTATION));
+}
+
+static web::WebRequest createRequest() {
+    auto req = web::WebRequest();
+    req.userAgent(getServerUserAgent());
+    return req;
+}
+
+ModIndexMirror* ModIndexMirror::get() {
+    static auto inst = new ModIndexMirror();
+    return inst;
+}
+
+bool ModIndexMirror::isEnabled() const {
+    return Mod::get()->getSettingValue<bool>("offline-mod-index");
+}
+
+void ModIndexMirror::applySnapshot(std::shared_ptr<ModIndexSnapshot const> snapshot) {
+    m_snapshot = snapshot;
+    // Cached server results of the mods that changed are older than the 
+    // new copy
+    invalidateServerCaches(snapshot->changedMods);
+}
+
+void ModIndexMirror::load() {
+    if (m_loading) {
+        return;
+    }
+    if (m_snapshot) {
+        if (std::chrono::system_clock::now() - m_snapshot->syncedAt > getSyncInterval()) {
+            this->sync();
+        }
+        return;
+    }
+    m_loading = true;
+    SnapshotTask::run([](auto, auto) -> SnapshotTask::Result {
+        auto snapshot = loadSnapshot();
+        if (!snapshot) {
+            log::info("Mod index mirror not loaded: {}", snapshot.unwrapErr());
+            return std::shared_ptr<ModIndexSnapshot const>();
+        }
+        return snapshot.unwrap();
+    }, "Load mod index mirror").listen(
+        [this](auto* snapshot) {
+            m_loading = false;
+            if (*snapshot && (*snapshot)->baseURL == getServerAPIBaseURL()) {
+                this->applySnapshot(*snapshot);
+                this->load();
+            }
+            // Nothing saved yet (or it's of a different server)
+            else {
+                this->sync();
+            }
+        },
+        [](auto*) {},
+        [this]() {
+            m_loading = false;
+        }
+    );
+}
+
+void ModIndexMirror::sync() {
+    if (m_syncing) {
+        return;
+    }
+    m_syncing = true;
+
+    // Redownload everything if there's no copy yet or it's old
+    std::optional<ServerDateTime> since;
+    if (m_snapshot && std::chrono::system_clock::now() - m_snapshot->fullSyncedAt < FULL_SYNC_INTERVAL) {
+        since = m_snapshot->newestUpdate;
+    }
+    log::debug("Syncing mod index mirror ({})", since ? "incremental" : "full");
+    this->syncPage(std::make_shared<std::vector<matjson::Value>>(), since, 0);
+}
+
+void ModIndexMirror::syncPage(
+    std::shared_ptr<std::vector<matjson::Value>> fetched,
+    std::optional<ServerDateTime> since, size_t page
+) {
+    auto req = createRequest();
+    req.param("gd", GEODE_GD_VERSION_STR);
+    req.param("geode", Loader::get()->getVersion().toNonVString());
+    req.param("platforms", GEODE_PLATFORM_SHORT_IDENTIFIER);
+    // Newest updates first, so an incremental sync can stop as soon as it
+    // reaches mods it already has
+    req.param("sort", "recently_updated");
+    req.param("page", std::to_string(page + 1));
+    req.param("per_page", std::to_string(SYNC_PAGE_SIZE));
+
+    req.get(getServerAPIBaseURL() + "/mods").listen(
+        [this, fetched, since, page](web::WebResponse* response) {
+            if (!response->ok()) {
+                log::warn("Unable to sync mod index mirror: {}", parseServerError(*response).details);
+                m_syncing = false;
+                return;
+            }
+            auto payload = parseServerPayload(*response);
+            if (!payload) {
+                log::warn("Unable to sync mod index mirror: {}", payload.unwrapErr().details);
+                m_syncing = false;
+                return;
+            }
+            auto root = checkJson(payload.unwrap(), "ServerModsList");
+            size_t count = 0;
+            root.needs("count").into(count);
+
+            bool reachedKnown = false;
+            size_t pageItems = 0;
+            for (auto& item : root.needs("data").items()) {
+                auto json = item.json();
+                pageItems += 1;
+                if (since && json.contains("updated_at")) {
+                    auto updated = ServerDateTime::parse(json["updated_at"].asString().unwrapOr(""));
+                    if (updated && updated.unwrap().value <= since->value) {
+                        reachedKnown = true;
+                    }
+                }
+                fetched->push_back(std::move(json));
+            }
+
+            auto fetchedAll = pageItems < SYNC_PAGE_SIZE || (page + 1) * SYNC_PAGE_SIZE >= count;
+            if (reachedKnown || fetchedAll) {
+                this->finishSync(fetched, !since.has_value());
+            }
+            else {
+                this->syncPage(fetched, since, page + 1);
+            }
+        },
+        [](auto*) {},
+        [this]() {
+            m_syncing = false;
+        }
+    );
+}
+
+void ModIndexMirror::finishSync(std::shared_ptr<std::vector<matjson::Value>> fetched, bool full) {
+    // Tags are few enough to just fetch them every time
+    createRequest().get(getServerAPIBaseURL() + "/detailed-tags").listen(
+        [this, fetched, full](web::WebResponse* response) {
+            std::optional<matjson::Value> tags;
+            if (response->ok()) {
+                if (auto payload = parseServerPayload(*response)) {
+                    tags = payload.unwrap();
+                }
+            }
+
+            // Parsing and saving hundreds of mods takes a while, so do it
+            // off the main thread
+            auto old = m_snapshot;
+            SnapshotTask::run(
+                [old, fetched, full, tags, baseURL = getServerAPIBaseURL()](auto, auto) -> SnapshotTask::Result {
+                    auto snapshot = old && !full ?
+                        std::make_shared<ModIndexSnapshot>(*old) :
+                        std::make_shared<ModIndexSnapshot>();
+                    snapshot->baseURL = baseURL;
+                    snapshot->changedMods.clear();
+                    for (auto const& raw : *fetched) {
+                        addMod(*snapshot, raw);
+                    }
+
+                    // Incremental syncs refetch the newest mod they already 
+                    // had, and full syncs refetch everything, so compare 
+                    // with the old copy instead of marking everything 
+                    // fetched as changed. Without an old copy, whatever is 
+                    // cached came from the server just as recently
+                    if (old && old->baseURL == baseURL) {
+                        for (auto const& raw : *fetched) {
+                            auto id = raw["id"].asString();
+                            if (!id) {
+                                continue;
+                            }
+                            auto prev = old->mods.find(id.unwrap());
+                            if (prev == old->mods.end() || prev->second.raw != raw) {
+                                snapshot->changedMods.insert(id.unwrap());
+                            }
+                        }
+                        if (full) {
+                            for (auto const& [id, mod] : old->mods) {
+                                if (!snapshot->mods.contains(id)) {
+                                    snapshot->changedMods.insert(id);
+                                }
+                            }
+                        }
+                    }
+                    if (tags) {
+                        setTags(*snapshot, *tags);
+                    }
+                    snapshot->syncedAt = std::chrono::system_clock::now();
+                    if (full) {
+                        snapshot->fullSyncedAt = snapshot->syncedAt;
+                    }
+                    if (auto res = saveSnapshot(*snapshot); !res) {
+                        log::warn("Unable to save mod index mirror: {}", res.unwrapErr());
+                    }
+                    return std::shared_ptr<ModIndexSnapshot const>(snapshot);
+                },
+                "Save mod index mirror"
+            ).listen(
+                [this, count = fetched->size()](auto* snapshot) {
+                    m_syncing = false;
+                    log::debug("Synced {} mods to the mod index mirror", count);
+                    this->applySnapshot(*snapshot);
+                },
+                [](auto*) {},
+                [this]() {
+                    m_syncing = false;
+                }
+            );
+        },
+        [](auto*) {},
+        [this]() {
+            m_syncing = false;
+        }
+    );
+}
+
+bool ModIndexMirror::isSyncing() const {
+    return m_syncing;
+}
+
+std::optional<ServerModsList> ModIndexMirror::getMods(ModsQuery const& query) {
+    if (!this->isEnabled() || !m_snapshot) {
+        return std::nullopt;
+    }
+    // The mirror only contains mods for the current platform
+    if (query.platforms != std::unordered_set<PlatformID> { GEODE_PLATFORM_TARGET }) {
+        return std::nullopt;
+    }
+    if (std::chrono::system_clock::now() - m_snapshot->syncedAt > getSyncInterval()) {
+        this->sync();
+    }
+
+    std::optional<std::string> search;
+    if (query.query) {
+        search = utils::string::toLower(*query.query);
+    }
+    std::optional<std::string> developer;
+    if (query.developer) {
+        developer = utils::string::toLower(*query.developer);
+    }
+
+    std::vector<MirroredMod const*> filtered;
+    for (auto const& [id, mod] : m_snapshot->mods) {
+        auto const& metadata = mod.metadata;
+        if (query.featured && metadata.featured != *query.featured) {
+            continue;
+        }
+        if (!std::all_of(query.tags.begin(), query.tags.end(), [&](auto const& tag) {
+            return metadata.tags.contains(tag);
+        })) {
+            continue;
+        }
+        if (developer && !std::any_of(metadata.developers.begin(), metadata.developers.end(), [&](auto const& dev) {
+            return utils::string::toLower(dev.username) == *developer;
+        })) {
+            continue;
+        }
+        if (search && mod.searchText.find(*search) == std::string::npos) {
+            continue;
+        }
+        filtered.push_back(&mod);
+    }
+
+    auto dateOf = [](std::optional<ServerDateTime> const& date) {
+        return date ? date->value : ServerDateTime::Value();
+    };
+    std::sort(filtered.begin(), filtered.end(), [&](MirroredMod const* a, MirroredMod const* b) {
+        switch (query.sorting) {
+            case ModsSort::Downloads: {
+                if (a->metadata.downloadCount != b->metadata.downloadCount) {
+                    return a->metadata.downloadCount > b->metadata.downloadCount;
+                }
+            } break;
+            case ModsSort::RecentlyUpdated: {
+                if (dateOf(a->metadata.updatedAt) != dateOf(b->metadata.updatedAt)) {
+                    return dateOf(a->metadata.updatedAt) > dateOf(b->metadata.updatedAt);
+                }
+            } break;
+            case ModsSort::RecentlyPublished: {
+                if (dateOf(a->metadata.createdAt) != dateOf(b->metadata.createdAt)) {
+                    return dateOf(a->metadata.createdAt) > dateOf(b->metadata.createdAt);
+                }
+            } break;
+        }
+        return a->metadata.id < b->metadata.id;
+    });
+
+    auto list = ServerModsList();
+    list.totalModCount = filtered.size();
+    for (
+        size_t i = query.page * query.pageSize;
+        i < filtered.size() && i < (query.page + 1) * query.pageSize;
+        i += 1
+    ) {
+        list.mods.push_back(filtered[i]->metadata);
+    }
+    return list;
+}
+
+std::optional<ServerModMetadata> ModIndexMirror::getMod(std::string const& id) {
+    if (!this->isEnabled() || !m_snapshot) {
+        return std::nullopt;
+    }
+    auto it = m_snapshot->mods.find(id);
+    if (it == m_snapshot->mods.end() || !it->second.metadata.about) {
+        return std::nullopt;
+    }
+    return it->second.metadata;
+}
+
+std::optional<std::vector<ServerTag>> ModIndexMirror::getTags() {
+    if (!this->isEnabled() || !m_snapshot || m_snapshot->tags.empty()) {
+        return std::nullopt;
+    }
+    return m_snapshot->tags;
+}
+
+$on_mod(Loaded) {
+    if (ModIndexMirror::get()->isEnabled()) {
+        ModIndexMirror::get()->load();
+    }
+    listenForSettingChanges("offline-mod-index", [](bool enabled) {
+        if (enabled) {
+            ModIndexMirror::get()->load();
+        }
+    });
+}
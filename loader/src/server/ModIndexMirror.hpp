@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Server.hpp"
+#include <memory>
+
+using namespace geode::prelude;
+
+namespace server {
+    struct ModIndexSnapshot;
+
+    /**
+     * An optional local copy of the mod index, so browsing mods doesn't need
+     * a round trip to the server for every page, search and filter. The copy
+     * is saved to disk and kept up to date in the background by only
+     * fetching the mods that have been updated since the last sync
+     */
+    class ModIndexMirror final {
+    private:
+        std::shared_ptr<ModIndexSnapshot const> m_snapshot;
+        bool m_loading = false;
+        bool m_syncing = false;
+
+        ModIndexMirror() = default;
+
+        void applySnapshot(std::shared_ptr<ModIndexSnapshot const> snapshot);
+        void syncPage(
+            std::shared_ptr<std::vector<matjson::Value>> fetched,
+            std::optional<ServerDateTime> since, size_t page
+        );
+        void finishSync(std::shared_ptr<std::vector<matjson::Value>> fetched, bool full);
+
+    public:
+        static ModIndexMirror* get();
+
+        /**
+         * Whether the "offline-mod-index" setting is enabled
+         */
+        bool isEnabled() const;
+        /**
+         * Load the copy saved on disk, and sync it if it's out of date
+         */
+        void load();
+        /**
+         * Fetch mods that have changed since the last sync (or the whole
+         * index if the copy is missing or very old). Does nothing if a sync
+         * is already running
+         */
+        void sync();
+        bool isSyncing() const;
+
+        /**
+         * Answer a mods query from the local copy, with the same filtering,
+         * sorting and paging as the server
+         * @returns The mods, or nullopt if the mirror is disabled, not loaded
+         * yet, or can't answer this query
+         */
+        std::optional<ServerModsList> getMods(ModsQuery const& query);
+        /**
+         * Get a mod from the local copy. Mods listed in the index don't
+         * include all of their details, so this only returns mods whose
+         * details are known
+         */
+        std::optional<ServerModMetadata> getMod(std::string const& id);
+        std::optional<std::vector<ServerTag>> getTags();
+    };
+}
@@ -0,0 +1,220 @@
+#include "ResumableDownload.hpp"
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/file.hpp>
+#include <Geode/utils/JsonValidation.hpp>
+#include <Geode/utils/string.hpp>
+#include <mutex>
+#include <unordered_set>
+
+using namespace server;
+
+std::optional<std::string> server::findResponseHeader(web::WebResponse const& response, std::string_view name) {
+    std::optional<std::string> found;
+    for (auto const& header : response.headers()) {
+        if (utils::string::caseInsensitiveCompare(header, name) == std::strong_ordering::equal) {
+            found = response.getAllHeadersNamed(header)->back();
+        }
+    }
+    return found;
+}
+
+std::filesystem::path server::getPartialInfoPath(std::filesystem::path const& path) {
+    auto info = path;
+    info += ".json";
+    return info;
+}
+
+// Partial downloads that some attempt is currently writing to
+static std::mutex s_claimedPartsMutex;
+static std::unordered_set<std::string> s_claimedParts;
+
+DownloadFile::DownloadFile(std::filesystem::path const& path) : path(path) {}
+
+std::shared_ptr<DownloadFile> DownloadFile::claim(std::filesystem::path const& path) {
+    std::unique_lock lock(s_claimedPartsMutex);
+    if (!s_claimedParts.insert(path.string()).second) {
+        return nullptr;
+    }
+    return std::make_shared<DownloadFile>(path);
+}
+
+bool DownloadFile::open(size_t offset) {
+    this->offset = offset;
+    stream.open(path, std::ios::binary | (offset ? std::ios::app : std::ios::trunc));
+    return stream.good();
+}
+bool DownloadFile::write(std::span<const uint8_t> data) {
+    stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!stream) {
+        return false;
+    }
+    hash.update(data);
+    return true;
+}
+std::string DownloadFile::finishHash() {
+    if (!digest) {
+        digest = hash.finish();
+    }
+    return *digest;
+}
+bool DownloadFile::restart() {
+    stream.close();
+    hash = IncrementalHash();
+    digest.reset();
+    return this->open(0);
+}
+bool DownloadFile::hashExisting() {
+    std::ifstream existing(path, std::ios::binary);
+    std::vector<uint8_t> buffer(64 * 1024);
+    size_t remaining = offset;
+    while (remaining > 0) {
+        auto size = std::min(remaining, buffer.size());
+        if (!existing.read(reinterpret_cast<char*>(buffer.data()), size)) {
+            return false;
+        }
+        hash.update(std::span(buffer.data(), size));
+        remaining -= size;
+    }
+    return true;
+}
+
+DownloadFile::~DownloadFile() {
+    stream.close();
+    if (!committed && !keep) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        std::filesystem::remove(getPartialInfoPath(path), ec);
+    }
+    std::unique_lock lock(s_claimedPartsMutex);
+    s_claimedParts.erase(path.string());
+}
+
+std::optional<PartialDownload> server::findPartialDownload(std::filesystem::path const& path, std::string const& hash) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec || size == 0) {
+        return std::nullopt;
+    }
+    auto json = file::readJson(getPartialInfoPath(path));
+    if (!json) {
+        return std::nullopt;
+    }
+    auto root = checkJson(json.unwrap(), "PartialDownload");
+    auto partial = PartialDownload { .size = static_cast<size_t>(size) };
+    auto partHash = root.needs("hash").get<std::string>();
+    root.has("validator").into(partial.validator);
+    if (!root.ok() || partHash != hash) {
+        return std::nullopt;
+    }
+    return partial;
+}
+
+static void savePartialInfo(std::filesystem::path const& path, std::string const& hash, web::WebResponse const& response) {
+    // Only strong ETags can be used to resume a download
+    auto validator = findResponseHeader(response, "ETag");
+    if (validator && validator->starts_with("W/")) {
+        validator = std::nullopt;
+    }
+    if (!validator) {
+        validator = findResponseHeader(response, "Last-Modified");
+    }
+    auto json = matjson::makeObject({
+        { "hash", hash },
+    });
+    if (validator) {
+        json["validator"] = *validator;
+    }
+    (void)file::writeString(getPartialInfoPath(path), json.dump(matjson::NO_INDENTATION));
+}
+
+// Check that a 206 response continues from where the data on disk stops
+static bool isContinuationOf(web::WebResponse const& response, size_t offset) {
+    auto range = findResponseHeader(response, "Content-Range");
+    return range && range->starts_with(fmt::format("bytes {}-", offset));
+}
+
+ClaimedDownload server::claimDownloadFile(
+    std::filesystem::path const& dir, std::string const& id, std::string const& hash
+) {
+    auto claimed = ClaimedDownload { .file = DownloadFile::claim(dir / (id + ".geode.part")) };
+    if (claimed.file) {
+        claimed.partial = findPartialDownload(claimed.file->path, hash);
+    }
+    else {
+        // A previous attempt is still winding down, so leave its data 
+        // alone and download to a file of our own
+        static std::atomic_size_t s_attempt = 0;
+        claimed.file = DownloadFile::claim(dir / fmt::format("{}.{}.geode.part", id, s_attempt++));
+        claimed.file->keep = false;
+    }
+    return claimed;
+}
+
+void server::setUpDownloadRequest(
+    web::WebRequest& req, std::shared_ptr<DownloadFile> file,
+    std::optional<PartialDownload> const& partial, std::string const& hash
+) {
+    if (partial) {
+        req.header("Range", fmt::format("bytes={}-", partial->size));
+        // Only continue if the package hasn't changed on the server; 
+        // otherwise it's sent in full
+        if (partial->validator) {
+            req.header("If-Range", *partial->validator);
+        }
+    }
+    req.onResponseStart([file, hash](web::WebResponse const& response) {
+        if (response.code() == 206) {
+            if (!file->offset || !isContinuationOf(response, file->offset) || !file->hashExisting()) {
+                file->keep = false;
+                return false;
+            }
+        }
+        else if (file->offset && !file->restart()) {
+            return false;
+        }
+        savePartialInfo(file->path, hash, response);
+        return true;
+    });
+    // Write the package to disk and hash it as it arrives instead of 
+    // keeping the whole thing in memory
+    req.onResponseChunk([file](std::span<const uint8_t> chunk) {
+        return file->write(chunk);
+    });
+}
+
+void server::handleFailedDownload(DownloadFile& file, web::WebResponse const& response) {
+    // The server can't continue from where the data on disk stops, so the 
+    // next attempt has to start over
+    if (response.code() == 416) {
+        file.keep = false;
+    }
+}
+
+Result<> server::verifyDownload(DownloadFile& file, std::string const& id, std::string const& hash) {
+    file.stream.close();
+    if (file.stream.fail()) {
+        file.keep = false;
+        return Err("Unable to write the downloaded file");
+    }
+    if (auto actualHash = file.finishHash(); actualHash != hash) {
+        file.keep = false;
+        log::error("Failed to download {}, hash mismatch ({} != {})", id, actualHash, hash);
+        return Err("Hash mismatch, downloaded file did not match what was expected");
+    }
+    return Ok();
+}
+
+void server::removeStalePartialDownloads(std::filesystem::path const& dir) {
+    std::error_code ec;
+    auto now = std::filesystem::file_time_type::clock::now();
+    for (auto const& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (!entry.path().string().ends_with(".geode.part")) {
+            continue;
+        }
+        auto modified = entry.last_write_time(ec);
+        if (!ec && now - modified > PARTIAL_DOWNLOAD_MAX_AGE) {
+            std::filesystem::remove(entry.path(), ec);
+            std::filesystem::remove(getPartialInfoPath(entry.path()), ec);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <Geode/utils/web.hpp>
+#include <hash/hash.hpp>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+
+using namespace geode::prelude;
+
+// Downloading mod packages to disk so that an interrupted download can be 
+// continued later with a range request. Only depends on the public API so 
+// the download tests can build it in
+
+namespace server {
+    // Partial downloads older than this are deleted on startup
+    constexpr auto PARTIAL_DOWNLOAD_MAX_AGE = std::chrono::hours(24 * 7);
+
+    /**
+     * Get a response header by its case-insensitive name. If redirects added 
+     * headers with the same name, the one from the final response is returned
+     */
+    std::optional<std::string> findResponseHeader(web::WebResponse const& response, std::string_view name);
+
+    /**
+     * Next to every partial download is a small file recording what it's a 
+     * part of, so it can be resumed later
+     */
+    std::filesystem::path getPartialInfoPath(std::filesystem::path const& path);
+
+    /**
+     * A package being downloaded straight to disk, hashed as it arrives. If 
+     * the download doesn't finish, the data received so far is kept so a 
+     * later attempt can continue from where this one stopped
+     */
+    struct DownloadFile final {
+        std::filesystem::path path;
+        std::ofstream stream;
+        IncrementalHash hash;
+        std::optional<std::string> digest;
+        // How much of the package was already on disk from an earlier attempt; 
+        // read by the main thread for progress while the request may reset it
+        std::atomic_size_t offset = 0;
+        // Whether the data on disk is worth resuming from if this attempt fails
+        std::atomic_bool keep = true;
+        // Once moved into the mods directory, the file is no longer ours to delete
+        bool committed = false;
+
+        DownloadFile(std::filesystem::path const& path);
+        DownloadFile(DownloadFile const&) = delete;
+
+        /**
+         * Take ownership of the partial download at the given path
+         * @returns The file, or null if another attempt is still using it
+         */
+        static std::shared_ptr<DownloadFile> claim(std::filesystem::path const& path);
+
+        bool open(size_t offset);
+        bool write(std::span<const uint8_t> data);
+        // The hash of everything written, once the download is over
+        std::string finishHash();
+        // Throw away the data written so far, for when the server sends the 
+        // whole package instead of the requested range
+        bool restart();
+        // Feed the data from an earlier attempt into the hash, for when the 
+        // server continues from where it stopped
+        bool hashExisting();
+
+        // Whoever ends up holding the file last (the request thread, the 
+        // listener or the install task) cleans up after failed downloads
+        ~DownloadFile();
+    };
+
+    struct PartialDownload {
+        size_t size;
+        // ETag or Last-Modified of the response the data came from
+        std::optional<std::string> validator;
+    };
+
+    /**
+     * Check if there is data from an earlier attempt at downloading the 
+     * package with the given hash
+     */
+    std::optional<PartialDownload> findPartialDownload(std::filesystem::path const& path, std::string const& hash);
+
+    struct ClaimedDownload {
+        std::shared_ptr<DownloadFile> file;
+        // Data from an earlier attempt to continue from, if there is any
+        std::optional<PartialDownload> partial;
+    };
+
+    /**
+     * Claim the file to download the package of a mod into, in the given 
+     * directory. The file still has to be opened at the partial download's 
+     * size (or 0)
+     */
+    ClaimedDownload claimDownloadFile(
+        std::filesystem::path const& dir, std::string const& id, std::string const& hash
+    );
+
+    /**
+     * Make a request download the package into the file, continuing the 
+     * partial download if there is one and the server still has the same 
+     * package
+     */
+    void setUpDownloadRequest(
+        web::WebRequest& req, std::shared_ptr<DownloadFile> file,
+        std::optional<PartialDownload> const& partial, std::string const& hash
+    );
+
+    /**
+     * Call when the download request fails, so that data the server can't 
+     * continue from isn't kept for the next attempt
+     */
+    void handleFailedDownload(DownloadFile& file, web::WebResponse const& response);
+
+    /**
+     * Check that the download finished and matches the expected hash
+     */
+    Result<> verifyDownload(DownloadFile& file, std::string const& id, std::string const& hash);
+
+    /**
+     * Delete partial downloads in the given directory that were never 
+     * resumed
+     */
+    void removeStalePartialDownloads(std::filesystem::path const& dir);
+}
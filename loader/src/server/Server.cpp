@@ -1,80 +1,256 @@
 #include "Server.hpp"
 #include <Geode/utils/JsonValidation.hpp>
 #include <Geode/utils/ranges.hpp>
+#include <Geode/utils/string.hpp>
 #include <chrono>
+#include <deque>
+#include <list>
+#include <unordered_map>
 #include <date/date.h>
 #include <fmt/core.h>
 #include <loader/ModMetadataImpl.hpp>
 #include <fmt/chrono.h>
 #include <loader/LoaderImpl.hpp>
 #include "../internal/about.hpp"
+#include "ModIndexMirror.hpp"
 #include "Geode/loader/Loader.hpp"
 
 using namespace server;
 
 #define GEODE_GD_VERSION_STR GEODE_STR(GEODE_GD_VERSION)
 
-template <class K, class V>
+static void hashCombine(size_t& seed, size_t value) {
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+/**
+ * Hashes the argument tuples of the cached server functions
+ */
+struct CacheKeyHash final {
+    template <class T>
+        requires requires (T const& t) { std::hash<T>()(t); }
+    size_t hashPart(T const& value) const {
+        return std::hash<T>()(value);
+    }
+    template <class T>
+    size_t hashPart(std::optional<T> const& value) const {
+        return value ? this->hashPart(*value) : 0;
+    }
+    template <class T>
+    size_t hashPart(std::unordered_set<T> const& set) const {
+        // Sets have no defined order, so combine their hashes in a way that 
+        // doesn't depend on it
+        size_t hash = set.size();
+        for (auto const& item : set) {
+            hash += this->hashPart(item);
+        }
+        return hash;
+    }
+    size_t hashPart(ModsSort sorting) const {
+        return std::hash<int>()(static_cast<int>(sorting));
+    }
+    size_t hashPart(ModsQuery const& query) const {
+        size_t hash = 0;
+        hashCombine(hash, this->hashPart(query.query));
+        hashCombine(hash, this->hashPart(query.platforms));
+        hashCombine(hash, this->hashPart(query.tags));
+        hashCombine(hash, this->hashPart(query.featured));
+        hashCombine(hash, this->hashPart(query.sorting));
+        hashCombine(hash, this->hashPart(query.developer));
+        hashCombine(hash, this->hashPart(query.page));
+        hashCombine(hash, this->hashPart(query.pageSize));
+        return hash;
+    }
+    size_t hashPart(ModVersion const& version) const {
+        return std::visit(makeVisitor {
+            [](ModVersionLatest const&) -> size_t {
+                return 0;
+            },
+            [](ModVersionMajor const& ver) -> size_t {
+                return std::hash<size_t>()(ver.major) + 1;
+            },
+            [](ModVersionSpecific const& ver) -> size_t {
+                return std::hash<std::string>()(ver.toVString());
+            },
+        }, version);
+    }
+
+    template <class... Args>
+    size_t operator()(std::tuple<Args...> const& key) const {
+        size_t hash = 0;
+        std::apply([&](auto const&... parts) {
+            (hashCombine(hash, this->hashPart(parts)), ...);
+        }, key);
+        return hash;
+    }
+};
+
+// Rough estimates of how much memory cached values take up; these don't need 
+// to be exact, just in the right ballpark for the cache's memory budget
+template <class T>
+static size_t cacheSizeOf(T const&) {
+    return sizeof(T);
+}
+static size_t cacheSizeOf(std::string const& str) {
+    return sizeof(str) + str.size();
+}
+static size_t cacheSizeOf(ByteVector const& data) {
+    return sizeof(data) + data.size();
+}
+static size_t cacheSizeOf(ServerModVersion const& version) {
+    // ModMetadata is behind a pointer; most of its size is the description 
+    // and the other strings in it
+    auto size = sizeof(version) + version.downloadURL.size() + version.hash.size() + 512;
+    if (auto details = version.metadata.getDetails()) {
+        size += details->size();
+    }
+    return size;
+}
+static size_t cacheSizeOf(ServerModMetadata const& metadata) {
+    auto size = sizeof(metadata);
+    for (auto const& version : metadata.versions) {
+        size += cacheSizeOf(version);
+    }
+    size += metadata.developers.size() * sizeof(ServerDeveloper);
+    size += metadata.about ? metadata.about->size() : 0;
+    size += metadata.changelog ? metadata.changelog->size() : 0;
+    return size;
+}
+static size_t cacheSizeOf(ServerModsList const& list) {
+    auto size = sizeof(list);
+    for (auto const& mod : list.mods) {
+        size += cacheSizeOf(mod);
+    }
+    return size;
+}
+template <class T>
+static size_t cacheSizeOf(std::vector<T> const& list) {
+    auto size = sizeof(list);
+    for (auto const& item : list) {
+        size += cacheSizeOf(item);
+    }
+    return size;
+}
+template <class T>
+static size_t cacheSizeOf(Result<T, ServerError> const& result) {
+    if (result.isOk()) {
+        return cacheSizeOf(result.unwrap());
+    }
+    return sizeof(ServerError) + result.unwrapErr().details.size();
+}
+
+/**
+ * A least-recently-used cache that is limited both by how many entries it 
+ * has and by roughly how much memory those entries take up
+ */
+template <class K, class V, class Hash>
     requires std::equality_comparable<K> && std::copy_constructible<K>
 class CacheMap final {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry final {
+        V value;
+        size_t size = 0;
+        Clock::time_point fetchedAt = Clock::now();
+        // Identifies which request the entry currently holds, so results of 
+        // requests that have since been replaced can be ignored
+        size_t generation = 0;
+        bool refreshing = false;
+        // Fetched ahead of time and not asked for by anything yet
+        bool prefetched = false;
+    };
+
 private:
-    // I know this looks like a goofy choice over just
-    // `std::unordered_map`, but hear me out:
-    //
-    // This needs preserved insertion order (so shrinking the cache
-    // to match size limits doesn't just have to erase random
-    // elements)
-    //
-    // If this used a map for values and another vector for storing
-    // insertion order, it would have a pretty big memory footprint
-    // (two copies of Query, one for order, one for map + two heap
-    // allocations on top of that)
-    //
-    // In addition, it would be a bad idea to have a cache of 1000s
-    // of items in any case (since that would likely take up a ton
-    // of memory, which we want to avoid since it's likely many
-    // crashes with the old index were due to too much memory
-    // usage)
-    //
-    // Linear searching a vector of at most a couple dozen items is
-    // lightning-fast (🚀), and besides the main performance benefit
-    // comes from the lack of a web request - not how many extra
-    // milliseconds we can squeeze out of a map access
-    std::vector<std::pair<K, V>> m_values;
-    size_t m_sizeLimit = 20;
+    struct Node final {
+        Entry entry;
+        typename std::list<K const*>::iterator order;
+    };
 
-public:
-    std::optional<V> get(K const& key) {
-        auto it = std::find_if(m_values.begin(), m_values.end(), [key](auto const& q) {
-            return q.first == key;
-        });
-        if (it != m_values.end()) {
-            return it->second;
+    // Nodes in an unordered_map are never moved, so the usage order can 
+    // point to the keys in the map instead of storing them twice
+    std::unordered_map<K, Node, Hash> m_values;
+    // Most recently used first
+    std::list<K const*> m_order;
+    size_t m_sizeLimit = 20;
+    size_t m_byteLimit = 32 * 1024 * 1024;
+    size_t m_byteSize = 0;
+
+    void evict() {
+        // Always keep at least the newest entry, even if it's over budget on 
+        // its own
+        while (
+            m_order.size() > 1 &&
+            (m_order.size() > m_sizeLimit || m_byteSize > m_byteLimit)
+        ) {
+            this->remove(*m_order.back());
         }
-        return std::nullopt;
     }
-    void add(K&& key, V&& value) {
-        auto pair = std::make_pair(std::move(key), std::move(value));
 
-        // Shift and replace last element if we're at cache size limit
-        if (m_values.size() >= m_sizeLimit) {
-            std::shift_left(m_values.begin(), m_values.end(), 1);
-            m_values.back() = std::move(pair);
+public:
+    Entry* get(K const& key) {
+        auto it = m_values.find(key);
+        if (it == m_values.end()) {
+            return nullptr;
         }
-        // Otherwise append at end
-        else {
-            m_values.emplace_back(std::move(pair));
+        m_order.splice(m_order.begin(), m_order, it->second.order);
+        return &it->second.entry;
+    }
+    // Like get, but doesn't count as a use of the entry
+    Entry* peek(K const& key) {
+        auto it = m_values.find(key);
+        return it != m_values.end() ? &it->second.entry : nullptr;
+    }
+    Entry& add(K&& key, Entry&& entry) {
+        this->remove(key);
+        auto [it, _] = m_values.emplace(std::move(key), Node { .entry = std::move(entry) });
+        m_order.push_front(&it->first);
+        it->second.order = m_order.begin();
+        m_byteSize += it->second.entry.size;
+        this->evict();
+        // The newest entry is never evicted, so this is still valid
+        return it->second.entry;
+    }
+    void resize(K const& key, size_t size) {
+        if (auto entry = this->peek(key)) {
+            m_byteSize = m_byteSize - entry->size + size;
+            entry->size = size;
+            this->evict();
         }
     }
     void remove(K const& key) {
-        ranges::remove(m_values, [&key](auto const& q) { return q.first == key; });
+        auto it = m_values.find(key);
+        if (it != m_values.end()) {
+            m_byteSize -= it->second.entry.size;
+            m_order.erase(it->second.order);
+            m_values.erase(it);
+        }
+    }
+    template <class Pred>
+    void removeIf(Pred&& pred) {
+        for (auto it = m_values.begin(); it != m_values.end();) {
+            if (pred(it->first, it->second.entry.value)) {
+                m_byteSize -= it->second.entry.size;
+                m_order.erase(it->second.order);
+                it = m_values.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
     }
     void clear() {
         m_values.clear();
+        m_order.clear();
+        m_byteSize = 0;
     }
     void limit(size_t size) {
         m_sizeLimit = size;
-        m_values.clear();
+        this->evict();
+    }
+    void byteLimit(size_t bytes) {
+        m_byteLimit = bytes;
+        this->evict();
     }
     size_t size() const {
         return m_values.size();
@@ -82,6 +258,9 @@ public:
     size_t limit() const {
         return m_sizeLimit;
     }
+    size_t byteSize() const {
+        return m_byteSize;
+    }
 };
 
 template <class F>
@@ -108,10 +287,94 @@ public:
     using Extract  = ExtractFun<decltype(F)>;
     using CacheKey = typename Extract::CacheKey;
     using Value    = typename Extract::Value;
+    using Map      = CacheMap<CacheKey, ServerRequest<Value>, CacheKeyHash>;
+    using Clock    = typename Map::Clock;
 
 private:
     std::mutex m_mutex;
-    CacheMap<CacheKey, ServerRequest<Value>> m_cache;
+    Map m_cache;
+    size_t m_nextGeneration = 0;
+    // How long results are used as-is
+    typename Clock::duration m_maxAge = std::chrono::minutes(5);
+    // How long after that results are still shown while they're refreshed 
+    // in the background
+    typename Clock::duration m_maxStale = std::chrono::hours(1);
+
+    static bool isOk(ServerRequest<Value>& request) {
+        auto value = request.getFinishedValue();
+        return value && value->isOk();
+    }
+
+    // Update the entry's size once its request finishes (and drop it if 
+    // the request got cancelled, so it is retried next time)
+    void track(CacheKey const& key, ServerRequest<Value> request, size_t generation) {
+        if (auto value = request.getFinishedValue()) {
+            m_cache.resize(key, cacheSizeOf(*value));
+            return;
+        }
+        request.listen(
+            [this, key, generation](auto* value) {
+                std::unique_lock lock(m_mutex);
+                auto entry = m_cache.peek(key);
+                if (entry && entry->generation == generation) {
+                    m_cache.resize(key, cacheSizeOf(*value));
+                }
+            },
+            [](auto*) {},
+            [this, key, generation]() {
+                std::unique_lock lock(m_mutex);
+                auto entry = m_cache.peek(key);
+                if (entry && entry->generation == generation) {
+                    m_cache.remove(key);
+                }
+            }
+        );
+    }
+
+    template <class... Args>
+    ServerRequest<Value> fetch(CacheKey&& key, bool prefetched, Args const&... args) {
+        auto request = Extract::invoke(F, args...);
+        auto generation = m_nextGeneration++;
+        auto keyCopy = key;
+        m_cache.add(std::move(key), typename Map::Entry {
+            .value = request,
+            .generation = generation,
+            .prefetched = prefetched,
+        });
+        this->track(keyCopy, request, generation);
+        return request;
+    }
+
+    // Fetch a fresh value for a stale entry, swapping it in only once it 
+    // has successfully finished
+    template <class... Args>
+    void refresh(CacheKey const& key, typename Map::Entry& entry, Args const&... args) {
+        auto request = Extract::invoke(F, args...);
+        entry.refreshing = true;
+        request.listen(
+            [this, key, generation = entry.generation, request](auto* value) {
+                std::unique_lock lock(m_mutex);
+                auto entry = m_cache.peek(key);
+                if (!entry || entry->generation != generation) {
+                    return;
+                }
+                entry->refreshing = false;
+                if (value->isOk()) {
+                    entry->value = request;
+                    entry->fetchedAt = Clock::now();
+                    m_cache.resize(key, cacheSizeOf(*value));
+                }
+            },
+            [](auto*) {},
+            [this, key, generation = entry.generation]() {
+                std::unique_lock lock(m_mutex);
+                auto entry = m_cache.peek(key);
+                if (entry && entry->generation == generation) {
+                    entry->refreshing = false;
+                }
+            }
+        );
+    }
 
 public:
     FunCache() = default;
@@ -121,12 +384,54 @@ public:
     template <class... Args>
     ServerRequest<Value> get(Args const&... args) {
         std::unique_lock lock(m_mutex);
-        if (auto v = m_cache.get(Extract::key(args...))) {
-            return *v;
+        auto key = Extract::key(args...);
+        if (auto entry = m_cache.get(key)) {
+            entry->prefetched = false;
+            auto age = Clock::now() - entry->fetchedAt;
+            // Requests still in progress are always reused
+            if (entry->value.isPending() || (age < m_maxAge && !entry->value.isCancelled())) {
+                return entry->value;
+            }
+            // Serve stale results while a fresh copy is downloaded
+            if (age < m_maxAge + m_maxStale && isOk(entry->value)) {
+                if (!entry->refreshing) {
+                    this->refresh(key, *entry, args...);
+                }
+                return entry->value;
+            }
+        }
+        return this->fetch(std::move(key), false, args...);
+    }
+
+    /**
+     * Like get, but without refreshing stale entries, and the request can 
+     * be cancelled with cancelPrefetch until something else asks for it
+     */
+    template <class... Args>
+    ServerRequest<Value> prefetch(Args const&... args) {
+        std::unique_lock lock(m_mutex);
+        auto key = Extract::key(args...);
+        if (auto entry = m_cache.peek(key)) {
+            auto age = Clock::now() - entry->fetchedAt;
+            if (entry->value.isPending() || (age < m_maxAge + m_maxStale && !entry->value.isCancelled())) {
+                return entry->value;
+            }
         }
-        auto f = Extract::invoke(F, args...);
-        m_cache.add(Extract::key(args...), ServerRequest<Value>(f));
-        return f;
+        return this->fetch(std::move(key), true, args...);
+    }
+    template <class... Args>
+    void cancelPrefetch(Args const&... args) {
+        std::unique_lock lock(m_mutex);
+        auto key = Extract::key(args...);
+        auto entry = m_cache.peek(key);
+        if (!entry || !entry->prefetched || !entry->value.isPending()) {
+            return;
+        }
+        auto request = entry->value;
+        m_cache.remove(key);
+        // Cancelling calls back into the cache
+        lock.unlock();
+        request.cancel();
     }
 
     template <class... Args>
@@ -134,6 +439,14 @@ public:
         std::unique_lock lock(m_mutex);
         m_cache.remove(Extract::key(args...));
     }
+    /**
+     * Remove every entry for which `pred(key, request)` returns true
+     */
+    template <class Pred>
+    void removeIf(Pred&& pred) {
+        std::unique_lock lock(m_mutex);
+        m_cache.removeIf(std::forward<Pred>(pred));
+    }
 
     size_t size() {
         std::unique_lock lock(m_mutex);
@@ -143,6 +456,15 @@ public:
         std::unique_lock lock(m_mutex);
         m_cache.limit(size);
     }
+    void byteLimit(size_t bytes) {
+        std::unique_lock lock(m_mutex);
+        m_cache.byteLimit(bytes);
+    }
+    void expiry(typename Clock::duration maxAge, typename Clock::duration maxStale) {
+        std::unique_lock lock(m_mutex);
+        m_maxAge = maxAge;
+        m_maxStale = maxStale;
+    }
     void clear() {
         std::unique_lock lock(m_mutex);
         m_cache.clear();
@@ -167,7 +489,7 @@ static const char* jsonTypeToString(matjson::Type const& type) {
     }
 }
 
-static Result<matjson::Value, ServerError> parseServerPayload(web::WebResponse const& response) {
+Result<matjson::Value, ServerError> server::parseServerPayload(web::WebResponse const& response) {
     auto asJson = response.json();
     if (!asJson) {
         return Err(ServerError(response.code(), "Response was not valid JSON: {}", asJson.unwrapErr()));
@@ -182,7 +504,7 @@ static Result<matjson::Value, ServerError> parseServerPayload(web::WebResponse c
     return Ok(json["payload"]);
 }
 
-static ServerError parseServerError(web::WebResponse const& error) {
+ServerError server::parseServerError(web::WebResponse const& error) {
     // The server should return errors as `{ "error": "...", "payload": "" }`
     if (auto asJson = error.json()) {
         auto json = asJson.unwrap();
@@ -214,6 +536,42 @@ static ServerProgress parseServerProgress(web::WebProgress const& prog, auto msg
     }
 }
 
+/**
+ * Parse a response on a worker thread. Continuations added with Task::map 
+ * run on the main thread, and a page of mods can be hundreds of KB of JSON. 
+ * The returned task owns the request, so cancelling it cancels the request 
+ * (or the parsing) right away
+ */
+template <class T>
+static ServerRequest<T> parseResponseAsync(
+    web::WebTask request, std::string const& message,
+    std::function<Result<T, ServerError>(web::WebResponse const&)> parse
+) {
+    return request.chain(
+        [parse, message](web::WebResponse* response) {
+            return ServerRequest<T>::run(
+                [parse, message, response = *response](auto, auto hasBeenCancelled) -> typename ServerRequest<T>::Result {
+                    if (hasBeenCancelled()) {
+                        return ServerRequest<T>::Cancel();
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    auto result = parse(response);
+                    log::debug(
+                        "Parsed {} bytes for '{}' in {}", response.size(), message,
+                        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+                    );
+                    return std::move(result);
+                },
+                fmt::format("Parse '{}'", message)
+            );
+        },
+        [message](web::WebProgress* progress) {
+            return parseServerProgress(*progress, message);
+        },
+        message
+    );
+}
+
 const char* server::sortToString(ModsSort sorting) {
     switch (sorting) {
         default:
@@ -541,7 +899,11 @@ bool ServerModMetadata::hasUpdateForInstalledMod() const {
 }
 
 std::string server::getServerAPIBaseURL() {
-    return "https://api.geode-sdk.org/v1";
+    // Can be pointed to a local server for testing with 
+    // `--geode:server-url=http://localhost:8080/v1`
+    static const auto value = Loader::get()->getLaunchArgument("server-url")
+        .value_or("https://api.geode-sdk.org/v1");
+    return value;
 }
 
 template <class... Args>
@@ -565,6 +927,9 @@ std::string server::getServerUserAgent() {
 
 ServerRequest<ServerModsList> server::getMods(ModsQuery const& query, bool useCache) {
     if (useCache) {
+        if (auto mirrored = ModIndexMirror::get()->getMods(query)) {
+            return ServerRequest<ServerModsList>::immediate(Ok(std::move(*mirrored)));
+        }
         return getCache<getMods>().get(query);
     }
 
@@ -604,75 +969,65 @@ ServerRequest<ServerModsList> server::getMods(ModsQuery const& query, bool useCa
     req.param("page", std::to_string(query.page + 1));
     req.param("per_page", std::to_string(query.pageSize));
 
-    return req.get(formatServerURL("/mods")).map(
-        [](web::WebResponse* response) -> Result<ServerModsList, ServerError> {
-            if (response->ok()) {
+    return parseResponseAsync<ServerModsList>(
+        req.get(formatServerURL("/mods")), "Downloading mods",
+        [](web::WebResponse const& response) -> Result<ServerModsList, ServerError> {
+            if (response.ok()) {
                 // Parse payload
-                auto payload = parseServerPayload(*response);
+                auto payload = parseServerPayload(response);
                 if (!payload) {
                     return Err(payload.unwrapErr());
                 }
                 // Parse response
                 auto list = ServerModsList::parse(payload.unwrap());
                 if (!list) {
-                    return Err(ServerError(response->code(), "Unable to parse response: {}", list.unwrapErr()));
+                    return Err(ServerError(response.code(), "Unable to parse response: {}", list.unwrapErr()));
                 }
                 return Ok(list.unwrap());
             }
             // Treat a 404 as empty mods list
-            if (response->code() == 404) {
+            if (response.code() == 404) {
                 return Ok(ServerModsList());
             }
-            return Err(parseServerError(*response));
-        },
-        [](web::WebProgress* progress) {
-            return parseServerProgress(*progress, "Downloading mods");
+            return Err(parseServerError(response));
         }
     );
 }
 
 ServerRequest<ServerModMetadata> server::getMod(std::string const& id, bool useCache) {
     if (useCache) {
+        if (auto mirrored = ModIndexMirror::get()->getMod(id)) {
+            return ServerRequest<ServerModMetadata>::immediate(Ok(std::move(*mirrored)));
+        }
         return getCache<getMod>().get(id);
     }
     auto req = web::WebRequest();
     req.userAgent(getServerUserAgent());
-    return req.get(formatServerURL("/mods/{}", id)).map(
-        [](web::WebResponse* response) -> Result<ServerModMetadata, ServerError> {
-            if (response->ok()) {
+    return parseResponseAsync<ServerModMetadata>(
+        req.get(formatServerURL("/mods/{}", id)), "Downloading metadata for " + id,
+        [](web::WebResponse const& response) -> Result<ServerModMetadata, ServerError> {
+            if (response.ok()) {
                 // Parse payload
-                auto payload = parseServerPayload(*response);
+                auto payload = parseServerPayload(response);
                 if (!payload) {
                     return Err(payload.unwrapErr());
                 }
                 // Parse response
                 auto list = ServerModMetadata::parse(payload.unwrap());
                 if (!list) {
-                    return Err(ServerError(response->code(), "Unable to parse response: {}", list.unwrapErr()));
+                    return Err(ServerError(response.code(), "Unable to parse response: {}", list.unwrapErr()));
                 }
                 return Ok(list.unwrap());
             }
-            return Err(parseServerError(*response));
-        },
-        [id](web::WebProgress* progress) {
-            return parseServerProgress(*progress, "Downloading metadata for " + id);
+            return Err(parseServerError(response));
         }
     );
 }
 
 ServerRequest<ServerModVersion> server::getModVersion(std::string const& id, ModVersion const& version, bool useCache) {
     if (useCache) {
-        auto& cache = getCache<getModVersion>();
-
-        auto cachedRequest = cache.get(id, version);
-
-        // if mod installation was cancelled, remove it from cache and fetch again
-        if (cachedRequest.isCancelled()) {
-            cache.remove(id, version);
-            return cache.get(id, version);
-        } else {
-            return cachedRequest;
-        }
+        // If mod installation was cancelled, the cache fetches it again
+        return getCache<getModVersion>().get(id, version);
     }
 
     auto req = web::WebRequest();
@@ -692,25 +1047,23 @@ ServerRequest<ServerModVersion> server::getModVersion(std::string const& id, Mod
         },
     }, version);
 
-    return req.get(formatServerURL("/mods/{}/versions/{}?gd={}&platforms={}", id, versionURL, Loader::get()->getGameVersion(), GEODE_PLATFORM_SHORT_IDENTIFIER)).map(
-        [](web::WebResponse* response) -> Result<ServerModVersion, ServerError> {
-            if (response->ok()) {
+    return parseResponseAsync<ServerModVersion>(
+        req.get(formatServerURL("/mods/{}/versions/{}?gd={}&platforms={}", id, versionURL, Loader::get()->getGameVersion(), GEODE_PLATFORM_SHORT_IDENTIFIER)), "Downloading metadata for " + id,
+        [](web::WebResponse const& response) -> Result<ServerModVersion, ServerError> {
+            if (response.ok()) {
                 // Parse payload
-                auto payload = parseServerPayload(*response);
+                auto payload = parseServerPayload(response);
                 if (!payload) {
                     return Err(payload.unwrapErr());
                 }
                 // Parse response
                 auto list = ServerModVersion::parse(payload.unwrap());
                 if (!list) {
-                    return Err(ServerError(response->code(), "Unable to parse response: {}", list.unwrapErr()));
+                    return Err(ServerError(response.code(), "Unable to parse response: {}", list.unwrapErr()));
                 }
                 return Ok(list.unwrap());
             }
-            return Err(parseServerError(*response));
-        },
-        [id](web::WebProgress* progress) {
-            return parseServerProgress(*progress, "Downloading metadata for " + id);
+            return Err(parseServerError(response));
         }
     );
 }
@@ -721,6 +1074,8 @@ ServerRequest<ByteVector> server::getModLogo(std::string const& id, bool useCach
     }
     auto req = web::WebRequest();
     req.userAgent(getServerUserAgent());
+    // Logos rarely change, so keep them between launches
+    req.cachePolicy(web::CachePolicy::Default);
     return req.get(formatServerURL("/mods/{}/logo", id)).map(
         [](web::WebResponse* response) -> Result<ByteVector, ServerError> {
             if (response->ok()) {
@@ -736,28 +1091,30 @@ ServerRequest<ByteVector> server::getModLogo(std::string const& id, bool useCach
 
 ServerRequest<std::vector<ServerTag>> server::getTags(bool useCache) {
     if (useCache) {
+        if (auto mirrored = ModIndexMirror::get()->getTags()) {
+            return ServerRequest<std::vector<ServerTag>>::immediate(Ok(std::move(*mirrored)));
+        }
         return getCache<getTags>().get();
     }
     auto req = web::WebRequest();
     req.userAgent(getServerUserAgent());
-    return req.get(formatServerURL("/detailed-tags")).map(
-        [](web::WebResponse* response) -> Result<std::vector<ServerTag>, ServerError> {
-            if (response->ok()) {
+    req.cachePolicy(web::CachePolicy::Default);
+    return parseResponseAsync<std::vector<ServerTag>>(
+        req.get(formatServerURL("/detailed-tags")), "Downloading valid tags",
+        [](web::WebResponse const& response) -> Result<std::vector<ServerTag>, ServerError> {
+            if (response.ok()) {
                 // Parse payload
-                auto payload = parseServerPayload(*response);
+                auto payload = parseServerPayload(response);
                 if (!payload) {
                     return Err(payload.unwrapErr());
                 }
                 auto list = ServerTag::parseList(payload.unwrap());
                 if (!list) {
-                    return Err(ServerError(response->code(), "Unable to parse response: {}", list.unwrapErr()));
+                    return Err(ServerError(response.code(), "Unable to parse response: {}", list.unwrapErr()));
                 }
                 return Ok(list.unwrap());
             }
-            return Err(parseServerError(*response));
-        },
-        [](web::WebProgress* progress) {
-            return parseServerProgress(*progress, "Downloading valid tags");
+            return Err(parseServerError(response));
         }
     );
 }
@@ -789,25 +1146,23 @@ ServerRequest<std::vector<ServerModUpdate>> server::batchedCheckUpdates(std::vec
     req.param("geode", Loader::get()->getVersion().toNonVString());
 
     req.param("ids", ranges::join(batch, ";"));
-    return req.get(formatServerURL("/mods/updates")).map(
-        [](web::WebResponse* response) -> Result<std::vector<ServerModUpdate>, ServerError> {
-            if (response->ok()) {
+    return parseResponseAsync<std::vector<ServerModUpdate>>(
+        req.get(formatServerURL("/mods/updates")), "Checking updates for mods",
+        [](web::WebResponse const& response) -> Result<std::vector<ServerModUpdate>, ServerError> {
+            if (response.ok()) {
                 // Parse payload
-                auto payload = parseServerPayload(*response);
+                auto payload = parseServerPayload(response);
                 if (!payload) {
                     return Err(payload.unwrapErr());
                 }
                 // Parse response
                 auto list = ServerModUpdate::parseList(payload.unwrap());
                 if (!list) {
-                    return Err(ServerError(response->code(), "Unable to parse response: {}", list.unwrapErr()));
+                    return Err(ServerError(response.code(), "Unable to parse response: {}", list.unwrapErr()));
                 }
                 return Ok(list.unwrap());
             }
-            return Err(parseServerError(*response));
-        },
-        [](web::WebProgress* progress) {
-            return parseServerProgress(*progress, "Checking updates for mods");
+            return Err(parseServerError(response));
         }
     );
 }
@@ -902,12 +1257,178 @@ void server::clearServerCaches(bool clearGlobalCaches) {
     }
 }
 
-$on_mod(Loaded) {
-    listenForSettingChanges<int64_t>("server-cache-size-limit", +[](int64_t size) {
-        getCache<&server::getMods>().limit(size);
-        getCache<&server::getMod>().limit(size);
-        getCache<&server::getModLogo>().limit(size);
-        getCache<&server::getTags>().limit(size);
-        getCache<&server::checkAllUpdates>().limit(size);
+void server::invalidateServerCaches(std::unordered_set<std::string> const& modIDs) {
+    if (modIDs.empty()) {
+        return;
+    }
+    // The mod ID is the first argument of all of these
+    auto hasID = [&](auto const& key, auto const&) {
+        return modIDs.contains(std::get<0>(key));
+    };
+    getCache<&getMod>().removeIf(hasID);
+    getCache<&getModVersion>().removeIf(hasID);
+    getCache<&getModLogo>().removeIf(hasID);
+
+    // Pages still loading will get the new data from the server anyway
+    getCache<&getMods>().removeIf([&](auto const&, auto& request) {
+        auto value = request.getFinishedValue();
+        if (!value || !value->isOk()) {
+            return false;
+        }
+        auto const& list = value->unwrap();
+        return std::any_of(list.mods.begin(), list.mods.end(), [&](auto const& mod) {
+            return modIDs.contains(mod.id);
+        });
     });
 }
+
+using PrefetchTask = Task<std::monostate>;
+
+/**
+ * Runs prefetches one at a time, and only while no other web requests are 
+ * running, so they never compete with what the user is waiting for. Since 
+ * only one prefetch runs at a time, any other request in flight is one 
+ * that something else sent
+ */
+class Prefetcher final {
+private:
+    struct Job final {
+        std::function<PrefetchTask()> start;
+        std::function<void()> cancel;
+    };
+
+    std::deque<Job> m_queue;
+    std::optional<Job> m_running;
+    EventListener<PrefetchTask> m_listener;
+    EventListener<EventFilter<web::WebIdleEvent>> m_idleListener {
+        [this](web::WebIdleEvent*) {
+            this->next();
+            return ListenerResult::Propagate;
+        }
+    };
+
+    void next() {
+        while (!m_running && !m_queue.empty()) {
+            // Try again once everything else has finished
+            if (web::getActiveRequestCount() > 0) {
+                return;
+            }
+            auto job = std::move(m_queue.front());
+            m_queue.pop_front();
+
+            // Things that are already cached finish immediately
+            auto task = job.start();
+            if (!task.isPending()) {
+                continue;
+            }
+            m_running = std::move(job);
+            m_listener.bind([this](PrefetchTask::Event* event) {
+                if (event->getValue() || event->isCancelled()) {
+                    m_running.reset();
+                    this->next();
+                }
+            });
+            m_listener.setFilter(task);
+        }
+    }
+
+public:
+    static Prefetcher* get() {
+        static auto inst = new Prefetcher();
+        return inst;
+    }
+
+    void add(std::function<PrefetchTask()> start, std::function<void()> cancel) {
+        m_queue.push_back(Job { .start = std::move(start), .cancel = std::move(cancel) });
+        this->next();
+    }
+    void cancelAll() {
+        m_queue.clear();
+        if (m_running) {
+            auto running = std::move(*m_running);
+            m_running.reset();
+            m_listener.setFilter(PrefetchTask());
+            running.cancel();
+        }
+    }
+};
+
+template <class T>
+static PrefetchTask toPrefetchTask(ServerRequest<T> request) {
+    return request.map(
+        [](auto*) { return std::monostate(); },
+        [](auto*) { return std::monostate(); }
+    );
+}
+
+void server::prefetchModLogo(std::string const& id) {
+    Prefetcher::get()->add(
+        [id] { return toPrefetchTask(getCache<&getModLogo>().prefetch(id)); },
+        [id] { getCache<&getModLogo>().cancelPrefetch(id); }
+    );
+}
+
+void server::prefetchMods(ModsQuery const& query) {
+    auto prefetchLogos = [](ServerModsList const& list) {
+        for (auto const& mod : list.mods) {
+            prefetchModLogo(mod.id);
+        }
+    };
+    Prefetcher::get()->add(
+        [query, prefetchLogos]() -> PrefetchTask {
+            if (auto mirrored = ModIndexMirror::get()->getMods(query)) {
+                prefetchLogos(*mirrored);
+                return PrefetchTask::immediate(std::monostate());
+            }
+            return getCache<&getMods>().prefetch(query).map(
+                [prefetchLogos](Result<ServerModsList, ServerError>* result) {
+                    if (result->isOk()) {
+                        prefetchLogos(result->unwrap());
+                    }
+                    return std::monostate();
+                },
+                [](auto*) { return std::monostate(); }
+            );
+        },
+        [query] { getCache<&getMods>().cancelPrefetch(query); }
+    );
+}
+
+void server::cancelPrefetches() {
+    Prefetcher::get()->cancelAll();
+}
+
+static void setCacheSizeLimit(int64_t size) {
+    getCache<&server::getMods>().limit(size);
+    getCache<&server::getMod>().limit(size);
+    getCache<&server::getModVersion>().limit(size);
+    getCache<&server::getModLogo>().limit(size);
+    getCache<&server::getTags>().limit(size);
+    getCache<&server::checkAllUpdates>().limit(size);
+}
+static void setCacheMemoryLimit(int64_t megabytes) {
+    auto bytes = static_cast<size_t>(megabytes) * 1024 * 1024;
+    getCache<&server::getMods>().byteLimit(bytes);
+    getCache<&server::getMod>().byteLimit(bytes);
+    getCache<&server::getModVersion>().byteLimit(bytes);
+    getCache<&server::getModLogo>().byteLimit(bytes);
+    getCache<&server::getTags>().byteLimit(bytes);
+    getCache<&server::checkAllUpdates>().byteLimit(bytes);
+}
+
+$on_mod(Loaded) {
+    using namespace std::chrono_literals;
+
+    // Listings change often, while logos and tags basically never do
+    getCache<&server::getMods>().expiry(5min, 1h);
+    getCache<&server::getMod>().expiry(10min, 6h);
+    getCache<&server::getModVersion>().expiry(10min, 6h);
+    getCache<&server::getModLogo>().expiry(6h, 24h * 7);
+    getCache<&server::getTags>().expiry(1h, 24h * 7);
+    getCache<&server::checkAllUpdates>().expiry(30min, 6h);
+
+    setCacheSizeLimit(Mod::get()->getSettingValue<int64_t>("server-cache-size-limit"));
+    setCacheMemoryLimit(Mod::get()->getSettingValue<int64_t>("server-cache-memory-limit"));
+    listenForSettingChanges<int64_t>("server-cache-size-limit", &setCacheSizeLimit);
+    listenForSettingChanges<int64_t>("server-cache-memory-limit", &setCacheMemoryLimit);
+}
@@ -5,6 +5,7 @@
 #include <Geode/utils/web.hpp>
 #include <chrono>
 #include <matjson.hpp>
+#include <unordered_set>
 #include <vector>
 
 using namespace geode::prelude;
@@ -162,6 +163,9 @@ namespace server {
     std::string getServerAPIBaseURL();
     std::string getServerUserAgent();
 
+    Result<matjson::Value, ServerError> parseServerPayload(web::WebResponse const& response);
+    ServerError parseServerError(web::WebResponse const& error);
+
     ServerRequest<ServerModsList> getMods(ModsQuery const& query, bool useCache = true);
     ServerRequest<ServerModMetadata> getMod(std::string const& id, bool useCache = true);
     ServerRequest<ServerModVersion> getModVersion(std::string const& id, ModVersion const& version = ModVersionLatest(), bool useCache = true);
@@ -180,4 +184,23 @@ namespace server {
     ServerRequest<std::vector<ServerModUpdate>> checkAllUpdates(bool useCache = true);
 
     void clearServerCaches(bool clearGlobalCaches = false);
+    /**
+     * Drop cached results that contain any of these mods, leaving the rest 
+     * of the caches alone
+     */
+    void invalidateServerCaches(std::unordered_set<std::string> const& modIDs);
+
+    /**
+     * Fetch a page of mods (and the logos of the mods on it) into the caches 
+     * ahead of time, for example the page after the one being viewed. 
+     * Prefetches run one at a time, and only while no other web requests 
+     * (mod downloads included) are in progress
+     */
+    void prefetchMods(ModsQuery const& query);
+    void prefetchModLogo(std::string const& id);
+    /**
+     * Drop all queued prefetches, and cancel the running one unless 
+     * something else has started waiting for it
+     */
+    void cancelPrefetches();
 }
@@ -9,6 +9,8 @@
 #include "mods/settings/ModSettingsPopup.hpp"
 #include "mods/popups/ModPopup.hpp"
 #include "GeodeUIEvent.hpp"
+#include <deque>
+#include <list>
 
 class LoadServerModLayer : public Popup<std::string const&> {
 protected:
@@ -196,12 +198,140 @@ Popup<Mod*>* geode::openSettingsPopup(Mod* mod, bool disableGeodeTheme) {
 }
 
 using ModLogoSrc = std::variant<Mod*, std::string, std::filesystem::path>;
+using LogoDecodeTask = Task<Ref<CCImage>>;
+
+// Decodes logo PNGs off the main thread
+static Ref<CCImage> decodeLogo(ByteVector const& data) {
+    auto image = new CCImage();
+    auto ref = Ref(image);
+    image->release();
+    if (!image->initWithImageData(const_cast<uint8_t*>(data.data()), data.size())) {
+        return nullptr;
+    }
+    return ref;
+}
+static LogoDecodeTask decodeLogoAsync(ByteVector&& data) {
+    return LogoDecodeTask::run([data = std::move(data)](auto, auto) -> LogoDecodeTask::Result {
+        return decodeLogo(data);
+    }, "Decode mod logo");
+}
+static LogoDecodeTask decodeLogoAsync(std::filesystem::path const& geodePackage) {
+    return LogoDecodeTask::run([geodePackage](auto, auto) -> LogoDecodeTask::Result {
+        auto unzip = file::Unzip::create(geodePackage);
+        if (!unzip) {
+            return Ref<CCImage>(nullptr);
+        }
+        auto logo = unzip.unwrap().extract("logo.png");
+        if (!logo) {
+            return Ref<CCImage>(nullptr);
+        }
+        return decodeLogo(logo.unwrap());
+    }, "Decode mod logo");
+}
+
+// Logo textures go through the texture cache since that registers the image 
+// to recreate the texture from if the GL context is lost (which happens on 
+// Android whenever the game is in the background). A texture made with 
+// `new CCTexture2D` and `initWithImage` would come back blank
+static std::string getLogoTextureKey(std::string const& key) {
+    return "logo:"_spr + key;
+}
+static CCTexture2D* createLogoTexture(CCImage* image, std::string const& key) {
+    return CCTextureCache::get()->addUIImage(image, getLogoTextureKey(key).c_str());
+}
+static void releaseLogoTexture(std::string const& key) {
+    // Sprites still showing the logo keep the texture alive
+    CCTextureCache::get()->removeTextureForKey(getLogoTextureKey(key).c_str());
+}
+
+// Keeps the textures of recently shown logos around so revisiting a page of 
+// mods doesn't need to download or decode anything, and turns decoded logos 
+// into textures a few per frame so a whole page finishing at once doesn't 
+// cause a hitch
+class LogoTextureCache final {
+protected:
+    static constexpr size_t CAPACITY = 64;
+    static constexpr size_t UPLOADS_PER_FRAME = 2;
+
+    struct PendingUpload {
+        std::string key;
+        Ref<CCImage> image;
+        std::function<void(CCTexture2D*)> callback;
+    };
+
+    // Most recently used first
+    std::list<std::pair<std::string, Ref<CCTexture2D>>> m_entries;
+    std::unordered_map<std::string, decltype(m_entries)::iterator> m_index;
+    std::deque<PendingUpload> m_pending;
+    bool m_uploadQueued = false;
+
+    void processUploads() {
+        m_uploadQueued = false;
+        for (size_t i = 0; i < UPLOADS_PER_FRAME && !m_pending.empty(); i += 1) {
+            auto upload = std::move(m_pending.front());
+            m_pending.pop_front();
+
+            auto texture = this->find(upload.key);
+            if (!texture) {
+                texture = createLogoTexture(upload.image, upload.key);
+                if (!texture) {
+                    upload.callback(nullptr);
+                    continue;
+                }
+                this->add(upload.key, texture);
+            }
+            upload.callback(texture);
+        }
+        if (!m_pending.empty()) {
+            this->queueUploads();
+        }
+    }
+    void queueUploads() {
+        if (!m_uploadQueued) {
+            m_uploadQueued = true;
+            queueInMainThread([this] { this->processUploads(); });
+        }
+    }
+
+public:
+    static LogoTextureCache* get() {
+        static auto inst = new LogoTextureCache();
+        return inst;
+    }
+
+    CCTexture2D* find(std::string const& key) {
+        auto it = m_index.find(key);
+        if (it == m_index.end()) {
+            return nullptr;
+        }
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->second;
+    }
+    void add(std::string const& key, CCTexture2D* texture) {
+        if (auto it = m_index.find(key); it != m_index.end()) {
+            m_entries.erase(it->second);
+        }
+        m_entries.emplace_front(key, texture);
+        m_index[key] = m_entries.begin();
+        while (m_entries.size() > CAPACITY) {
+            releaseLogoTexture(m_entries.back().first);
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+    }
+    void upload(std::string const& key, Ref<CCImage> image, std::function<void(CCTexture2D*)> callback) {
+        m_pending.push_back({ key, std::move(image), std::move(callback) });
+        this->queueUploads();
+    }
+};
 
 class ModLogoSprite : public CCNode {
 protected:
     std::string m_modID;
+    std::string m_cacheKey;
     CCNode* m_sprite = nullptr;
     EventListener<server::ServerRequest<ByteVector>> m_listener;
+    EventListener<LogoDecodeTask> m_decodeListener;
 
     bool init(ModLogoSrc&& src) {
         if (!CCNode::init())
@@ -211,6 +341,7 @@ protected:
         this->setContentSize({ 50, 50 });
 
         m_listener.bind(this, &ModLogoSprite::onFetch);
+        m_decodeListener.bind(this, &ModLogoSprite::onDecode);
     
         std::visit(makeVisitor {
             [this](Mod* mod) {
@@ -225,18 +356,31 @@ protected:
             },
             [this](std::string const& id) {
                 m_modID = id;
-                
+                // The logo endpoint always serves the latest version's logo
+                m_cacheKey = id;
+
+                if (auto texture = LogoTextureCache::get()->find(m_cacheKey)) {
+                    this->setSprite(CCSprite::createWithTexture(texture), false);
+                    return;
+                }
+
                 // Asynchronously fetch from server
                 this->setSprite(createLoadingCircle(25), false);
                 m_listener.setFilter(server::getModLogo(id));
             },
             [this](std::filesystem::path const& path) {
-                this->setSprite(nullptr, false);
-                if (auto unzip = file::Unzip::create(path)) {
-                    if (auto logo = unzip.unwrap().extract("logo.png")) {
-                        this->setSprite(std::move(logo.unwrap()), false);
-                    }
+                std::error_code ec;
+                auto time = std::filesystem::last_write_time(path, ec);
+                m_cacheKey = fmt::format("{}@{}", path.string(), time.time_since_epoch().count());
+
+                if (auto texture = LogoTextureCache::get()->find(m_cacheKey)) {
+                    this->setSprite(CCSprite::createWithTexture(texture), false);
+                    return;
                 }
+
+                // Asynchronously extract and decode from the package
+                this->setSprite(createLoadingCircle(25), false);
+                m_decodeListener.setFilter(decodeLogoAsync(path));
             },
         }, src);
 
@@ -268,13 +412,6 @@ protected:
             ModLogoUIEvent(std::make_unique<ModLogoUIEvent::Impl>(this, m_modID)).post();
         }
     }
-    void setSprite(ByteVector&& data, bool postEvent) {
-        auto image = Ref(new CCImage());
-        image->initWithImageData(data.data(), data.size());
-
-        auto texture = CCTextureCache::get()->addUIImage(image, m_modID.c_str());
-        this->setSprite(CCSprite::createWithTexture(texture), postEvent);
-    }
 
     void onFetch(server::ServerRequest<ByteVector>::Event* event) {
         if (auto result = event->getValue()) {
@@ -282,10 +419,29 @@ protected:
             if (result->isErr()) {
                 this->setSprite(nullptr, true);
             }
-            // Otherwise load downloaded sprite to memory
+            // Otherwise decode downloaded sprite on another thread
             else {
-                this->setSprite(std::move(result->unwrap()), true);
+                m_decodeListener.setFilter(decodeLogoAsync(std::move(result->unwrap())));
+            }
+        }
+        else if (event->isCancelled()) {
+            this->setSprite(nullptr, true);
+        }
+    }
+
+    void onDecode(LogoDecodeTask::Event* event) {
+        if (auto image = event->getValue()) {
+            if (!*image) {
+                this->setSprite(nullptr, true);
+                return;
             }
+            // The sprite may be gone by the time the texture is created, 
+            // but the texture is still cached for the next time
+            LogoTextureCache::get()->upload(m_cacheKey, *image, [self = WeakRef(this)](CCTexture2D* texture) {
+                if (auto sprite = self.lock()) {
+                    sprite->setSprite(texture ? CCSprite::createWithTexture(texture) : nullptr, true);
+                }
+            });
         }
         else if (event->isCancelled()) {
             this->setSprite(nullptr, true);
@@ -228,7 +228,15 @@ void ModsStatusNode::updateState() {
             }
             auto percentage = totalProgress / static_cast<float>(totalDownloading);
 
-            m_statusPercentage->setString(fmt::format("{}%", static_cast<size_t>(percentage)).c_str());
+            auto speed = server::ModDownloadManager::get()->getStats().bytesPerSecond;
+            if (speed > 0) {
+                m_statusPercentage->setString(fmt::format(
+                    "{}% ({:.1f} MB/s)", static_cast<size_t>(percentage), speed / 1'000'000
+                ).c_str());
+            }
+            else {
+                m_statusPercentage->setString(fmt::format("{}%", static_cast<size_t>(percentage)).c_str());
+            }
             m_statusPercentage->setVisible(true);
             m_loadingCircle->setVisible(true);
             m_statusBG->setVisible(true);
@@ -20,7 +20,6 @@ bool ModItem::init(ModSource&& source) {
     if (!CCNode::init())
         return false;
     
-    m_source = std::move(source);
     this->setID("ModItem");
 
     m_bg = CCScale9Sprite::create("square02b_small.png");
@@ -31,10 +30,6 @@ bool ModItem::init(ModSource&& source) {
     m_bg->setScale(.7f);
     this->addChildAtPosition(m_bg, Anchor::Center);
 
-    m_logo = m_source.createModLogo();
-    m_logo->setID("logo-sprite");
-    this->addChild(m_logo);
-
     m_infoContainer = CCNode::create();
     m_infoContainer->setID("info-container");
     m_infoContainer->setScale(.4f);
@@ -44,7 +39,7 @@ bool ModItem::init(ModSource&& source) {
     m_titleContainer->setID("title-container");
     m_titleContainer->setAnchorPoint({ .0f, .5f });
 
-    m_titleLabel = CCLabelBMFont::create(m_source.getMetadata().getName().c_str(), "bigFont.fnt");
+    m_titleLabel = CCLabelBMFont::create("", "bigFont.fnt");
     m_titleLabel->setID("title-label");
     m_titleLabel->setLayoutOptions(AxisLayoutOptions::create()->setScaleLimits(.3f, std::nullopt));
     m_titleContainer->addChild(m_titleLabel);
@@ -70,16 +65,6 @@ bool ModItem::init(ModSource&& source) {
     m_developers->setID("developers-menu");
     m_developers->ignoreAnchorPointForPosition(false);
     m_developers->setAnchorPoint({ .0f, .5f });
-
-    auto by = m_source.formatDevelopers();
-    m_developerLabel = CCLabelBMFont::create(by.c_str(), "goldFont.fnt");
-    m_developerLabel->setID("developers-label");
-    auto developersBtn = CCMenuItemSpriteExtra::create(
-        m_developerLabel, this, menu_selector(ModItem::onDevelopers)
-    );
-    developersBtn->setID("developers-button");
-    m_developers->addChild(developersBtn);
-
     m_developers->setLayout(
         RowLayout::create()
             ->setAxisAlignment(AxisAlignment::Start)
@@ -92,14 +77,8 @@ bool ModItem::init(ModSource&& source) {
     m_description->setColor(ccBLACK);
     m_description->setOpacity(90);
 
-    auto desc = m_source.getMetadata().getDescription();
-    auto descLabel = CCLabelBMFont::create(
-        desc.value_or("[No Description Provided]").c_str(),
-        "chatFont.fnt"
-    );
-    descLabel->setColor(desc ? ccWHITE : ccGRAY);
-    limitNodeWidth(descLabel, m_description->getContentWidth() - 20, 2.f, .1f);
-    m_description->addChildAtPosition(descLabel, Anchor::Left, ccp(10, 0), ccp(0, .5f));
+    m_descriptionLabel = CCLabelBMFont::create("", "chatFont.fnt");
+    m_description->addChildAtPosition(m_descriptionLabel, Anchor::Left, ccp(10, 0), ccp(0, .5f));
 
     m_infoContainer->addChildAtPosition(m_description, Anchor::Left);
 
@@ -162,6 +141,76 @@ bool ModItem::init(ModSource&& source) {
     m_viewMenu = CCMenu::create();
     m_viewMenu->setID("view-menu");
     m_viewMenu->setScale(.55f);
+    m_viewMenu->setLayout(
+        RowLayout::create()
+            ->setAxisReverse(true)
+            ->setAxisAlignment(AxisAlignment::End)
+            ->setGap(10)
+    );
+    m_viewMenu->getLayout()->ignoreInvisibleChildren(true);
+    this->addChildAtPosition(m_viewMenu, Anchor::Right, ccp(-10, 0));
+
+    m_badgeContainer = CCNode::create();
+    m_badgeContainer->setID("badge-container");
+    m_badgeContainer->setLayoutOptions(AxisLayoutOptions::create()->setScaleLimits(.1f, .8f));
+
+    // The filters of these are set in setSource so they follow the mod 
+    // the item is currently showing
+    m_checkUpdateListener.bind(this, &ModItem::onCheckUpdates);
+    m_updateStateListener.bind([this](auto) { this->updateState(); });
+    m_downloadListener.bind([this](auto) { this->updateState(); });
+
+    m_settingNodeListener.bind([this](SettingNodeValueChangeEvent*) {
+        this->updateState();
+        return ListenerResult::Propagate;
+    });
+
+    this->setSource(std::move(source));
+    this->updateState();
+
+    return true;
+}
+
+void ModItem::setSource(ModSource&& source) {
+    m_source = std::move(source);
+
+    // Drop everything that was built for the previous source
+    if (m_logo) {
+        m_logo->removeFromParent();
+    }
+    if (m_recommendedBy) {
+        m_recommendedBy->removeFromParent();
+        m_recommendedBy = nullptr;
+    }
+    if (m_downloadCountContainer) {
+        m_downloadCountContainer->removeFromParent();
+        m_downloadCountContainer = nullptr;
+    }
+    m_badgeContainer->removeAllChildren();
+    m_developers->removeAllChildren();
+    m_viewMenu->removeAllChildren();
+    m_enableToggle = nullptr;
+    m_availableUpdate = std::nullopt;
+
+    m_logo = m_source.createModLogo();
+    m_logo->setID("logo-sprite");
+    this->insertAfter(m_logo, m_bg);
+
+    m_titleLabel->setString(m_source.getMetadata().getName().c_str());
+
+    auto by = m_source.formatDevelopers();
+    m_developerLabel = CCLabelBMFont::create(by.c_str(), "goldFont.fnt");
+    m_developerLabel->setID("developers-label");
+    auto developersBtn = CCMenuItemSpriteExtra::create(
+        m_developerLabel, this, menu_selector(ModItem::onDevelopers)
+    );
+    developersBtn->setID("developers-button");
+    m_developers->addChild(developersBtn);
+
+    auto desc = m_source.getMetadata().getDescription();
+    m_descriptionLabel->setString(desc.value_or("[No Description Provided]").c_str());
+    m_descriptionLabel->setColor(desc ? ccWHITE : ccGRAY);
+    limitNodeWidth(m_descriptionLabel, m_description->getContentWidth() - 20, 2.f, .1f);
 
     ButtonSprite* spr = nullptr;
     if (auto serverMod = m_source.asServer(); serverMod != nullptr) {
@@ -188,19 +237,6 @@ bool ModItem::init(ModSource&& source) {
     viewBtn->setID("view-button");
     m_viewMenu->addChild(viewBtn);
 
-    m_viewMenu->setLayout(
-        RowLayout::create()
-            ->setAxisReverse(true)
-            ->setAxisAlignment(AxisAlignment::End)
-            ->setGap(10)
-    );
-    m_viewMenu->getLayout()->ignoreInvisibleChildren(true);
-    this->addChildAtPosition(m_viewMenu, Anchor::Right, ccp(-10, 0));
-
-    m_badgeContainer = CCNode::create();
-    m_badgeContainer->setID("badge-container");
-    m_badgeContainer->setLayoutOptions(AxisLayoutOptions::create()->setScaleLimits(.1f, .8f));
-
     // Handle source-specific stuff
     m_source.visit(makeVisitor {
         [this](Mod* mod) {
@@ -338,25 +374,15 @@ bool ModItem::init(ModSource&& source) {
     m_viewMenu->addChild(m_updateBtn);
 
     if (m_source.asMod()) {
-        m_checkUpdateListener.bind(this, &ModItem::onCheckUpdates);
         m_checkUpdateListener.setFilter(m_source.checkUpdates());
     }
-
-    this->updateState();
+    else {
+        m_checkUpdateListener.setFilter(server::ServerRequest<std::optional<server::ServerModUpdate>>());
+    }
 
     // Only listen for updates on this mod specifically
-    m_updateStateListener.bind([this](auto) { this->updateState(); });
     m_updateStateListener.setFilter(UpdateModListStateFilter(UpdateModState(m_source.getID())));
-
-    m_downloadListener.bind([this](auto) { this->updateState(); });
     m_downloadListener.setFilter(server::ModDownloadFilter(m_source.getID()));
-
-    m_settingNodeListener.bind([this](SettingNodeValueChangeEvent*) {
-        this->updateState();
-        return ListenerResult::Propagate;
-    });
-
-    return true;
 }
 
 void ModItem::updateState() {
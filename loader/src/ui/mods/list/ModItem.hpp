@@ -55,14 +55,15 @@ class ModItem : public CCNode {
 protected:
     ModSource m_source;
     CCScale9Sprite* m_bg;
-    CCNode* m_logo;
+    CCNode* m_logo = nullptr;
     CCNode* m_infoContainer;
     CCNode* m_titleContainer;
     Ref<CCLabelBMFont> m_titleLabel;
     CCLabelBMFont* m_versionLabel;
     CCNode* m_developers;
-    CCNode* m_recommendedBy;
+    CCNode* m_recommendedBy = nullptr;
     CCScale9Sprite* m_description;
+    CCLabelBMFont* m_descriptionLabel;
     CCLabelBMFont* m_developerLabel;
     ButtonSprite* m_restartRequiredLabel;
     ButtonSprite* m_outdatedLabel;
@@ -102,6 +103,12 @@ protected:
 public:
     static ModItem* create(ModSource&& source);
 
+    /**
+     * Point this item to a different mod, rebuilding only the parts of it 
+     * that depend on the source. Call `updateDisplay` afterwards to lay it 
+     * out again
+    */
+    void setSource(ModSource&& source);
     void updateDisplay(float width, ModListDisplay display);
 
     ModSource& getSource() &;
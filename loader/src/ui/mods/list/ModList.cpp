@@ -7,6 +7,12 @@
 #include "../ModsLayer.hpp"
 #include "ModItem.hpp"
 
+// How many rows past the edges of the viewport have items created for them
+static constexpr size_t ROW_OVERSCAN = 2;
+// How many items that have been scrolled out of view are kept around to be 
+// rebound to the rows that scroll into view
+static constexpr size_t MAX_FREE_ITEMS = 24;
+
 static size_t getDisplayPageSize(ModListSource* src, ModListDisplay display) {
     if (src->isLocalModsOnly() && Mod::get()->template getSettingValue<bool>("infinite-local-mods-list")) {
         return std::numeric_limits<size_t>::max();
@@ -394,6 +400,9 @@ bool ModList::init(ModListSource* src, CCSize const& size) {
     this->gotoPage(0);
     this->updateTopContainer();
 
+    // Create and recycle items as the list is scrolled
+    this->scheduleUpdate();
+
     return true;
 }
 
@@ -404,27 +413,14 @@ void ModList::onPromise(ModListSource::PageLoadTask::Event* event) {
             // Hide status
             m_statusContainer->setVisible(false);
 
-            auto list = result->unwrap();
-
-            // Create items
-            bool first = true;
-            for (auto item : list) {
-                // Add separators between items after the first one
-                if (!first) {
-                    // auto separator = CCLayerColor::create(
-                    //     ColorProvider::get()->define("mod-list-separator"_spr, { 255, 255, 255, 45 })
-                    // );
-                    // separator->setContentSize({ m_obContentSize.width - 10, .5f });
-                    // m_list->m_contentLayer->addChild(separator);
-                }
-                first = false;
-                m_list->m_contentLayer->addChild(item);
-            }
+            // Items are only created for the rows that are visible
+            m_pageMods = result->unwrap();
             this->updateDisplay(m_display);
 
             // Scroll list to top
             auto listTopScrollPos = -m_list->m_contentLayer->getContentHeight() + m_list->getContentHeight();
             m_list->m_contentLayer->setPositionY(listTopScrollPos);
+            this->updateVisibleRows(true);
 
             // Update page UI
             this->updateState();
@@ -573,12 +569,9 @@ void ModList::updateDisplay(ModListDisplay display) {
     m_display = display;
     m_source->setPageSize(getDisplayPageSize(m_source, m_display));
 
-    // Update all BaseModItems that are children of the list
-    // There may be non-BaseModItems there (like separators) so gotta be type-safe
-    for (auto& node : CCArrayExt<CCNode*>(m_list->m_contentLayer->getChildren())) {
-        if (auto item = typeinfo_cast<ModItem*>(node)) {
-            item->updateDisplay(m_list->getContentWidth(), display);
-        }
+    // Update the items in the list; free ones are updated when they're reused
+    for (auto& [index, item] : m_rowItems) {
+        item->updateDisplay(m_list->getContentWidth(), display);
     }
 
     // Store old relative scroll position (ensuring no divide by zero happens)
@@ -587,39 +580,148 @@ void ModList::updateDisplay(ModListDisplay display) {
         m_list->m_contentLayer->getPositionY() / oldPositionArea : 
         -1.f;
 
-    // Update the list layout based on the display model
-    if (display == ModListDisplay::Grid) {
-        m_list->m_contentLayer->setLayout(
-            RowLayout::create()
-                ->setGrowCrossAxis(true)
-                ->setAxisAlignment(AxisAlignment::Start)
-                ->setGap(2.5f)
+    // Rows are positioned manually instead of through a layout since only 
+    // the items near the viewport exist, but the scroll height still has to 
+    // account for every row on the page
+    // NOTE: Do NOT call `updateLayout` on m_list, it'll undo this!
+    m_rowGeometry = this->calculateRowGeometry();
+    m_list->m_contentLayer->setContentHeight(m_rowGeometry.contentHeight);
+
+    // Preserve relative scroll position
+    m_list->m_contentLayer->setPositionY((
+        m_list->m_contentLayer->getContentHeight() - m_list->getContentHeight()
+    ) * oldPosition);
+
+    this->updateVisibleRows(true);
+}
+
+ModListRowGeometry ModList::calculateRowGeometry() const {
+    auto width = m_list->getContentWidth();
+    auto geometry = ModListRowGeometry();
+    geometry.gap = 2.5f;
+
+    // These match the sizes ModItem::updateState gives to the items
+    if (m_display == ModListDisplay::Grid) {
+        auto widthWithoutGaps = width - 7.5f;
+        geometry.itemSize = CCSize(widthWithoutGaps / roundf(widthWithoutGaps / 80), 100);
+        // The small epsilon is for when the items fit exactly
+        geometry.columns = std::max<size_t>(
+            1, (width + geometry.gap + .01f) / (geometry.itemSize.width + geometry.gap)
         );
     }
     else {
-        m_list->m_contentLayer->setLayout(
-            ColumnLayout::create()
-                ->setAxisReverse(true)
-                ->setAxisAlignment(AxisAlignment::End)
-                ->setAutoGrowAxis(m_obContentSize.height)
-                ->setGap(2.5f)
-        );
+        geometry.itemSize = CCSize(width, m_display == ModListDisplay::BigList ? 40 : 30);
+        geometry.columns = 1;
     }
 
+    geometry.rowCount = (m_pageMods.size() + geometry.columns - 1) / geometry.columns;
+    auto rowsHeight = geometry.rowCount ?
+        geometry.rowCount * geometry.itemSize.height + (geometry.rowCount - 1) * geometry.gap :
+        0.f;
+
     // Make sure list isn't too small
-    // NOTE: Do NOT call `updateLayout` on m_list, it'll undo this!
-    if (m_list->m_contentLayer->getContentHeight() < m_list->getContentHeight()) {
-        auto diff = m_list->getContentHeight() - m_list->m_contentLayer->getContentHeight();
-        m_list->m_contentLayer->setContentHeight(m_list->getContentHeight());
-        for (auto child : CCArrayExt<CCNode*>(m_list->m_contentLayer->getChildren())) {
-            child->setPositionY(child->getPositionY() + diff);
+    geometry.contentHeight = std::max(rowsHeight, m_list->getContentHeight());
+    return geometry;
+}
+
+void ModList::updateVisibleRows(bool force) {
+    auto scroll = m_list->m_contentLayer->getPositionY();
+    if (!force && scroll == m_lastRowsScroll) {
+        return;
+    }
+    m_lastRowsScroll = scroll;
+
+    auto const& geometry = m_rowGeometry;
+    if (m_pageMods.empty() || geometry.rowCount == 0) {
+        return;
+    }
+
+    // Figure out which rows intersect the viewport (rows go from the top 
+    // of the content layer downwards)
+    auto viewBottom = -scroll;
+    auto viewTop = viewBottom + m_list->getContentHeight();
+    auto rowStride = geometry.itemSize.height + geometry.gap;
+
+    auto firstRow = static_cast<size_t>(std::max(0.f, (geometry.contentHeight - viewTop) / rowStride));
+    auto lastRow = static_cast<size_t>(std::max(0.f, (geometry.contentHeight - viewBottom) / rowStride));
+    firstRow = firstRow > ROW_OVERSCAN ? firstRow - ROW_OVERSCAN : 0;
+    lastRow = std::min(lastRow + ROW_OVERSCAN, geometry.rowCount - 1);
+
+    auto firstIndex = std::min(firstRow * geometry.columns, m_pageMods.size());
+    auto endIndex = std::min((lastRow + 1) * geometry.columns, m_pageMods.size());
+
+    // Take items that were scrolled out of view out of the list and put 
+    // them up for reuse
+    for (auto it = m_rowItems.begin(); it != m_rowItems.end();) {
+        if (it->first < firstIndex || it->first >= endIndex) {
+            this->freeItem(it->second);
+            it = m_rowItems.erase(it);
+        }
+        else {
+            ++it;
         }
     }
 
-    // Preserve relative scroll position
-    m_list->m_contentLayer->setPositionY((
-        m_list->m_contentLayer->getContentHeight() - m_list->getContentHeight()
-    ) * oldPosition);
+    for (size_t index = firstIndex; index < endIndex; index += 1) {
+        auto it = m_rowItems.find(index);
+        if (it == m_rowItems.end()) {
+            // Rebind a free item if there is one, since that only has to 
+            // rebuild the parts that depend on the mod
+            Ref<ModItem> item;
+            if (m_freeItems.empty()) {
+                item = ModItem::create(ModSource(m_pageMods.at(index)));
+            }
+            else {
+                item = m_freeItems.back();
+                m_freeItems.pop_back();
+                item->setSource(ModSource(m_pageMods.at(index)));
+            }
+            item->updateDisplay(m_list->getContentWidth(), m_display);
+            it = m_rowItems.insert({ index, item }).first;
+        }
+        auto item = it->second;
+
+        auto row = index / geometry.columns;
+        auto column = index % geometry.columns;
+        auto size = item->getScaledContentSize();
+
+        // Grid rows start from the left, while list items are centered
+        auto x = geometry.columns > 1 ?
+            column * (geometry.itemSize.width + geometry.gap) :
+            (m_list->getContentWidth() - size.width) / 2;
+        auto y = geometry.contentHeight - row * rowStride - geometry.itemSize.height;
+        if (!item->isIgnoreAnchorPointForPosition()) {
+            x += size.width * item->getAnchorPoint().x;
+            y += size.height * item->getAnchorPoint().y;
+        }
+        item->setPosition(x, y);
+
+        if (!item->getParent()) {
+            m_list->m_contentLayer->addChild(item);
+        }
+    }
+}
+
+void ModList::freeItem(ModItem* item) {
+    item->removeFromParentAndCleanup(false);
+    if (m_freeItems.size() < MAX_FREE_ITEMS) {
+        m_freeItems.push_back(item);
+    }
+}
+
+void ModList::clearRows() {
+    // Keep the items around for the next page
+    for (auto& [index, item] : m_rowItems) {
+        this->freeItem(item);
+    }
+    m_list->m_contentLayer->removeAllChildren();
+    m_rowItems.clear();
+    m_pageMods.clear();
+    m_rowGeometry = this->calculateRowGeometry();
+}
+
+void ModList::update(float dt) {
+    this->updateVisibleRows();
 }
 
 void ModList::updateState() {
@@ -664,7 +766,7 @@ void ModList::reloadPage() {
 
 void ModList::gotoPage(size_t page, bool update) {
     // Clear list contents
-    m_list->m_contentLayer->removeAllChildren();
+    this->clearRows();
     m_page = page;
 
     // Update page size (if needed)
@@ -681,7 +783,7 @@ void ModList::gotoPage(size_t page, bool update) {
 
 void ModList::showStatus(ModListStatus status, std::string const& message, std::optional<std::string> const& details) {
     // Clear list contents
-    m_list->m_contentLayer->removeAllChildren();
+    this->clearRows();
 
     // Update status
     m_statusTitle->setString(message.c_str());
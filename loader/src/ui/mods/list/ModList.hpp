@@ -19,6 +19,16 @@ struct ModListProgressStatus {
 };
 using ModListStatus = std::variant<ModListErrorStatus, ModListUnkProgressStatus, ModListProgressStatus>;
 
+// Where the rows of the list go, computed from the display mode since every 
+// ModItem in a display mode has the same size
+struct ModListRowGeometry {
+    CCSize itemSize = CCSizeZero;
+    size_t columns = 1;
+    size_t rowCount = 0;
+    float gap = 0;
+    float contentHeight = 0;
+};
+
 class ModList : public CCNode {
 protected:
     ModListSource* m_source;
@@ -53,12 +63,26 @@ protected:
     EventListener<server::ServerRequest<std::vector<std::string>>> m_checkUpdatesListener;
     EventListener<server::ModDownloadFilter> m_downloadListener;
     ModListDisplay m_display = ModListDisplay::SmallList;
+    // The mods on the current page; only the ones near the viewport have a ModItem
+    ModListSource::Page m_pageMods;
+    // The items in the list by index
+    std::unordered_map<size_t, Ref<ModItem>> m_rowItems;
+    // Items that have been scrolled out of view, waiting to be rebound to a 
+    // different mod with `ModItem::setSource`
+    std::vector<Ref<ModItem>> m_freeItems;
+    ModListRowGeometry m_rowGeometry;
+    float m_lastRowsScroll = 0;
     bool m_exiting = false;
     std::atomic<size_t> m_searchInputThreads = 0;
 
     bool init(ModListSource* src, CCSize const& size);
 
     void updateTopContainer();
+    void update(float dt) override;
+    void freeItem(ModItem* item);
+    void clearRows();
+    ModListRowGeometry calculateRowGeometry() const;
+    void updateVisibleRows(bool force = false);
     void onCheckUpdates(typename server::ServerRequest<std::vector<std::string>>::Event* event);
     void onInvalidateCache(InvalidateCacheEvent* event);
 
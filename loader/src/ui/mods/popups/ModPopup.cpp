@@ -37,6 +37,7 @@ protected:
         m_noneText = noneText;
 
         m_textarea = MDTextArea::create("", size);
+        m_textarea->setAsyncRendering(true);
         m_textarea->setID("textarea");
         this->addChildAtPosition(m_textarea, Anchor::Center);
 
@@ -747,7 +748,13 @@ void ModPopup::updateState() {
             m_cancelBtn->setVisible(true);
 
             auto status = download->getStatus();
-            if (auto d = std::get_if<server::DownloadStatusDownloading>(&status)) {
+            if (download->isQueued()) {
+                // The user is waiting on this one, so start it next
+                download->prioritize();
+                m_enabledStatusLabel->setString("Queued");
+                m_enabledStatusLabel->setColor(ccWHITE);
+            }
+            else if (auto d = std::get_if<server::DownloadStatusDownloading>(&status)) {
                 m_enabledStatusLabel->setString(fmt::format("Downloading {}%", d->percentage).c_str());
                 m_enabledStatusLabel->setColor(ccWHITE);
                 // todo: progress bar
@@ -1,35 +1,32 @@
 #include "ModListSource.hpp"
 
-bool InstalledModsQuery::preCheck(ModSource const& src) const {
+bool InstalledModsQuery::preCheck(LocalModSnapshot const& mod) const {
     // If we only want mods with updates, then only give mods with updates
     // NOTE: The caller of filterModsWithQuery() should have ensured that 
-    // `src.checkUpdates()` has been called and has finished
-    if (
-        auto updates = src.hasUpdates();
-        type == InstalledModListType::OnlyUpdates && 
-        !(updates && updates->hasUpdateForInstalledMod())
-    ) {
+    // `src.checkUpdates()` has been called and has finished before the 
+    // snapshot was taken
+    if (type == InstalledModListType::OnlyUpdates && !mod.hasUpdate) {
         return false;
     }
     // If only errors requested, only show mods with errors (duh)
     if (type == InstalledModListType::OnlyOutdated) {
-        return src.asMod() && src.asMod()->targetsOutdatedVersion().has_value();
+        return mod.targetsOutdatedVersion;
     }
     if (type == InstalledModListType::OnlyErrors) {
-        return src.asMod() && src.asMod()->hasLoadProblems();
+        return mod.hasLoadProblems;
     }
     return true;
 }
-bool InstalledModsQuery::queryCheck(ModSource const& src, double& weighted) const {
+bool InstalledModsQuery::queryCheck(LocalModSnapshot const& mod, double& weighted) const {
     bool addToList = true;
     if (enabledOnly) {
-        addToList = src.asMod()->isEnabled() == *enabledOnly;
+        addToList = mod.enabled == *enabledOnly;
     }
     if (query) {
-        addToList = modFuzzyMatch(src.asMod()->getMetadata(), *query, weighted);
+        addToList = LocalModSearchIndex::get()->match(mod.src.asMod(), *query, weighted);
     }
     // Loader gets boost to ensure it's normally always top of the list
-    if (addToList && src.asMod()->isInternal()) {
+    if (addToList && mod.internal) {
         weighted += 5;
     }
     // todo: favorites
@@ -76,6 +73,29 @@ void InstalledModListSource::resetQuery() {
     };
 }
 
+// Must be called on the main thread, which is where the mods are looked at; 
+// only the snapshots of them are filtered on the worker
+static ModListSource::ProviderTask filterModsInBackground(
+    ModListSource::ProvidedMods const& content, InstalledModsQuery const& query
+) {
+    using ProviderTask = ModListSource::ProviderTask;
+    std::vector<LocalModSnapshot> snapshots;
+    snapshots.reserve(content.mods.size());
+    for (auto const& src : content.mods) {
+        snapshots.push_back(LocalModSnapshot::capture(src));
+    }
+    return ProviderTask::run(
+        [snapshots = std::move(snapshots), query](auto, auto hasBeenCancelled) -> ProviderTask::Result {
+            auto result = ModListSource::ProvidedMods();
+            if (!filterModsWithLocalQuery(snapshots, result, query, hasBeenCancelled)) {
+                return ProviderTask::Cancel();
+            }
+            return ProviderTask::Value(Ok(std::move(result)));
+        },
+        "Filtering installed mods"
+    );
+}
+
 InstalledModListSource::ProviderTask InstalledModListSource::fetchPage(size_t page, bool forceUpdate) {
     m_query.page = page;
     m_query.pageSize = m_pageSize;
@@ -86,6 +106,11 @@ InstalledModListSource::ProviderTask InstalledModListSource::fetchPage(size_t pa
         m_query.pageSize = Loader::get()->getAllMods().size();
     }
 
+    // Results of an older query aren't going to be shown anymore
+    m_pendingQuery.cancel();
+
+    LocalModSearchIndex::get()->update();
+
     auto content = ModListSource::ProvidedMods();
     for (auto& mod : Loader::get()->getAllMods()) {
         content.mods.push_back(ModSource(mod));
@@ -98,21 +123,20 @@ InstalledModListSource::ProviderTask InstalledModListSource::fetchPage(size_t pa
         for (auto& src : content.mods) {
             tasks.push_back(src.checkUpdates());
         }
-        return UpdateTask::all(std::move(tasks)).map(
-            [content = std::move(content), query = m_query](auto*) mutable -> ProviderTask::Value {
+        m_pendingQuery = UpdateTask::all(std::move(tasks)).chain(
+            [content = std::move(content), query = m_query](auto*) {
                 // Filter the results based on the current search 
                 // query and return them
-                filterModsWithLocalQuery(content, query);
-                return Ok(content);
-            },
-            [](auto*) -> ProviderTask::Progress { return std::nullopt; }
+                return filterModsInBackground(content, query);
+            }
         );
     }
-    // Otherwise simply construct the result right away
+    // Otherwise filter right away, off the main thread so a long list of 
+    // mods doesn't block typing in the search box
     else {
-        filterModsWithLocalQuery(content, m_query);
-        return ProviderTask::immediate(Ok(content));
+        m_pendingQuery = filterModsInBackground(content, m_query);
     }
+    return m_pendingQuery;
 }
 
 void InstalledModListSource::setSearchQuery(std::string const& query) {
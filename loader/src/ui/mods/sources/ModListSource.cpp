@@ -24,6 +24,23 @@ ListenerResult InvalidateCacheFilter::handle(std::function<Callback> fn, Invalid
 
 InvalidateCacheFilter::InvalidateCacheFilter(ModListSource* src) : m_source(src) {}
 
+LocalModSnapshot LocalModSnapshot::capture(ModSource const& src) {
+    auto metadata = src.getMetadata();
+    auto updates = src.hasUpdates();
+    auto mod = src.asMod();
+    return LocalModSnapshot {
+        .src = src,
+        .name = metadata.getName(),
+        .tags = metadata.getTags(),
+        .enabled = mod && mod->isEnabled(),
+        .internal = mod && mod->isInternal(),
+        .hasLoadProblems = mod && mod->hasLoadProblems(),
+        .targetsOutdatedVersion = mod && mod->targetsOutdatedVersion().has_value(),
+        .hasUpdate = updates && updates->hasUpdateForInstalledMod(),
+        .outdated = metadata.checkTargetVersions().isErr(),
+    };
+}
+
 bool LocalModsQueryBase::isDefault() const {
     return !query.has_value() && tags.empty();
 }
@@ -40,10 +57,8 @@ typename ModListSource::PageLoadTask ModListSource::loadPage(size_t page, bool f
                 if (data.totalModCount == 0 || data.mods.empty()) {
                     return Err(LoadPageError("No mods found :("));
                 }
-                auto pageData = Page();
-                for (auto mod : std::move(data.mods)) {
-                    pageData.push_back(ModItem::create(std::move(mod)));
-                }
+                // ModItems are created lazily by ModList as rows come into view
+                auto pageData = Page(std::move(data.mods));
                 m_cachedItemCount = data.totalModCount;
                 m_cachedPages.insert({ page, pageData });
                 return Ok(pageData);
@@ -87,6 +102,7 @@ ModListSource::ModListSource() {
 }
 
 void ModListSource::clearAllCaches() {
+    LocalModSearchIndex::get()->invalidate();
     for (auto src : ALL_EXTANT_SOURCES) {
         src->clearCache();
     }
@@ -118,3 +134,122 @@ bool modFuzzyMatch(ModMetadata const& metadata, std::string const& kw, double& w
     }
     return addToList;
 }
+
+static std::bitset<256> charsInString(std::string const& str) {
+    std::bitset<256> chars;
+    for (auto c : str) {
+        chars.set(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return chars;
+}
+
+LocalModSearchIndex* LocalModSearchIndex::get() {
+    static auto inst = new LocalModSearchIndex();
+    return inst;
+}
+
+void LocalModSearchIndex::update() {
+    auto mods = Loader::get()->getAllMods();
+
+    std::unique_lock lock(m_mutex);
+    if (m_valid && mods.size() == m_entries.size() && std::equal(
+        mods.begin(), mods.end(), m_entries.begin(),
+        [](Mod* mod, Entry const& entry) { return mod == entry.mod; }
+    )) {
+        return;
+    }
+
+    m_entries.clear();
+    m_entryIndices.clear();
+    m_lastSearch.reset();
+    for (auto mod : mods) {
+        // Same fields and weights as modFuzzyMatch
+        auto metadata = mod->getMetadata();
+        Entry entry { .mod = mod };
+        auto addField = [&](std::string const& text, double weight) {
+            auto chars = charsInString(text);
+            entry.chars |= chars;
+            entry.fields.push_back(Field { .text = text, .weight = weight, .chars = chars });
+        };
+        addField(metadata.getName(), 1);
+        addField(metadata.getID(), 0.5);
+        for (auto& dev : metadata.getDevelopers()) {
+            addField(dev, 0.25);
+        }
+        if (auto details = metadata.getDetails()) {
+            addField(*details, 0.005);
+        }
+        if (auto desc = metadata.getDescription()) {
+            addField(*desc, 0.02);
+        }
+        m_entryIndices.insert({ mod, m_entries.size() });
+        m_entries.push_back(std::move(entry));
+    }
+    m_valid = true;
+}
+
+void LocalModSearchIndex::invalidate() {
+    std::unique_lock lock(m_mutex);
+    m_valid = false;
+}
+
+LocalModSearchIndex::Search const& LocalModSearchIndex::search(std::string const& query) {
+    // Every mod is checked against the same query, so only search once
+    if (m_lastSearch && m_lastSearch->query == query) {
+        return *m_lastSearch;
+    }
+
+    Search search { .query = query };
+    auto queryChars = charsInString(query);
+    auto check = [&](size_t index) {
+        auto const& entry = m_entries.at(index);
+        // A fuzzy match needs every character of the query to appear in 
+        // the field, so most fields can be skipped without matching at all
+        if ((entry.chars & queryChars) != queryChars) {
+            return;
+        }
+        double weighted = 0;
+        bool matched = false;
+        for (auto const& field : entry.fields) {
+            if ((field.chars & queryChars) == queryChars) {
+                matched |= weightedFuzzyMatch(field.text, query, field.weight, weighted);
+            }
+        }
+        if (matched) {
+            search.matched.push_back(index);
+            search.scores.insert({ entry.mod, weighted });
+        }
+    };
+
+    // Anything that matches the query also matches every prefix of it, so 
+    // if the user just typed more characters only the previous matches can 
+    // still match
+    if (m_lastSearch && query.starts_with(m_lastSearch->query)) {
+        for (auto index : m_lastSearch->matched) {
+            check(index);
+        }
+    }
+    else {
+        for (size_t index = 0; index < m_entries.size(); index += 1) {
+            check(index);
+        }
+    }
+
+    m_lastSearch = std::move(search);
+    return *m_lastSearch;
+}
+
+bool LocalModSearchIndex::match(Mod* mod, std::string const& query, double& weighted) {
+    std::unique_lock lock(m_mutex);
+    if (!m_entryIndices.contains(mod)) {
+        lock.unlock();
+        return modFuzzyMatch(mod->getMetadata(), query, weighted);
+    }
+    auto const& search = this->search(query);
+    auto score = search.scores.find(mod);
+    if (score == search.scores.end()) {
+        return false;
+    }
+    weighted = std::max(weighted, score->second);
+    return weighted >= 2;
+}
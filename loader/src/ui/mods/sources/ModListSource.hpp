@@ -3,6 +3,8 @@
 #include <Geode/utils/cocos.hpp>
 #include <Geode/utils/string.hpp>
 #include <server/Server.hpp>
+#include <bitset>
+#include <mutex>
 #include "../list/ModItem.hpp"
 
 using namespace geode::prelude;
@@ -39,7 +41,7 @@ public:
         LoadPageError(auto msg, auto details) : message(msg), details(details) {}
     };
 
-    using Page = std::vector<Ref<ModItem>>;
+    using Page = std::vector<ModSource>;
     using PageLoadTask = Task<Result<Page, LoadPageError>, std::optional<uint8_t>>;
 
     struct ProvidedMods {
@@ -99,6 +101,31 @@ public:
     }
 };
 
+/**
+ * Everything filtering with a local query needs to know about a mod, captured 
+ * on the main thread so the mod can't be enabled, disabled or updated while 
+ * it's being filtered on a worker thread
+ */
+struct LocalModSnapshot {
+    ModSource src;
+    std::string name;
+    std::unordered_set<std::string> tags;
+    bool enabled = false;
+    bool internal = false;
+    bool hasLoadProblems = false;
+    bool targetsOutdatedVersion = false;
+    bool hasUpdate = false;
+    // Whether the mod's target versions don't match the game's, which 
+    // sorts it last
+    bool outdated = false;
+
+    /**
+     * Must be called on the main thread, and after update checks have 
+     * finished if `hasUpdate` matters
+     */
+    static LocalModSnapshot capture(ModSource const& src);
+};
+
 struct LocalModsQueryBase {
     std::optional<std::string> query;
     std::unordered_set<std::string> tags = {};
@@ -116,8 +143,8 @@ enum class InstalledModListType {
 struct InstalledModsQuery final : public LocalModsQueryBase {
     InstalledModListType type = InstalledModListType::All;
     std::optional<bool> enabledOnly;
-    bool preCheck(ModSource const& src) const;
-    bool queryCheck(ModSource const& src, double& weighted) const;
+    bool preCheck(LocalModSnapshot const& mod) const;
+    bool queryCheck(LocalModSnapshot const& mod, double& weighted) const;
     bool isDefault() const;
 };
 
@@ -125,6 +152,8 @@ class InstalledModListSource : public ModListSource {
 protected:
     InstalledModListType m_type;
     InstalledModsQuery m_query;
+    // The last started query, cancelled once a newer one starts
+    ProviderTask m_pendingQuery;
 
     void resetQuery() override;
     ProviderTask fetchPage(size_t page, bool forceUpdate) override;
@@ -200,65 +229,136 @@ public:
 bool weightedFuzzyMatch(std::string const& str, std::string const& kw, double weight, double& out);
 bool modFuzzyMatch(ModMetadata const& metadata, std::string const& kw, double& out);
 
+/**
+ * Search data for installed mods, built once whenever the set of installed
+ * mods changes, so searching doesn't need to copy every mod's metadata and
+ * fuzzy match every one of its fields on every keystroke
+ */
+class LocalModSearchIndex final {
+protected:
+    struct Field {
+        std::string text;
+        double weight;
+        // Every (lowercased) byte in the text
+        std::bitset<256> chars;
+    };
+    struct Entry {
+        Mod* mod;
+        std::vector<Field> fields;
+        // Union of the characters of all fields
+        std::bitset<256> chars;
+    };
+    struct Search {
+        std::string query;
+        // Indices of entries that matched in any field, regardless of score
+        std::vector<size_t> matched;
+        std::unordered_map<Mod*, double> scores;
+    };
+
+    std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    std::unordered_map<Mod*, size_t> m_entryIndices;
+    std::optional<Search> m_lastSearch;
+    bool m_valid = false;
+
+    Search const& search(std::string const& query);
+
+public:
+    static LocalModSearchIndex* get();
+
+    /**
+     * Rebuild the index if the installed mods have changed since it was
+     * last built. Must be called on the main thread
+     */
+    void update();
+    /**
+     * Force the index to be rebuilt on the next update()
+     */
+    void invalidate();
+
+    /**
+     * Fuzzy match an installed mod against a search query. Gives the same
+     * results as modFuzzyMatch, but only scores mods whose fields contain
+     * every character of the query. Safe to call from any thread
+     */
+    bool match(Mod* mod, std::string const& query, double& weighted);
+};
+
+/**
+ * Filter, sort and paginate mods based on a local query. Only looks at the 
+ * snapshots, so it's safe to call from a worker thread as long as the 
+ * query's checks are
+ * @param hasBeenCancelled Checked between mods; if it returns true, 
+ * filtering is stopped and `result` is left unspecified
+ * @returns False if filtering was cancelled
+ */
 template <std::derived_from<LocalModsQueryBase> Query>
-void filterModsWithLocalQuery(ModListSource::ProvidedMods& mods, Query const& query) {
-    std::vector<std::pair<ModSource, double>> filtered;
+bool filterModsWithLocalQuery(
+    std::vector<LocalModSnapshot> const& mods, ModListSource::ProvidedMods& result,
+    Query const& query, std::function<bool()> const& hasBeenCancelled = nullptr
+) {
+    struct Filtered {
+        LocalModSnapshot const* mod;
+        double score;
+    };
+    std::vector<Filtered> filtered;
 
     // Filter installed mods based on query
     // TODO: maybe skip fuzzy matching altogether if query is empty?
-    for (auto& src : mods.mods) {
+    for (auto& mod : mods) {
+        if (hasBeenCancelled && hasBeenCancelled()) {
+            return false;
+        }
         double weighted = 0;
         bool addToList = true;
         // Do any checks additional this query has to start off with
-        if (!query.preCheck(src)) {
+        if (!query.preCheck(mod)) {
             addToList = false;
         }
         // If some tags are provided, only return mods that match
         if (addToList && query.tags.size()) {
-            auto compare = src.getMetadata().getTags();
             for (auto& tag : query.tags) {
-                if (!compare.contains(tag)) {
+                if (!mod.tags.contains(tag)) {
                     addToList = false;
                 }
             }
         }
         // Don't bother with unnecessary fuzzy match calculations if this mod isn't going to be added anyway
         if (addToList) {
-            addToList = query.queryCheck(src, weighted);
+            addToList = query.queryCheck(mod, weighted);
         }
         if (addToList) {
-            filtered.push_back({ src, weighted });
+            filtered.push_back(Filtered {
+                .mod = &mod,
+                .score = weighted,
+            });
         }
     }
 
     // Sort list based on score
-    std::sort(filtered.begin(), filtered.end(), [](auto a, auto b) {
+    std::sort(filtered.begin(), filtered.end(), [](Filtered const& a, Filtered const& b) {
         // Sort primarily by score
-        if (a.second != b.second) {
-            return a.second > b.second;
+        if (a.score != b.score) {
+            return a.score > b.score;
         }
         // Make sure outdated mods are always last by default
-        auto aIsOutdated = a.first.getMetadata().checkTargetVersions().isErr();
-        auto bIsOutdated = b.first.getMetadata().checkTargetVersions().isErr();
-        if (aIsOutdated != bIsOutdated) {
-            return !aIsOutdated;
+        if (a.mod->outdated != b.mod->outdated) {
+            return !a.mod->outdated;
         }
         // Fallback sort alphabetically
-        return utils::string::caseInsensitiveCompare(
-            a.first.getMetadata().getName(),
-            b.first.getMetadata().getName()
-        ) == std::strong_ordering::less;
+        return utils::string::caseInsensitiveCompare(a.mod->name, b.mod->name) == std::strong_ordering::less;
     });
 
-    mods.mods.clear();
+    result.mods.clear();
     // Pick out only the mods in the page and page size specified in the query
     for (
         size_t i = query.page * query.pageSize;
         i < filtered.size() && i < (query.page + 1) * query.pageSize;
         i += 1
     ) {
-        mods.mods.push_back(filtered.at(i).first);
+        result.mods.push_back(filtered.at(i).mod->src);
     }
     
-    mods.totalModCount = filtered.size();
+    result.totalModCount = filtered.size();
+    return true;
 }
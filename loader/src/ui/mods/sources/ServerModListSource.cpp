@@ -7,10 +7,21 @@ void ServerModListSource::resetQuery() {
 ServerModListSource::ProviderTask ServerModListSource::fetchPage(size_t page, bool forceUpdate) {
     m_query.page = page;
     m_query.pageSize = m_pageSize;
-    return server::getMods(m_query, !forceUpdate).map(
-        [](Result<server::ServerModsList, server::ServerError>* result) -> ProviderTask::Value {
+    auto request = server::getMods(m_query, !forceUpdate);
+    // Anything prefetched for the previous page is either this page (which 
+    // the request above now waits for) or no longer needed
+    server::cancelPrefetches();
+    return request.map(
+        [query = m_query](Result<server::ServerModsList, server::ServerError>* result) -> ProviderTask::Value {
             if (result->isOk()) {
                 auto list = result->unwrap();
+                // Get the next page ready in the background, so paging 
+                // through the list doesn't always show spinners
+                if ((query.page + 1) * query.pageSize < list.totalModCount) {
+                    auto next = query;
+                    next.page += 1;
+                    server::prefetchMods(next);
+                }
                 auto content = ModListSource::ProvidedMods();
                 for (auto&& mod : std::move(list.mods)) {
                     content.mods.push_back(ModSource(std::move(mod)));
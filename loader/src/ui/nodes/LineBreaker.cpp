@@ -0,0 +1,183 @@
+#include "LineBreaker.hpp"
+
+BMFontMetrics::BMFontMetrics(CCBMFontConfiguration* config, int extraKerning)
+  : m_config(config), m_extraKerning(extraKerning) {}
+
+std::optional<BMFontMetrics> BMFontMetrics::from(CCLabelBMFont* label) {
+    if (!label || !label->getConfiguration()) {
+        return std::nullopt;
+    }
+    return BMFontMetrics(label->getConfiguration(), label->getExtraKerning());
+}
+
+int BMFontMetrics::kerningAmount(unsigned short first, unsigned short second) const {
+    if (!m_config->m_pKerningDictionary) {
+        return 0;
+    }
+    int key = (first << 16) | (second & 0xffff);
+    tCCKerningHashElement* element = nullptr;
+    HASH_FIND_INT(m_config->m_pKerningDictionary, &key, element);
+    return element ? element->amount : 0;
+}
+
+void BMFontMetrics::advance(Pen& pen, char32_t c) const {
+    // CCLabelBMFont works on UTF-16 code units
+    auto ch = static_cast<unsigned short>(c);
+    unsigned int key = ch;
+    tCCFontDefHashElement* element = nullptr;
+    HASH_FIND_INT(m_config->m_pFontDefDictionary, &key, element);
+    // Characters missing from the font are skipped entirely
+    if (!element) {
+        return;
+    }
+    auto& def = element->fontDef;
+    pen.x += def.xAdvance + this->kerningAmount(pen.prev, ch) + m_extraKerning;
+    pen.longest = std::max(pen.longest, pen.x);
+    pen.lastAdvance = def.xAdvance;
+    pen.lastWidth = def.rect.size.width;
+    pen.prev = ch;
+}
+
+void BMFontMetrics::advance(Pen& pen, std::string_view utf8) const {
+    size_t pos = 0;
+    while (pos < utf8.size()) {
+        this->advance(pen, nextCodePoint(utf8, pos));
+    }
+}
+
+float BMFontMetrics::width(Pen const& pen) const {
+    float width = pen.longest;
+    // If the last character's image is wider than its advance, it would 
+    // overlap the end of the label, so the label accounts for that
+    if (pen.lastAdvance < pen.lastWidth) {
+        width += pen.lastWidth - pen.lastAdvance;
+    }
+    return width / CC_CONTENT_SCALE_FACTOR();
+}
+
+float BMFontMetrics::measure(std::string_view utf8) const {
+    Pen pen;
+    this->advance(pen, utf8);
+    return this->width(pen);
+}
+
+char32_t nextCodePoint(std::string_view str, size_t& pos) {
+    auto lead = static_cast<unsigned char>(str[pos]);
+    size_t len = 1;
+    char32_t cp = lead;
+    if (lead >= 0xf0 && lead < 0xf8) {
+        len = 4;
+        cp = lead & 0x07;
+    }
+    else if (lead >= 0xe0) {
+        len = 3;
+        cp = lead & 0x0f;
+    }
+    else if (lead >= 0xc0) {
+        len = 2;
+        cp = lead & 0x1f;
+    }
+    if (len == 1 || pos + len > str.size()) {
+        pos += 1;
+        return lead;
+    }
+    for (size_t i = 1; i < len; i++) {
+        auto cont = static_cast<unsigned char>(str[pos + i]);
+        if ((cont & 0xc0) != 0x80) {
+            pos += 1;
+            return lead;
+        }
+        cp = (cp << 6) | (cont & 0x3f);
+    }
+    pos += len;
+    return cp;
+}
+
+std::vector<std::string> breakLines(
+    std::string_view text,
+    std::function<float(std::string_view)> const& measure,
+    float firstWidth, float width
+) {
+    std::vector<std::string> lines;
+    std::string line;
+    bool firstLine = true;
+    // Whether the current line has no words on it yet, in which case the 
+    // next word doesn't get a space in front of it
+    bool lineStart = true;
+
+    auto fits = [&](std::string_view str) {
+        if (!width) {
+            return true;
+        }
+        return measure(str) <= (firstLine ? firstWidth : width);
+    };
+    auto nextLine = [&]() {
+        lines.push_back(std::move(line));
+        line.clear();
+        firstLine = false;
+        lineStart = true;
+    };
+
+    size_t segmentStart = 0;
+    while (true) {
+        auto segmentEnd = text.find('\n', segmentStart);
+        auto segment = text.substr(segmentStart, segmentEnd == std::string_view::npos ? std::string_view::npos : segmentEnd - segmentStart);
+
+        size_t wordStart = 0;
+        while (true) {
+            auto wordEnd = segment.find(' ', wordStart);
+            auto word = segment.substr(wordStart, wordEnd == std::string_view::npos ? std::string_view::npos : wordEnd - wordStart);
+
+            // Try to fit the word at the end of the current line
+            auto candidate = line;
+            if (!lineStart) {
+                candidate.push_back(' ');
+            }
+            candidate.append(word);
+            if (fits(candidate)) {
+                line = std::move(candidate);
+            }
+            else {
+                // Move on to the next line, unless this line is already empty 
+                // and would have the same room as the next one
+                if (!line.empty() || (firstLine && firstWidth < width)) {
+                    nextLine();
+                }
+                if (fits(word)) {
+                    line = word;
+                }
+                // The word doesn't fit on a line of its own, so split it 
+                // between characters
+                else {
+                    size_t pos = 0;
+                    while (pos < word.size()) {
+                        auto start = pos;
+                        nextCodePoint(word, pos);
+                        auto c = word.substr(start, pos - start);
+                        auto next = line;
+                        next.append(c);
+                        if (!line.empty() && !fits(next)) {
+                            nextLine();
+                            next = c;
+                        }
+                        line = std::move(next);
+                    }
+                }
+            }
+            lineStart = false;
+
+            if (wordEnd == std::string_view::npos) {
+                break;
+            }
+            wordStart = wordEnd + 1;
+        }
+
+        if (segmentEnd == std::string_view::npos) {
+            break;
+        }
+        nextLine();
+        segmentStart = segmentEnd + 1;
+    }
+    lines.push_back(std::move(line));
+    return lines;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Geode/DefaultInclude.hpp>
+#include <cocos2d.h>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace geode::prelude;
+
+/**
+ * Measures text using the per-glyph advances and kerning of a BMFont, the 
+ * same way CCLabelBMFont lays out its characters. Unlike calling setString on 
+ * a label and reading back its content size, this doesn't rebuild any glyph 
+ * quads, so it's cheap enough to call for every candidate line break
+ */
+class BMFontMetrics final {
+public:
+    /**
+     * Running state for measuring a string one character at a time
+     */
+    struct Pen {
+        int x = 0;
+        int longest = 0;
+        int lastAdvance = 0;
+        float lastWidth = 0.f;
+        unsigned short prev = 0xffff;
+    };
+
+protected:
+    CCBMFontConfiguration* m_config;
+    int m_extraKerning;
+
+    int kerningAmount(unsigned short first, unsigned short second) const;
+
+public:
+    BMFontMetrics(CCBMFontConfiguration* config, int extraKerning = 0);
+
+    static std::optional<BMFontMetrics> from(CCLabelBMFont* label);
+
+    void advance(Pen& pen, char32_t c) const;
+    void advance(Pen& pen, std::string_view utf8) const;
+    /**
+     * Get the width (in points, unscaled) a label with the characters fed 
+     * into the pen would have
+     */
+    float width(Pen const& pen) const;
+    /**
+     * Get the width (in points, unscaled) of a label with the given string
+     */
+    float measure(std::string_view utf8) const;
+};
+
+/**
+ * Decode the next UTF-8 code point in `str` starting at `pos`, and advance 
+ * `pos` past it. Invalid bytes are returned as-is
+ */
+char32_t nextCodePoint(std::string_view str, size_t& pos);
+
+/**
+ * Break text into lines that fit within a width. Lines are broken at spaces 
+ * and newlines; words too long to fit on a line of their own are split 
+ * between characters
+ * @param text The text to break
+ * @param measure Function for getting the rendered width of a string
+ * @param firstWidth Available width on the first line
+ * @param width Available width on every line after the first one. If zero, 
+ * lines are only broken at newlines
+ * @returns The lines, without the spaces they were broken at
+ */
+std::vector<std::string> breakLines(
+    std::string_view text,
+    std::function<float(std::string_view)> const& measure,
+    float firstWidth, float width
+);
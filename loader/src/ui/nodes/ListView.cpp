@@ -3,6 +3,7 @@
 #include <Geode/ui/ListView.hpp>
 #include <Geode/utils/casts.hpp>
 #include <Geode/utils/cocos.hpp>
+#include "ViewportCulling.hpp"
 
 using namespace geode::prelude;
 
@@ -66,6 +67,22 @@ void ListView::setupList(float) {
     }
 }
 
+void ListView::visit() {
+    if (!m_tableView || !m_tableView->m_contentLayer || !m_tableView->m_cutContent || !m_bVisible) {
+        m_culledCellCount = 0;
+        return CustomListView::visit();
+    }
+    m_culledCellCount = visitWithViewportCulling(
+        m_tableView->m_contentLayer, m_tableView->getContentSize(), [this] {
+            CustomListView::visit();
+        }
+    );
+}
+
+size_t ListView::getCulledCellCount() const {
+    return m_culledCellCount;
+}
+
 TableViewCell* ListView::getListCell(char const* key) {
     return GenericListCell::create(key, { m_width, m_itemSeparation });
 }
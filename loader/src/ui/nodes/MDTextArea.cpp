@@ -14,6 +14,10 @@
 #include <Geode/utils/string.hpp>
 #include <md4c.h>
 #include <charconv>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <Geode/loader/Log.hpp>
 #include <Geode/ui/GeodeUI.hpp>
 #include <server/Server.hpp>
@@ -128,6 +132,8 @@ bool MDTextArea::init(std::string const& str, CCSize const& size) {
     m_renderer = TextRenderer::create();
     CC_SAFE_RETAIN(m_renderer);
 
+    m_parseListener.bind(this, &MDTextArea::onParsed);
+
     m_bgSprite = CCScale9Sprite::create("square02b_001.png", { 0.0f, 0.0f, 80.0f, 80.0f });
     m_bgSprite->setScale(.5f);
     m_bgSprite->setColor({ 0, 0, 0 });
@@ -240,143 +246,181 @@ void MDTextArea::FLAlert_Clicked(FLAlertLayer* layer, bool btn) {
     }
 }
 
+enum class MDCommandType {
+    Text,
+    CodeSpanText,
+    LinkText,
+    Image,
+    ListMarker,
+    BreakLine,
+    BreakLineIfUnindented,
+    Rule,
+    PushStyle,
+    PopStyle,
+    PushDeco,
+    PopDeco,
+    PushScale,
+    PopScale,
+    PushColor,
+    PopColor,
+    PushIndent,
+    PopIndent,
+    PushMonoFont,
+    PopFont,
+    BeginCodeBlock,
+    EndCodeBlock,
+};
+
+struct MDCommand {
+    MDCommandType type;
+    std::string text = "";
+    // Link href or image source
+    std::string target = "";
+    float value = .0f;
+    int flags = 0;
+    ccColor3B color = { 255, 255, 255 };
+    // Image arguments
+    bool isFrame = false;
+    float width = .0f;
+    float height = .0f;
+};
+
+/**
+ * The result of parsing a markdown string: a flat list of commands that
+ * only need to be replayed through the TextRenderer to create the nodes.
+ * Plans don't touch cocos at all, so they can be built on any thread and
+ * shared between textareas showing the same string
+ */
+struct MDRenderPlan {
+    std::string source;
+    std::vector<MDCommand> commands;
+};
+
+// Replay state of a plan that is being rendered into a textarea
+struct MDPlanRendering {
+    std::shared_ptr<MDRenderPlan const> plan;
+    size_t next = 0;
+    float codeStart = 0;
+    std::vector<TextRenderer::Label> codeSpans;
+};
+
+static constexpr size_t PLAN_CACHE_SIZE = 16;
+static constexpr auto FRAME_RENDER_BUDGET = std::chrono::milliseconds(4);
+
 struct MDParser {
-    static std::string s_lastLink;
-    static std::string s_lastImage;
-    static bool s_isOrderedList;
-    static bool s_isCodeBlock;
-    static float s_codeStart;
-    static size_t s_orderedListNum;
-    static std::vector<TextRenderer::Label> s_codeSpans;
-    static bool s_breakListLine;
-
-    static int parseText(MD_TEXTTYPE type, MD_CHAR const* rawText, MD_SIZE size, void* mdtextarea) {
-        auto textarea = static_cast<MDTextArea*>(mdtextarea);
-        auto renderer = textarea->m_renderer;
+    MDRenderPlan plan;
+    std::string lastLink;
+    std::string lastImage;
+    bool isOrderedList = false;
+    bool isCodeBlock = false;
+    size_t orderedListNum = 0;
+    bool breakListLine = false;
+
+    static std::mutex s_planCacheMutex;
+    // Most recently used plans first
+    static std::deque<std::pair<size_t, std::shared_ptr<MDRenderPlan const>>> s_planCache;
+
+    void push(MDCommandType type) {
+        plan.commands.push_back(MDCommand { .type = type });
+    }
+    void pushText(MDCommandType type, std::string text) {
+        plan.commands.push_back(MDCommand { .type = type, .text = std::move(text) });
+    }
+    void pushValue(MDCommandType type, float value) {
+        plan.commands.push_back(MDCommand { .type = type, .value = value });
+    }
+    void pushFlags(MDCommandType type, int flags) {
+        plan.commands.push_back(MDCommand { .type = type, .flags = flags });
+    }
+
+    void pushImage(std::string const& text) {
+        MDCommand cmd { .type = MDCommandType::Image, .text = text, .value = 1.0f };
+
+        const auto splitOnce = [](const std::string& str, char delim) -> std::pair<std::string, std::string> {
+            const auto pos = str.find(delim);
+            if (pos == std::string::npos) {
+                return { str, {} };
+            }
+            return { str.substr(0, pos), str.substr(pos + 1) };
+        };
+
+        // key value pair of arguments
+        std::vector<std::pair<std::string, std::string>> imgArguments;
+        auto split = splitOnce(lastImage, '?');
+        cmd.target = split.first;
+
+        imgArguments = ranges::map<decltype(imgArguments)>(utils::string::split(split.second, "&"), [&](auto str) {
+            return splitOnce(str, '=');
+        });
+
+        for (auto [key, value] : imgArguments) {
+            if (key == "scale") {
+                auto scaleRes = utils::numFromString<float>(value);
+                if (scaleRes) {
+                    cmd.value = scaleRes.unwrap();
+                }
+            }
+            else if (key == "width") {
+                auto widthRes = utils::numFromString<float>(value);
+                if (widthRes) {
+                    cmd.width = widthRes.unwrap();
+                }
+            }
+            else if (key == "height") {
+                auto heightRes = utils::numFromString<float>(value);
+                if (heightRes) {
+                    cmd.height = heightRes.unwrap();
+                }
+            }
+        }
+
+        if (utils::string::startsWith(cmd.target, "frame:")) {
+            cmd.target = cmd.target.substr(cmd.target.find(":") + 1);
+            cmd.isFrame = true;
+        }
+        plan.commands.push_back(std::move(cmd));
+    }
+
+    static int parseText(MD_TEXTTYPE type, MD_CHAR const* rawText, MD_SIZE size, void* mdparser) {
+        auto parser = static_cast<MDParser*>(mdparser);
         auto text = std::string(rawText, size);
         switch (type) {
             case MD_TEXTTYPE::MD_TEXT_CODE:
                 {
-                    auto rendered = renderer->renderString(text);
-                    if (!s_isCodeBlock) {
-                        // code span BGs need to be rendered after all
-                        // rendering is done since the position of the
-                        // rendered labels may change after alignments
-                        // are adjusted
-                        ranges::push(s_codeSpans, rendered);
-                    }
+                    parser->pushText(
+                        parser->isCodeBlock ? MDCommandType::Text : MDCommandType::CodeSpanText,
+                        std::move(text)
+                    );
                 }
                 break;
 
             case MD_TEXTTYPE::MD_TEXT_BR:
                 {
-                    renderer->breakLine();
+                    parser->push(MDCommandType::BreakLine);
                 }
                 break;
 
             case MD_TEXTTYPE::MD_TEXT_SOFTBR:
                 {
-                    renderer->renderString(" ");
+                    parser->pushText(MDCommandType::Text, " ");
                 }
                 break;
 
             case MD_TEXTTYPE::MD_TEXT_NORMAL:
                 {
-                    if (s_lastLink.size()) {
-                        renderer->pushColor(g_linkColor);
-                        renderer->pushDecoFlags(TextDecorationUnderline);
-                        auto rendered = renderer->renderStringInteractive(
-                            text, textarea,
-                            utils::string::startsWith(s_lastLink, "user:")
-                                ? menu_selector(MDTextArea::onGDProfile)
-                                : utils::string::startsWith(s_lastLink, "level:")
-                                    ? menu_selector(MDTextArea::onGDLevel)
-                                    : utils::string::startsWith(s_lastLink, "mod:")
-                                        ? menu_selector(MDTextArea::onGeodeMod)
-                                        : menu_selector(MDTextArea::onLink)
-                        );
-                        for (auto const& label : rendered) {
-                            label.m_node->setUserObject(CCString::create(s_lastLink));
-                        }
-                        renderer->popDecoFlags();
-                        renderer->popColor();
-                    }
-                    else if (!s_lastImage.empty()) {
-                        bool isFrame = false;
-
-                        const auto splitOnce = [](const std::string& str, char delim) -> std::pair<std::string, std::string> {
-                            const auto pos = str.find(delim);
-                            if (pos == std::string::npos) {
-                                return { str, {} };
-                            }
-                            return { str.substr(0, pos), str.substr(pos + 1) };
-                        };
-
-                        // key value pair of arguments
-                        std::vector<std::pair<std::string, std::string>> imgArguments;
-                        auto split = splitOnce(s_lastImage, '?');
-                        s_lastImage = split.first;
-
-                        imgArguments = ranges::map<decltype(imgArguments)>(utils::string::split(split.second, "&"), [&](auto str) {
-                            return splitOnce(str, '=');
+                    if (parser->lastLink.size()) {
+                        parser->plan.commands.push_back(MDCommand {
+                            .type = MDCommandType::LinkText,
+                            .text = std::move(text),
+                            .target = parser->lastLink,
                         });
-
-                        float spriteScale = 1.0f;
-                        float spriteWidth = 0.0f;
-                        float spriteHeight = 0.0f;
-
-                        for (auto [key, value] : imgArguments) {
-                            if (key == "scale") {
-                                auto scaleRes = utils::numFromString<float>(value);
-                                if (scaleRes) {
-                                    spriteScale = scaleRes.unwrap();
-                                }
-                            }
-                            else if (key == "width") {
-                                auto widthRes = utils::numFromString<float>(value);
-                                if (widthRes) {
-                                    spriteWidth = widthRes.unwrap();
-                                }
-                            }
-                            else if (key == "height") {
-                                auto heightRes = utils::numFromString<float>(value);
-                                if (heightRes) {
-                                    spriteHeight = heightRes.unwrap();
-                                }
-                            }
-                        }
-
-                        if (utils::string::startsWith(s_lastImage, "frame:")) {
-                            s_lastImage = s_lastImage.substr(s_lastImage.find(":") + 1);
-                            isFrame = true;
-                        }
-                        CCSprite* spr = nullptr;
-                        if (isFrame) {
-                            spr = CCSprite::createWithSpriteFrameName(s_lastImage.c_str());
-                        }
-                        else {
-                            spr = CCSprite::create(s_lastImage.c_str());
-                        }
-                        if (spr && spr->getUserObject("geode.texture-loader/fallback") == nullptr) {
-                            spr->setScale(spriteScale);
-                            if (spriteWidth > 0.0f && spriteHeight <= 0.0f) {
-                                limitNodeWidth(spr, spriteWidth, 999.f, .1f);
-                            }
-                            else if (spriteHeight > 0.0f && spriteWidth <= 0.0f) {
-                                limitNodeHeight(spr, spriteHeight, 999.f, .1f);
-                            }
-                            else if (spriteWidth > 0.0f && spriteHeight > 0.0f) {
-                                limitNodeSize(spr, { spriteWidth, spriteHeight }, 999.f, .1f);
-                            }
-                            renderer->renderNode(spr);
-                        }
-                        else {
-                            renderer->renderString(text);
-                        }
-                        s_lastImage = "";
+                    }
+                    else if (!parser->lastImage.empty()) {
+                        parser->pushImage(text);
+                        parser->lastImage = "";
                     }
                     else {
-                        renderer->renderString(text);
+                        parser->pushText(MDCommandType::Text, std::move(text));
                     }
                 }
                 break;
@@ -389,16 +433,19 @@ struct MDParser {
                         if (isClosing) tag = tag.substr(1);
                         if (tag.front() != 'c') {
                             log::warn("Unknown tag {}", text);
-                            renderer->renderString(text);
+                            parser->pushText(MDCommandType::Text, std::move(text));
                         }
                         else {
                             if (isClosing) {
-                                renderer->popColor();
+                                parser->push(MDCommandType::PopColor);
                             }
                             else {
                                 auto color = colorForIdentifier(tag);
                                 if (color) {
-                                    renderer->pushColor(color.unwrap());
+                                    parser->plan.commands.push_back(MDCommand {
+                                        .type = MDCommandType::PushColor,
+                                        .color = color.unwrap(),
+                                    });
                                 }
                                 else {
                                     log::warn("Error parsing color: {}", color.unwrapErr());
@@ -408,7 +455,7 @@ struct MDParser {
                     }
                     else {
                         log::warn("Too short tag {}", text);
-                        renderer->renderString(text);
+                        parser->pushText(MDCommandType::Text, std::move(text));
                     }
                 }
                 break;
@@ -422,9 +469,8 @@ struct MDParser {
         return 0;
     }
 
-    static int enterBlock(MD_BLOCKTYPE type, void* detail, void* mdtextarea) {
-        auto textarea = static_cast<MDTextArea*>(mdtextarea);
-        auto renderer = textarea->m_renderer;
+    static int enterBlock(MD_BLOCKTYPE type, void* detail, void* mdparser) {
+        auto parser = static_cast<MDParser*>(mdparser);
         switch (type) {
             case MD_BLOCKTYPE::MD_BLOCK_DOC:
                 {
@@ -434,19 +480,16 @@ struct MDParser {
             case MD_BLOCKTYPE::MD_BLOCK_H:
                 {
                     auto hdetail = static_cast<MD_BLOCK_H_DETAIL*>(detail);
-                    renderer->pushStyleFlags(TextStyleBold);
+                    parser->pushFlags(MDCommandType::PushStyle, TextStyleBold);
                     switch (hdetail->level) {
-                        case 1: renderer->pushScale(g_fontScale * 2.f); break;
-                        case 2: renderer->pushScale(g_fontScale * 1.5f); break;
-                        case 3: renderer->pushScale(g_fontScale * 1.17f); break;
-                        case 4: renderer->pushScale(g_fontScale); break;
-                        case 5: renderer->pushScale(g_fontScale * .83f); break;
+                        case 1: parser->pushValue(MDCommandType::PushScale, g_fontScale * 2.f); break;
+                        case 2: parser->pushValue(MDCommandType::PushScale, g_fontScale * 1.5f); break;
+                        case 3: parser->pushValue(MDCommandType::PushScale, g_fontScale * 1.17f); break;
+                        case 4: parser->pushValue(MDCommandType::PushScale, g_fontScale); break;
+                        case 5: parser->pushValue(MDCommandType::PushScale, g_fontScale * .83f); break;
                         default:
-                        case 6: renderer->pushScale(g_fontScale * .67f); break;
+                        case 6: parser->pushValue(MDCommandType::PushScale, g_fontScale * .67f); break;
                     }
-                    // switch (hdetail->level) {
-                    //     case 3: renderer->pushCaps(TextCapitalization::AllUpper); break;
-                    // }
                 }
                 break;
 
@@ -458,51 +501,48 @@ struct MDParser {
             case MD_BLOCKTYPE::MD_BLOCK_UL:
             case MD_BLOCKTYPE::MD_BLOCK_OL:
                 {
-                    renderer->pushIndent(g_indent);
-                    s_isOrderedList = type == MD_BLOCKTYPE::MD_BLOCK_OL;
-                    s_orderedListNum = 0;
-                    if (s_breakListLine) {
-                        renderer->breakLine();
-                        s_breakListLine = false;
+                    parser->pushValue(MDCommandType::PushIndent, g_indent);
+                    parser->isOrderedList = type == MD_BLOCKTYPE::MD_BLOCK_OL;
+                    parser->orderedListNum = 0;
+                    if (parser->breakListLine) {
+                        parser->push(MDCommandType::BreakLine);
+                        parser->breakListLine = false;
                     }
                 }
                 break;
 
             case MD_BLOCKTYPE::MD_BLOCK_HR:
                 {
-                    renderer->breakLine(g_paragraphPadding / 2);
-                    renderer->renderNode(BreakLine::create(textarea->m_size.width));
-                    renderer->breakLine(g_paragraphPadding);
+                    parser->pushValue(MDCommandType::BreakLine, g_paragraphPadding / 2);
+                    parser->push(MDCommandType::Rule);
+                    parser->pushValue(MDCommandType::BreakLine, g_paragraphPadding);
                 }
                 break;
 
             case MD_BLOCKTYPE::MD_BLOCK_LI:
                 {
-                    if (s_breakListLine) {
-                        renderer->breakLine();
-                        s_breakListLine = false;
+                    if (parser->breakListLine) {
+                        parser->push(MDCommandType::BreakLine);
+                        parser->breakListLine = false;
                     }
-                    renderer->pushOpacity(renderer->getCurrentOpacity() / 2);
-                    auto lidetail = static_cast<MD_BLOCK_LI_DETAIL*>(detail);
-                    if (s_isOrderedList) {
-                        s_orderedListNum++;
-                        renderer->renderString(std::to_string(s_orderedListNum) + ". ");
+                    if (parser->isOrderedList) {
+                        parser->orderedListNum++;
+                        parser->pushText(
+                            MDCommandType::ListMarker,
+                            std::to_string(parser->orderedListNum) + ". "
+                        );
                     }
                     else {
-                        renderer->renderString("• ");
+                        parser->pushText(MDCommandType::ListMarker, "• ");
                     }
-                    renderer->popOpacity();
-                    s_breakListLine = true;
+                    parser->breakListLine = true;
                 }
                 break;
 
             case MD_BLOCKTYPE::MD_BLOCK_CODE:
                 {
-                    s_isCodeBlock = true;
-                    s_codeStart = renderer->getCursorPos().y;
-                    renderer->pushFont(g_mdMonoFont);
-                    renderer->pushIndent(g_codeBlockIndent);
-                    renderer->pushWrapOffset(g_codeBlockIndent);
+                    parser->isCodeBlock = true;
+                    parser->push(MDCommandType::BeginCodeBlock);
                 }
                 break;
 
@@ -515,9 +555,8 @@ struct MDParser {
         return 0;
     }
 
-    static int leaveBlock(MD_BLOCKTYPE type, void* detail, void* mdtextarea) {
-        auto textarea = static_cast<MDTextArea*>(mdtextarea);
-        auto renderer = textarea->m_renderer;
+    static int leaveBlock(MD_BLOCKTYPE type, void* detail, void* mdparser) {
+        auto parser = static_cast<MDParser*>(mdparser);
         switch (type) {
             case MD_BLOCKTYPE::MD_BLOCK_DOC:
                 {
@@ -527,75 +566,39 @@ struct MDParser {
             case MD_BLOCKTYPE::MD_BLOCK_H:
                 {
                     auto hdetail = static_cast<MD_BLOCK_H_DETAIL*>(detail);
-                    renderer->breakLine();
+                    parser->push(MDCommandType::BreakLine);
                     if (hdetail->level == 1) {
-                        renderer->breakLine(g_paragraphPadding / 2);
-                        renderer->renderNode(BreakLine::create(textarea->m_size.width));
+                        parser->pushValue(MDCommandType::BreakLine, g_paragraphPadding / 2);
+                        parser->push(MDCommandType::Rule);
                     }
-                    renderer->breakLine(g_paragraphPadding);
-                    renderer->popScale();
-                    renderer->popStyleFlags();
-                    // switch (hdetail->level) {
-                    //     case 3: renderer->popCaps(); break;
-                    // }
+                    parser->pushValue(MDCommandType::BreakLine, g_paragraphPadding);
+                    parser->push(MDCommandType::PopScale);
+                    parser->push(MDCommandType::PopStyle);
                 }
                 break;
 
             case MD_BLOCKTYPE::MD_BLOCK_P:
                 {
-                    renderer->breakLine();
-                    renderer->breakLine(g_paragraphPadding);
+                    parser->push(MDCommandType::BreakLine);
+                    parser->pushValue(MDCommandType::BreakLine, g_paragraphPadding);
                 }
                 break;
 
             case MD_BLOCKTYPE::MD_BLOCK_OL:
             case MD_BLOCKTYPE::MD_BLOCK_UL:
                 {
-                    renderer->popIndent();
-                    if (s_breakListLine) {
-                        renderer->breakLine();
-                        s_breakListLine = false;
-                    }
-                    if (renderer->getCurrentIndent() == 0) {
-                        renderer->breakLine();
+                    parser->push(MDCommandType::PopIndent);
+                    if (parser->breakListLine) {
+                        parser->push(MDCommandType::BreakLine);
+                        parser->breakListLine = false;
                     }
+                    parser->push(MDCommandType::BreakLineIfUnindented);
                 }
                 break;
 
             case MD_BLOCKTYPE::MD_BLOCK_CODE:
                 {
-                    auto codeEnd = renderer->getCursorPos().y;
-
-                    auto pad = g_codeBlockIndent / 1.5f;
-
-                    CCSize size { textarea->m_size.width - renderer->getCurrentIndent() -
-                                      renderer->getCurrentWrapOffset() + pad * 2,
-                                  s_codeStart - codeEnd + pad * 2 };
-
-                    auto bg =
-                        CCScale9Sprite::create("square02b_001.png", { 0.0f, 0.0f, 80.0f, 80.0f });
-                    bg->setScale(.25f);
-                    bg->setColor({ 0, 0, 0 });
-                    bg->setOpacity(75);
-                    bg->setContentSize(size * 4);
-                    bg->setPosition(
-                        size.width / 2 + renderer->getCurrentIndent() - pad,
-                        // mmm i love magic numbers
-                        // the -2.f is to offset the the box
-                        // to fit the Ubuntu font very neatly.
-                        // idk if it works the same for other
-                        // fonts
-                        s_codeStart - 2.f + pad - size.height / 2
-                    );
-                    bg->setAnchorPoint({ .5f, .5f });
-                    bg->setZOrder(-1);
-                    textarea->m_content->addChild(bg);
-
-                    renderer->popWrapOffset();
-                    renderer->popIndent();
-                    renderer->popFont();
-
-                    renderer->breakLine();
+                    parser->push(MDCommandType::EndCodeBlock);
                 }
                 break;
 
@@ -618,51 +621,51 @@ struct MDParser {
         return 0;
     }
 
-    static int enterSpan(MD_SPANTYPE type, void* detail, void* mdtextarea) {
-        auto renderer = static_cast<MDTextArea*>(mdtextarea)->m_renderer;
+    static int enterSpan(MD_SPANTYPE type, void* detail, void* mdparser) {
+        auto parser = static_cast<MDParser*>(mdparser);
         switch (type) {
             case MD_SPANTYPE::MD_SPAN_STRONG:
                 {
-                    renderer->pushStyleFlags(TextStyleBold);
+                    parser->pushFlags(MDCommandType::PushStyle, TextStyleBold);
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_EM:
                 {
-                    renderer->pushStyleFlags(TextStyleItalic);
+                    parser->pushFlags(MDCommandType::PushStyle, TextStyleItalic);
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_DEL:
                 {
-                    renderer->pushDecoFlags(TextDecorationStrikethrough);
+                    parser->pushFlags(MDCommandType::PushDeco, TextDecorationStrikethrough);
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_U:
                 {
-                    renderer->pushDecoFlags(TextDecorationUnderline);
+                    parser->pushFlags(MDCommandType::PushDeco, TextDecorationUnderline);
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_IMG:
                 {
                     auto adetail = static_cast<MD_SPAN_IMG_DETAIL*>(detail);
-                    s_lastImage = std::string(adetail->src.text, adetail->src.size);
+                    parser->lastImage = std::string(adetail->src.text, adetail->src.size);
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_A:
                 {
                     auto adetail = static_cast<MD_SPAN_A_DETAIL*>(detail);
-                    s_lastLink = std::string(adetail->href.text, adetail->href.size);
+                    parser->lastLink = std::string(adetail->href.text, adetail->href.size);
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_CODE:
                 {
-                    s_isCodeBlock = false;
-                    renderer->pushFont(g_mdMonoFont);
+                    parser->isCodeBlock = false;
+                    parser->push(MDCommandType::PushMonoFont);
                 }
                 break;
 
@@ -675,48 +678,38 @@ struct MDParser {
         return 0;
     }
 
-    static int leaveSpan(MD_SPANTYPE type, void* detail, void* mdtextarea) {
-        auto renderer = static_cast<MDTextArea*>(mdtextarea)->m_renderer;
+    static int leaveSpan(MD_SPANTYPE type, void* detail, void* mdparser) {
+        auto parser = static_cast<MDParser*>(mdparser);
         switch (type) {
             case MD_SPANTYPE::MD_SPAN_STRONG:
-                {
-                    renderer->popStyleFlags();
-                }
-                break;
-
             case MD_SPANTYPE::MD_SPAN_EM:
                 {
-                    renderer->popStyleFlags();
+                    parser->push(MDCommandType::PopStyle);
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_DEL:
-                {
-                    renderer->popDecoFlags();
-                }
-                break;
-
             case MD_SPANTYPE::MD_SPAN_U:
                 {
-                    renderer->popDecoFlags();
+                    parser->push(MDCommandType::PopDeco);
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_A:
                 {
-                    s_lastLink = "";
+                    parser->lastLink = "";
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_IMG:
                 {
-                    s_lastImage = "";
+                    parser->lastImage = "";
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_CODE:
                 {
-                    renderer->popFont();
+                    parser->push(MDCommandType::PopFont);
                 }
                 break;
 
@@ -728,79 +721,364 @@ struct MDParser {
         }
         return 0;
     }
+
+    static std::shared_ptr<MDRenderPlan const> getCachedPlan(std::string const& text) {
+        auto hash = std::hash<std::string>()(text);
+        std::lock_guard lock(s_planCacheMutex);
+        for (auto it = s_planCache.begin(); it != s_planCache.end(); it++) {
+            if (it->first == hash && it->second->source == text) {
+                auto plan = it->second;
+                s_planCache.erase(it);
+                s_planCache.emplace_front(hash, plan);
+                return plan;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Parse a markdown string into a render plan, or return the cached plan
+     * if the same string has been parsed before. Safe to call from any thread
+     */
+    static std::shared_ptr<MDRenderPlan const> parse(std::string const& text) {
+        if (auto cached = MDParser::getCachedPlan(text)) {
+            return cached;
+        }
+
+        MD_PARSER parser;
+
+        parser.abi_version = 0;
+        parser.flags = MD_FLAG_UNDERLINE | MD_FLAG_STRIKETHROUGH | MD_FLAG_PERMISSIVEURLAUTOLINKS |
+            MD_FLAG_PERMISSIVEWWWAUTOLINKS;
+
+        parser.text = &MDParser::parseText;
+        parser.enter_block = &MDParser::enterBlock;
+        parser.leave_block = &MDParser::leaveBlock;
+        parser.enter_span = &MDParser::enterSpan;
+        parser.leave_span = &MDParser::leaveSpan;
+        parser.debug_log = nullptr;
+        parser.syntax = nullptr;
+
+        MDParser state;
+        state.plan.source = text;
+
+        if (md_parse(text.c_str(), text.size(), &parser, &state)) {
+            state.pushText(MDCommandType::Text, "Error parsing Markdown");
+        }
+
+        auto plan = std::make_shared<MDRenderPlan const>(std::move(state.plan));
+
+        std::lock_guard lock(s_planCacheMutex);
+        s_planCache.emplace_front(std::hash<std::string>()(text), plan);
+        if (s_planCache.size() > PLAN_CACHE_SIZE) {
+            s_planCache.pop_back();
+        }
+        return plan;
+    }
+
+    static void renderCommand(MDTextArea* textarea, MDPlanRendering& state, MDCommand const& cmd) {
+        auto renderer = textarea->m_renderer;
+        switch (cmd.type) {
+            case MDCommandType::Text:
+                {
+                    renderer->renderString(cmd.text);
+                }
+                break;
+
+            case MDCommandType::CodeSpanText:
+                {
+                    // code span BGs need to be rendered after all
+                    // rendering is done since the position of the
+                    // rendered labels may change after alignments
+                    // are adjusted
+                    ranges::push(state.codeSpans, renderer->renderString(cmd.text));
+                }
+                break;
+
+            case MDCommandType::LinkText:
+                {
+                    renderer->pushColor(g_linkColor);
+                    renderer->pushDecoFlags(TextDecorationUnderline);
+                    auto rendered = renderer->renderStringInteractive(
+                        cmd.text, textarea,
+                        utils::string::startsWith(cmd.target, "user:")
+                            ? menu_selector(MDTextArea::onGDProfile)
+                            : utils::string::startsWith(cmd.target, "level:")
+                                ? menu_selector(MDTextArea::onGDLevel)
+                                : utils::string::startsWith(cmd.target, "mod:")
+                                    ? menu_selector(MDTextArea::onGeodeMod)
+                                    : menu_selector(MDTextArea::onLink)
+                    );
+                    for (auto const& label : rendered) {
+                        label.m_node->setUserObject(CCString::create(cmd.target));
+                    }
+                    renderer->popDecoFlags();
+                    renderer->popColor();
+                }
+                break;
+
+            case MDCommandType::Image:
+                {
+                    CCSprite* spr = nullptr;
+                    if (cmd.isFrame) {
+                        spr = CCSprite::createWithSpriteFrameName(cmd.target.c_str());
+                    }
+                    else {
+                        spr = CCSprite::create(cmd.target.c_str());
+                    }
+                    if (spr && spr->getUserObject("geode.texture-loader/fallback") == nullptr) {
+                        spr->setScale(cmd.value);
+                        if (cmd.width > 0.0f && cmd.height <= 0.0f) {
+                            limitNodeWidth(spr, cmd.width, 999.f, .1f);
+                        }
+                        else if (cmd.height > 0.0f && cmd.width <= 0.0f) {
+                            limitNodeHeight(spr, cmd.height, 999.f, .1f);
+                        }
+                        else if (cmd.width > 0.0f && cmd.height > 0.0f) {
+                            limitNodeSize(spr, { cmd.width, cmd.height }, 999.f, .1f);
+                        }
+                        renderer->renderNode(spr);
+                    }
+                    else {
+                        renderer->renderString(cmd.text);
+                    }
+                }
+                break;
+
+            case MDCommandType::ListMarker:
+                {
+                    renderer->pushOpacity(renderer->getCurrentOpacity() / 2);
+                    renderer->renderString(cmd.text);
+                    renderer->popOpacity();
+                }
+                break;
+
+            case MDCommandType::BreakLine:
+                {
+                    renderer->breakLine(cmd.value);
+                }
+                break;
+
+            case MDCommandType::BreakLineIfUnindented:
+                {
+                    if (renderer->getCurrentIndent() == 0) {
+                        renderer->breakLine();
+                    }
+                }
+                break;
+
+            case MDCommandType::Rule:
+                {
+                    renderer->renderNode(BreakLine::create(textarea->m_size.width));
+                }
+                break;
+
+            case MDCommandType::PushStyle: renderer->pushStyleFlags(cmd.flags); break;
+            case MDCommandType::PopStyle: renderer->popStyleFlags(); break;
+            case MDCommandType::PushDeco: renderer->pushDecoFlags(cmd.flags); break;
+            case MDCommandType::PopDeco: renderer->popDecoFlags(); break;
+            case MDCommandType::PushScale: renderer->pushScale(cmd.value); break;
+            case MDCommandType::PopScale: renderer->popScale(); break;
+            case MDCommandType::PushColor: renderer->pushColor(cmd.color); break;
+            case MDCommandType::PopColor: renderer->popColor(); break;
+            case MDCommandType::PushIndent: renderer->pushIndent(cmd.value); break;
+            case MDCommandType::PopIndent: renderer->popIndent(); break;
+            case MDCommandType::PushMonoFont: renderer->pushFont(g_mdMonoFont); break;
+            case MDCommandType::PopFont: renderer->popFont(); break;
+
+            case MDCommandType::BeginCodeBlock:
+                {
+                    state.codeStart = renderer->getCursorPos().y;
+                    renderer->pushFont(g_mdMonoFont);
+                    renderer->pushIndent(g_codeBlockIndent);
+                    renderer->pushWrapOffset(g_codeBlockIndent);
+                }
+                break;
+
+            case MDCommandType::EndCodeBlock:
+                {
+                    auto codeEnd = renderer->getCursorPos().y;
+
+                    auto pad = g_codeBlockIndent / 1.5f;
+
+                    CCSize size { textarea->m_size.width - renderer->getCurrentIndent() -
+                                      renderer->getCurrentWrapOffset() + pad * 2,
+                                  state.codeStart - codeEnd + pad * 2 };
+
+                    auto bg =
+                        CCScale9Sprite::create("square02b_001.png", { 0.0f, 0.0f, 80.0f, 80.0f });
+                    bg->setScale(.25f);
+                    bg->setColor({ 0, 0, 0 });
+                    bg->setOpacity(75);
+                    bg->setContentSize(size * 4);
+                    bg->setPosition(
+                        size.width / 2 + renderer->getCurrentIndent() - pad,
+                        // mmm i love magic numbers
+                        // the -2.f is to offset the the box
+                        // to fit the Ubuntu font very neatly.
+                        // idk if it works the same for other
+                        // fonts
+                        state.codeStart - 2.f + pad - size.height / 2
+                    );
+                    bg->setAnchorPoint({ .5f, .5f });
+                    bg->setZOrder(-1);
+                    textarea->m_content->addChild(bg);
+
+                    renderer->popWrapOffset();
+                    renderer->popIndent();
+                    renderer->popFont();
+
+                    renderer->breakLine();
+                }
+                break;
+        }
+    }
+
+    static void beginRender(MDTextArea* textarea) {
+        auto renderer = textarea->m_renderer;
+
+        // a previous render may have been abandoned halfway through
+        // if the string changed, so reset the renderer's stacks
+        if (textarea->m_renderInProgress) {
+            renderer->end(false);
+        }
+        textarea->m_renderInProgress = true;
+
+        renderer->begin(textarea->m_content, CCPointZero, textarea->m_size);
+
+        renderer->pushFont(g_mdFont);
+        renderer->pushScale(.5f);
+        renderer->pushVerticalAlign(TextAlignment::End);
+        renderer->pushHorizontalAlign(TextAlignment::Begin);
+    }
+
+    /**
+     * Replay commands until the plan is done or the deadline passes
+     * @returns True if the whole plan has been rendered
+     */
+    static bool renderCommands(
+        MDTextArea* textarea, MDPlanRendering& state,
+        std::optional<std::chrono::steady_clock::time_point> deadline
+    ) {
+        auto const& commands = state.plan->commands;
+        while (state.next < commands.size()) {
+            MDParser::renderCommand(textarea, state, commands[state.next++]);
+            if (deadline && std::chrono::steady_clock::now() > *deadline) {
+                break;
+            }
+        }
+        return state.next >= commands.size();
+    }
+
+    static void finishRender(MDTextArea* textarea, MDPlanRendering& state) {
+        auto content = textarea->m_content;
+        auto scrollLayer = textarea->m_scrollLayer;
+        auto size = textarea->m_size;
+
+        for (auto& render : state.codeSpans) {
+            auto bg = CCScale9Sprite::create("square02b_001.png", { 0.0f, 0.0f, 80.0f, 80.0f });
+            bg->setScale(.125f);
+            bg->setColor({ 0, 0, 0 });
+            bg->setOpacity(75);
+            bg->setContentSize(render.m_node->getScaledContentSize() * 8 + CCSize { 20.f, .0f });
+            bg->setPosition(
+                render.m_node->getPositionX() - 2.5f * (.5f - render.m_node->getAnchorPoint().x),
+                render.m_node->getPositionY() - .5f
+            );
+            bg->setAnchorPoint(render.m_node->getAnchorPoint());
+            bg->setZOrder(-1);
+            content->addChild(bg);
+            // i know what you're thinking.
+            // my brother in christ, what the hell is this?
+            // where did this magical + 1.5f come from?
+            // the reason is that if you remove them, code
+            // spans are slightly offset and it triggers my
+            // OCD.
+            render.m_node->setPositionY(render.m_node->getPositionY() + 1.5f);
+        }
+
+        textarea->m_renderer->end();
+        textarea->m_renderInProgress = false;
+
+        if (content->getContentSize().height > size.height) {
+            // Generate bottom padding
+            scrollLayer->m_contentLayer->setContentSize(content->getContentSize() + CCSize { 0.f, 12.5 });
+            content->setPositionY(10.f);
+        } else {
+            scrollLayer->m_contentLayer->setContentSize(content->getContentSize());
+            content->setPositionY(-2.5f);
+        }
+
+        scrollLayer->moveToTop();
+    }
+
+    static void renderChunk(
+        WeakRef<MDTextArea> weak, size_t generation, std::shared_ptr<MDPlanRendering> state
+    ) {
+        auto textarea = weak.lock();
+        // the textarea was freed or its string was changed
+        if (!textarea || textarea->m_renderGeneration != generation) {
+            return;
+        }
+        auto deadline = std::chrono::steady_clock::now() + FRAME_RENDER_BUDGET;
+        if (MDParser::renderCommands(textarea, *state, deadline)) {
+            MDParser::finishRender(textarea, *state);
+        }
+        else {
+            queueInMainThread([weak = std::move(weak), generation, state = std::move(state)]() mutable {
+                MDParser::renderChunk(std::move(weak), generation, std::move(state));
+            });
+        }
+    }
+
+    static void render(MDTextArea* textarea, std::shared_ptr<MDRenderPlan const> plan, bool spreadOverFrames) {
+        auto state = std::make_shared<MDPlanRendering>();
+        state->plan = std::move(plan);
+
+        MDParser::beginRender(textarea);
+        if (spreadOverFrames) {
+            MDParser::renderChunk(WeakRef(textarea), textarea->m_renderGeneration, std::move(state));
+        }
+        else {
+            MDParser::renderCommands(textarea, *state, std::nullopt);
+            MDParser::finishRender(textarea, *state);
+        }
+    }
 };
 
-std::string MDParser::s_lastLink = "";
-std::string MDParser::s_lastImage = "";
-bool MDParser::s_isOrderedList = false;
-size_t MDParser::s_orderedListNum = 0;
-bool MDParser::s_isCodeBlock = false;
-float MDParser::s_codeStart = 0;
-decltype(MDParser::s_codeSpans) MDParser::s_codeSpans = {};
-bool MDParser::s_breakListLine = false;
+std::mutex MDParser::s_planCacheMutex;
+decltype(MDParser::s_planCache) MDParser::s_planCache = {};
 
 void MDTextArea::updateLabel() {
-    m_renderer->begin(m_content, CCPointZero, m_size);
-
-    m_renderer->pushFont(g_mdFont);
-    m_renderer->pushScale(.5f);
-    m_renderer->pushVerticalAlign(TextAlignment::End);
-    m_renderer->pushHorizontalAlign(TextAlignment::Begin);
-
-    MD_PARSER parser;
-
-    parser.abi_version = 0;
-    parser.flags = MD_FLAG_UNDERLINE | MD_FLAG_STRIKETHROUGH | MD_FLAG_PERMISSIVEURLAUTOLINKS |
-        MD_FLAG_PERMISSIVEWWWAUTOLINKS;
-
-    parser.text = &MDParser::parseText;
-    parser.enter_block = &MDParser::enterBlock;
-    parser.leave_block = &MDParser::leaveBlock;
-    parser.enter_span = &MDParser::enterSpan;
-    parser.leave_span = &MDParser::leaveSpan;
-    parser.debug_log = nullptr;
-    parser.syntax = nullptr;
-
-    MDParser::s_codeSpans = {};
-
-    if (md_parse(m_text.c_str(), m_text.size(), &parser, this)) {
-        m_renderer->renderString("Error parsing Markdown");
-    }
-
-    for (auto& render : MDParser::s_codeSpans) {
-        auto bg = CCScale9Sprite::create("square02b_001.png", { 0.0f, 0.0f, 80.0f, 80.0f });
-        bg->setScale(.125f);
-        bg->setColor({ 0, 0, 0 });
-        bg->setOpacity(75);
-        bg->setContentSize(render.m_node->getScaledContentSize() * 8 + CCSize { 20.f, .0f });
-        bg->setPosition(
-            render.m_node->getPositionX() - 2.5f * (.5f - render.m_node->getAnchorPoint().x),
-            render.m_node->getPositionY() - .5f
-        );
-        bg->setAnchorPoint(render.m_node->getAnchorPoint());
-        bg->setZOrder(-1);
-        m_content->addChild(bg);
-        // i know what you're thinking.
-        // my brother in christ, what the hell is this?
-        // where did this magical + 1.5f come from?
-        // the reason is that if you remove them, code
-        // spans are slightly offset and it triggers my
-        // OCD.
-        render.m_node->setPositionY(render.m_node->getPositionY() + 1.5f);
-    }
-
-    m_renderer->end();
-
-    if (m_content->getContentSize().height > m_size.height) {
-        // Generate bottom padding
-        m_scrollLayer->m_contentLayer->setContentSize(m_content->getContentSize() + CCSize { 0.f, 12.5 });
-        m_content->setPositionY(10.f);
-    } else {
-        m_scrollLayer->m_contentLayer->setContentSize(m_content->getContentSize());
-        m_content->setPositionY(-2.5f);
-    }
-
-    m_scrollLayer->moveToTop();
+    m_renderGeneration += 1;
+    m_parseListener.setFilter(MDParseTask());
+
+    if (auto plan = MDParser::getCachedPlan(m_text)) {
+        return MDParser::render(this, std::move(plan), m_asyncRendering);
+    }
+    if (!m_asyncRendering) {
+        return MDParser::render(this, MDParser::parse(m_text), false);
+    }
+    m_parseListener.setFilter(MDParseTask::run(
+        [text = m_text](auto, auto) -> MDParseTask::Result {
+            return MDParser::parse(text);
+        },
+        "MDTextArea parsing"
+    ));
+}
+
+void MDTextArea::onParsed(MDParseTask::Event* event) {
+    if (auto plan = event->getValue()) {
+        MDParser::render(this, *plan, true);
+    }
+}
+
+void MDTextArea::setAsyncRendering(bool async) {
+    m_asyncRendering = async;
+}
+
+bool MDTextArea::isAsyncRendering() const {
+    return m_asyncRendering;
 }
 
 CCScrollLayerExt* MDTextArea::getScrollLayer() const {
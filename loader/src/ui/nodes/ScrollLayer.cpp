@@ -1,5 +1,6 @@
 #include <Geode/ui/ScrollLayer.hpp>
 #include <Geode/utils/cocos.hpp>
+#include "ViewportCulling.hpp"
 
 using namespace geode::prelude;
 
@@ -24,6 +25,22 @@ void GenericContentLayer::setPosition(CCPoint const& pos) {
     }
 }
 
+void GenericContentLayer::visit() {
+    // Culling is only correct if the parent actually cuts off the content
+    auto scroll = typeinfo_cast<CCScrollLayerExt*>(m_pParent);
+    if (!scroll || !scroll->m_cutContent || !m_bVisible) {
+        m_culledChildCount = 0;
+        return CCContentLayer::visit();
+    }
+    m_culledChildCount = visitWithViewportCulling(this, scroll->getContentSize(), [this] {
+        CCContentLayer::visit();
+    });
+}
+
+size_t GenericContentLayer::getCulledChildCount() const {
+    return m_culledChildCount;
+}
+
 void ScrollLayer::visit() {
     if (m_cutContent && this->isVisible()) {
         glEnable(GL_SCISSOR_TEST);
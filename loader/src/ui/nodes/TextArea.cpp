@@ -1,4 +1,5 @@
 #include <Geode/ui/TextArea.hpp>
+#include "LineBreaker.hpp"
 
 using namespace geode::prelude;
 
@@ -135,132 +136,174 @@ float SimpleTextArea::getLineHeight() {
     return m_lineHeight;
 }
 
-CCLabelBMFont* SimpleTextArea::createLabel(const std::string& text, float top) {
-    if (m_maxLines && m_lines.size() >= m_maxLines) {
-        CCLabelBMFont* last = m_lines.at(m_maxLines - 1);
-        const std::string& text = last->getString();
+bool SimpleTextArea::addLine(std::vector<std::string>& lines, std::string line) {
+    if (m_maxLines && lines.size() >= m_maxLines) {
+        std::string& last = lines.at(m_maxLines - 1);
 
-        last->setString(text.substr(0, text.size() - 3).append("...").c_str());
+        last = last.substr(0, last.size() - 3).append("...");
 
-        return nullptr;
+        return false;
     } else {
-        CCLabelBMFont* label = CCLabelBMFont::create(text.c_str(), m_font.c_str());
-
-        label->setScale(m_scale);
-        label->setPosition({ 0, top });
-        label->setColor({ m_color.r, m_color.g, m_color.b });
-        label->setOpacity(m_color.a);
+        lines.push_back(std::move(line));
 
-        return label;
+        return true;
     }
 }
 
+CCLabelBMFont* SimpleTextArea::createLabel(const std::string& text, float top) {
+    CCLabelBMFont* label = CCLabelBMFont::create(text.c_str(), m_font.c_str());
+
+    label->setScale(m_scale);
+    label->setPosition({ 0, top });
+    label->setColor({ m_color.r, m_color.g, m_color.b });
+    label->setOpacity(m_color.a);
+
+    return label;
+}
+
 float SimpleTextArea::calculateOffset(CCLabelBMFont* label) {
     return m_linePadding + label->getContentSize().height * m_scale;
 }
 
-void SimpleTextArea::charIteration(const std::function<CCLabelBMFont*(CCLabelBMFont* line, char c, float top)>& overflowHandling) {
-    float top = 0;
-    m_lines.clear();
-    CCLabelBMFont* line = this->createLabel("", top);
-    m_lines = { line };
+std::vector<std::string> SimpleTextArea::charIteration(const std::function<bool(std::vector<std::string>& lines, std::string_view c)>& overflowHandling) {
+    // Measure lines with the font's glyph metrics instead of setting the 
+    // string of a label for every character
+    std::optional<BMFontMetrics> metrics;
+    if (auto config = FNTConfigLoadFile(m_font.c_str())) {
+        metrics.emplace(config);
+    }
+    BMFontMetrics::Pen pen;
+    const float width = this->getWidth();
+
+    std::vector<std::string> lines = { "" };
+    const std::string_view text = m_text;
+    size_t pos = 0;
 
-    for (const char c : m_text) {
-        if (c == '\n') {
-            line = this->createLabel("", top -= this->calculateOffset(line));
+    while (pos < text.size()) {
+        const size_t start = pos;
+        nextCodePoint(text, pos);
+        const std::string_view c = text.substr(start, pos - start);
 
-            if (line == nullptr) {
+        if (c == "\n") {
+            if (!this->addLine(lines, "")) {
                 break;
-            } else {
-                m_lines.push_back(line);
             }
-        } else if (m_artificialWidth && line->getContentWidth() * m_scale >= this->getWidth()) {
-            line = overflowHandling(line, c, top -= this->calculateOffset(line));
-
-            if (line == nullptr) {
+            pen = {};
+        } else if (m_artificialWidth && metrics && metrics->width(pen) * m_scale >= width) {
+            if (!overflowHandling(lines, c)) {
                 break;
-            } else {
-                m_lines.push_back(line);
             }
+            pen = {};
+            metrics->advance(pen, lines.back());
         } else {
-            line->setString((std::string(line->getString()) + c).c_str());
+            lines.back().append(c);
+            if (metrics) {
+                size_t i = 0;
+                metrics->advance(pen, nextCodePoint(c, i));
+            }
         }
     }
+
+    return lines;
 }
 
-void SimpleTextArea::updateLinesNoWrap() {
+std::vector<std::string> SimpleTextArea::updateLinesNoWrap() {
     std::stringstream stream(m_text);
     std::string part;
-    float top = 0;
-    m_lines.clear();
+    std::vector<std::string> lines;
 
     while (std::getline(stream, part)) {
-        CCLabelBMFont* line = this->createLabel(part, top);
-
-        if (line == nullptr) {
+        if (!this->addLine(lines, part)) {
             break;
-        } else {
-            top -= this->calculateOffset(line);
-
-            m_lines.push_back(line);
         }
     }
+
+    return lines;
 }
 
-void SimpleTextArea::updateLinesWordWrap(bool spaceWrap) {
-    this->charIteration([this, spaceWrap](CCLabelBMFont* line, char c, float top) {
+std::vector<std::string> SimpleTextArea::updateLinesWordWrap(bool spaceWrap) {
+    return this->charIteration([this, spaceWrap](std::vector<std::string>& lines, std::string_view c) {
         const std::string_view delimiters(spaceWrap ? " " : " `~!@#$%^&*()-_=+[{}];:'\",<.>/?\\|");
 
-        if (delimiters.find(c) == std::string_view::npos) {
-            const std::string& text = line->getString();
+        if (c.size() != 1 || delimiters.find(c[0]) == std::string_view::npos) {
+            const std::string text = lines.back();
             const size_t position = text.find_last_of(delimiters) + 1;
-            CCLabelBMFont* newLine = this->createLabel(text.substr(position) + c, top);
 
-            if (newLine != nullptr) {
-                line->setString(text.substr(0, position).c_str());
+            if (this->addLine(lines, text.substr(position).append(c))) {
+                lines[lines.size() - 2] = text.substr(0, position);
+                return true;
             }
 
-            return newLine;
+            return false;
         } else {
-            return this->createLabel(std::string(c, c != ' '), top);
+            return this->addLine(lines, c == " " ? "" : std::string(c));
         }
     });
 }
 
-void SimpleTextArea::updateLinesCutoffWrap() {
-    this->charIteration([this](CCLabelBMFont* line, char c, float top) {
-        const std::string& text = line->getString();
-        const char back = text.back();
-        const bool lastIsSpace = back == ' ';
-        CCLabelBMFont* newLine = this->createLabel(std::string(!lastIsSpace, back).append(std::string(c != ' ', c)), top);
+std::vector<std::string> SimpleTextArea::updateLinesCutoffWrap() {
+    return this->charIteration([this](std::vector<std::string>& lines, std::string_view c) {
+        const std::string text = lines.back();
+        if (text.empty()) {
+            return this->addLine(lines, c == " " ? "" : std::string(c));
+        }
+
+        // Find where the last character starts, it may be more than one byte
+        size_t lastStart = text.size() - 1;
+        while (lastStart > 0 && (static_cast<unsigned char>(text[lastStart]) & 0xc0) == 0x80) {
+            lastStart -= 1;
+        }
+        const std::string back = text.substr(lastStart);
+        const bool lastIsSpace = back == " ";
 
-        if (newLine == nullptr && !lastIsSpace) {
-            if (text[text.size() - 2] == ' ') {
-                line->setString(text.substr(0, text.size() - 1).c_str());
+        if (!this->addLine(lines, (lastIsSpace ? "" : back).append(c == " " ? "" : c))) {
+            return false;
+        }
+
+        // Move the last character over to the new line, hyphenating the word 
+        // if it got cut in the middle
+        if (!lastIsSpace) {
+            std::string& prev = lines[lines.size() - 2];
+            if (lastStart > 0 && text[lastStart - 1] == ' ') {
+                prev = text.substr(0, lastStart);
             } else {
-                line->setString((text.substr(0, text.size() - 1) + '-').c_str());
+                prev = text.substr(0, lastStart) + '-';
             }
         }
 
-        return newLine;
+        return true;
     });
 }
 
 void SimpleTextArea::updateContainer() {
+    std::vector<std::string> lines;
+
     switch (m_wrappingMode) {
         case NO_WRAP: {
-            this->updateLinesNoWrap();
+            lines = this->updateLinesNoWrap();
         } break;
         case WORD_WRAP: {
-            this->updateLinesWordWrap(false);
+            lines = this->updateLinesWordWrap(false);
         } break;
         case SPACE_WRAP: {
-            this->updateLinesWordWrap(true);
+            lines = this->updateLinesWordWrap(true);
         } break;
         case CUTOFF_WRAP: {
-            this->updateLinesCutoffWrap();
+            lines = this->updateLinesCutoffWrap();
         } break;
     }
+
+    // Every line break is known at this point, so each label only needs to 
+    // be created once with its final string
+    float top = 0;
+    m_lines.clear();
+
+    for (const std::string& text : lines) {
+        CCLabelBMFont* line = this->createLabel(text, top);
+
+        top -= this->calculateOffset(line);
+        m_lines.push_back(line);
+    }
     
     const size_t lineCount = m_lines.size();
     const float width = this->getWidth();
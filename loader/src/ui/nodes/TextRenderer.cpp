@@ -2,6 +2,7 @@
 #include <Geode/utils/casts.hpp>
 #include <Geode/utils/cocos.hpp>
 #include <Geode/utils/string.hpp>
+#include "LineBreaker.hpp"
 
 using namespace geode::prelude;
 using namespace std::string_literals;
@@ -336,7 +337,10 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
     if (!target) target = m_target;
 
     Label label;
-    bool newLine = true;
+    // metrics for measuring text without creating labels, if the font is a 
+    // CCLabelBMFont
+    std::optional<BMFontMetrics> metrics;
+    float metricsScale = 1.f;
 
     auto lastIndent =
         m_indentationStack.size() > 1 ? m_indentationStack.at(m_indentationStack.size() - 1) : .0f;
@@ -349,7 +353,15 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
         // create label through font and add
         // decorations (underline, strikethrough) +
         // buttonize (new word just dropped)
-        label = this->addWrappers(font(style), isButton, target, callback);
+        auto raw = font(style);
+        label = this->addWrappers(raw, isButton, target, callback);
+
+        if (!metrics) {
+            metrics = BMFontMetrics::from(typeinfo_cast<CCLabelBMFont*>(raw.m_node));
+            // wrappers size themselves after the scaled size of the label 
+            // they wrap, and only the outermost node gets scaled
+            metricsScale = label.m_node == raw.m_node ? scale : scale * raw.m_node->getScale();
+        }
 
         label.m_node->setScale(scale);
         label.m_node->setPosition(m_cursor);
@@ -369,58 +381,47 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
     auto nextLine = [&]() -> bool {
         this->breakLine(label.m_lineHeight * scale);
         if (!createLabel()) return false;
-        newLine = true;
         return true;
     };
 
     // create initial label
     if (!createLabel()) return {};
 
+    auto text = str;
+    switch (caps) {
+        case TextCapitalization::AllUpper: utils::string::toUpperIP(text); break;
+        case TextCapitalization::AllLower: utils::string::toLowerIP(text); break;
+        default: break;
+    }
+
+    // figure out where all the lines break first, so every label only has its 
+    // string set once
+    auto measure = [&](std::string_view str) -> float {
+        if (metrics) {
+            return metrics->measure(str) * metricsScale;
+        }
+        // not a bitmap font, so the only way to know is to ask the label
+        label.m_labelProtocol->setString(std::string(str).c_str());
+        return label.m_node->getScaledContentSize().width;
+    };
+    float lineWidth = 0.f;
+    float firstLineWidth = 0.f;
+    if (m_size.width) {
+        auto maxX = m_size.width - this->getCurrentWrapOffset();
+        firstLineWidth = maxX - m_cursor.x;
+        lineWidth = maxX - m_origin.x;
+    }
+    auto lines = text.empty() ? std::vector<std::string>() : breakLines(text, measure, firstLineWidth, lineWidth);
+
     bool firstLine = true;
-    for (auto line : utils::string::split(str, "\n")) {
+    for (auto& line : lines) {
         if (!firstLine && !nextLine()) {
             return {};
         }
         firstLine = false;
-        for (auto word : utils::string::split(line, " ")) {
-            // add extra space in front of word if not on
-            // new line
-            if (!newLine) word = " " + word;
-            newLine = false;
-
-            // update capitalization
-            switch (caps) {
-                case TextCapitalization::AllUpper: utils::string::toUpperIP(word); break;
-                case TextCapitalization::AllLower: utils::string::toLowerIP(word); break;
-                default: break;
-            }
-
-            // try to render at the end of current line
-            if (this->render(word, label.m_node, label.m_labelProtocol)) continue;
-
-            // try to create a new line
-            if (!nextLine()) return {};
-
-            if (utils::string::startsWith(word, " ")) word = word.substr(1);
-            newLine = false;
-
-            // try to render on new line
-            if (this->render(word, label.m_node, label.m_labelProtocol)) continue;
-
-            // no need to create a new line as we know
-            // the current one has no content and is
-            // supposed to receive this one
-
-            // render character by character
-            for (auto& c : word) {
-                if (!this->render(std::string(1, c), label.m_node, label.m_labelProtocol)) {
-                    if (!nextLine()) return {};
-
-                    if (utils::string::startsWith(word, " ")) word = word.substr(1);
-                    newLine = false;
-                }
-            }
-        }
+        label.m_labelProtocol->setString(line.c_str());
+    }
+    if (lines.size()) {
         // increment cursor position
         m_cursor.x += label.m_node->getScaledContentSize().width;
     }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Geode/DefaultInclude.hpp>
+#include <cocos2d.h>
+#include <vector>
+
+using namespace geode::prelude;
+
+/**
+ * Visit a scrolling content layer while skipping its children that are
+ * entirely outside of the area shown by the parent. Culled children are
+ * only hidden for the duration of the visit, so visibility set by whoever
+ * owns them is left alone.
+ * Children with no area (like plain container nodes) are never culled,
+ * since their own children could be anywhere
+ * @param contentLayer The layer whose children should be culled
+ * @param viewSize Size of the clipping area in the content layer's parent
+ * @param visit Function that does the actual visiting
+ * @returns The number of children that were culled
+ */
+template <class Visit>
+size_t visitWithViewportCulling(CCNode* contentLayer, CCSize const& viewSize, Visit&& visit) {
+    auto children = contentLayer->getChildren();
+    if (!children || !children->count()) {
+        visit();
+        return 0;
+    }
+
+    auto visibleRect = CCRectApplyAffineTransform(
+        CCRect(CCPointZero, viewSize), contentLayer->parentToNodeTransform()
+    );
+
+    std::vector<CCNode*> culled;
+    for (auto child : CCArrayExt<CCNode*>(children)) {
+        if (!child->isVisible()) continue;
+        // boundingBox only uses the transform the node has cached since it 
+        // was last moved, so this is cheap to do every frame
+        auto box = child->boundingBox();
+        if (box.size.width <= 0.f || box.size.height <= 0.f) continue;
+        if (!visibleRect.intersectsRect(box)) {
+            // Skip any setVisible overrides since this is only temporary
+            child->CCNode::setVisible(false);
+            culled.push_back(child);
+        }
+    }
+
+    visit();
+
+    for (auto child : culled) {
+        child->CCNode::setVisible(true);
+    }
+    return culled.size();
+}
@@ -13,19 +13,23 @@
 #include <mz_zip.h>
 #include <internal/FileWatcher.hpp>
 #include <Geode/utils/ranges.hpp>
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <span>
+#include <thread>
+#include <unordered_map>
 
 #ifdef GEODE_IS_WINDOWS
 #include <filesystem>
-#endif
-
-#if defined(GEODE_IS_ANDROID) || defined(GEODE_IS_MACOS)
-struct path_hash_t {
-    std::size_t operator()(std::filesystem::path const& path) const noexcept {
-        return std::filesystem::hash_value(path);
-    }
-};
 #else
-using path_hash_t = std::hash<std::filesystem::path>;
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 using namespace geode::prelude;
@@ -158,136 +162,353 @@ Result<std::vector<std::filesystem::path>> utils::file::readDirectory(
 
 // Unzip
 
-static constexpr auto MAX_ENTRY_PATH_LEN = 256;
+static constexpr size_t EOCD_SIZE = 22;
+static constexpr size_t ZIP64_EOCD_LOCATOR_SIZE = 20;
+static constexpr size_t ZIP64_EOCD_SIZE = 56;
+static constexpr size_t CENTRAL_HEADER_SIZE = 46;
+static constexpr size_t LOCAL_HEADER_SIZE = 30;
+static constexpr uint32_t EOCD_SIGNATURE = 0x06054b50;
+static constexpr uint32_t ZIP64_EOCD_LOCATOR_SIGNATURE = 0x07064b50;
+static constexpr uint32_t ZIP64_EOCD_SIGNATURE = 0x06064b50;
+static constexpr uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static constexpr uint16_t ZIP64_EXTRA_ID = 0x0001;
+static constexpr uint16_t FLAG_ENCRYPTED = 0x1;
+static constexpr uint16_t METHOD_STORED = 0;
+static constexpr uint16_t METHOD_DEFLATED = 8;
+// Deflate can't compress better than this, so anything claiming more is 
+// corrupted (and would have us allocate a huge buffer for nothing)
+static constexpr uint64_t MAX_DEFLATE_RATIO = 1032;
+// Extracting fewer files than this per thread isn't worth starting it for
+static constexpr size_t MIN_FILES_PER_WORKER = 16;
+
+static uint16_t read16(uint8_t const* data) {
+    return data[0] | (data[1] << 8);
+}
+static uint32_t read32(uint8_t const* data) {
+    return read16(data) | (static_cast<uint32_t>(read16(data + 2)) << 16);
+}
+static uint64_t read64(uint8_t const* data) {
+    return read32(data) | (static_cast<uint64_t>(read32(data + 4)) << 32);
+}
+
+// Entry names in zips always use forward slashes
+static std::string toEntryName(std::filesystem::path const& path) {
+    auto str = path.generic_u8string();
+    return std::string(reinterpret_cast<const char*>(str.data()), str.size());
+}
+
+static Result<> writeSpan(std::filesystem::path const& path, std::span<const uint8_t> data) {
+    std::ofstream file;
+#if _WIN32
+    file.open(path.wstring(), std::ios::out | std::ios::binary);
+#else
+    file.open(path.string(), std::ios::out | std::ios::binary);
+#endif
+    if (!file.is_open()) {
+        return Err("Unable to open file");
+    }
+    file.write(reinterpret_cast<char const*>(data.data()), data.size());
+    file.close();
+    if (!file) {
+        return Err("Unable to write file");
+    }
+    return Ok();
+}
+
+static Result<> inflateInto(std::span<const uint8_t> input, std::span<uint8_t> output) {
+    // zlib counts bytes in uInts, and no mod ships entries this big anyway
+    constexpr auto MAX_SIZE = std::numeric_limits<uInt>::max();
+    if (input.size() > MAX_SIZE || output.size() > MAX_SIZE) {
+        return Err("Entry is too large");
+    }
+    z_stream stream {};
+    // Zip entries are raw deflate streams without the zlib header
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return Err("Unable to initialize inflate");
+    }
+    stream.next_in = const_cast<Bytef*>(input.data());
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = output.data();
+    stream.avail_out = static_cast<uInt>(output.size());
+    auto code = inflate(&stream, Z_FINISH);
+    auto written = stream.total_out;
+    inflateEnd(&stream);
+    if (code != Z_STREAM_END || written != output.size()) {
+        return Err("Unable to inflate entry (code {})", code);
+    }
+    return Ok();
+}
 
-struct ZipEntry {
-    bool isDirectory;
-    int64_t compressedSize;
-    int64_t uncompressedSize;
+/**
+ * A read-only view of a whole file mapped into memory, so its contents can 
+ * be used in place instead of being read into buffers first
+ */
+class MappedFile final {
+private:
+    uint8_t const* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef GEODE_IS_WINDOWS
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    static Result<std::unique_ptr<MappedFile>> open(std::filesystem::path const& path) {
+        auto ret = std::make_unique<MappedFile>();
+#ifdef GEODE_IS_WINDOWS
+        ret->m_file = CreateFileW(
+            path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+        );
+        if (ret->m_file == INVALID_HANDLE_VALUE) {
+            return Err("Unable to open file");
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(ret->m_file, &size)) {
+            return Err("Unable to get file size");
+        }
+        ret->m_size = static_cast<size_t>(size.QuadPart);
+        // Empty files can't be mapped (and aren't zips anyway)
+        if (ret->m_size == 0) {
+            return Err("File is empty");
+        }
+        ret->m_mapping = CreateFileMappingW(ret->m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!ret->m_mapping) {
+            return Err("Unable to map file");
+        }
+        ret->m_data = static_cast<uint8_t const*>(MapViewOfFile(ret->m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!ret->m_data) {
+            return Err("Unable to map file");
+        }
+#else
+        auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return Err("Unable to open file");
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return Err("Unable to get file size");
+        }
+        ret->m_size = static_cast<size_t>(info.st_size);
+        if (ret->m_size == 0) {
+            ::close(fd);
+            return Err("File is empty");
+        }
+        auto data = mmap(nullptr, ret->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return Err("Unable to map file");
+        }
+        ret->m_data = static_cast<uint8_t const*>(data);
+#endif
+        return Ok(std::move(ret));
+    }
+
+    std::span<const uint8_t> data() const {
+        return { m_data, m_size };
+    }
+
+    ~MappedFile() {
+#ifdef GEODE_IS_WINDOWS
+        if (m_data) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_file);
+        }
+#else
+        if (m_data) {
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+#endif
+    }
 };
 
-class Zip::Impl final {
+class Unzip::Impl final {
 public:
-    using Path = Zip::Path;
+    using Path = Unzip::Path;
+
+    struct Entry {
+        std::string name;
+        uint16_t flags;
+        uint16_t method;
+        uint64_t compressedSize;
+        uint64_t size;
+        uint64_t headerOffset;
+
+        bool isDirectory() const {
+            return name.ends_with('/') || name.ends_with('\\');
+        }
+    };
 
 private:
-    void* m_handle = nullptr;
-    void* m_stream = nullptr;
-    int32_t m_mode;
-    std::variant<Path, ByteVector> m_srcDest;
-    std::unordered_map<Path, ZipEntry, path_hash_t> m_entries;
+    Path m_path;
+    std::unique_ptr<MappedFile> m_file;
+    ByteVector m_memory;
+    std::span<const uint8_t> m_data;
+    // Sorted by name so lookups are a binary search over one allocation
+    std::vector<Entry> m_entries;
     std::function<void(uint32_t, uint32_t)> m_progressCallback;
+    size_t m_maxWorkerCount = 0;
 
-    Result<> init() {
-        // open stream from file
-        if (std::holds_alternative<Path>(m_srcDest)) {
-            auto& path = std::get<Path>(m_srcDest);
-            // open file
-            m_stream = mz_stream_os_create();
-            if (!m_stream) {
-                return Err("Unable to open file");
-            }
-            if (mz_stream_os_open(
-                m_stream,
-                reinterpret_cast<const char*>(path.u8string().c_str()),
-                m_mode
-            ) != MZ_OK) {
-                return Err("Unable to read file");
+    Result<> readDirectory() {
+        auto data = m_data;
+        if (data.size() < EOCD_SIZE) {
+            return Err("File is too small to be a zip");
+        }
+
+        // The end of central directory record may be followed by a comment of 
+        // up to 65535 bytes, so search backwards for it
+        std::optional<size_t> eocd;
+        size_t lowest = data.size() > EOCD_SIZE + 0xFFFF ? data.size() - EOCD_SIZE - 0xFFFF : 0;
+        for (size_t i = data.size() - EOCD_SIZE + 1; i-- > lowest;) {
+            auto record = data.data() + i;
+            if (read32(record) == EOCD_SIGNATURE && i + EOCD_SIZE + read16(record + 20) <= data.size()) {
+                eocd = i;
+                break;
             }
         }
-        // open stream from memory stream
-        else {
-            auto& src = std::get<ByteVector>(m_srcDest);
-            m_stream = mz_stream_mem_create();
-            if (!m_stream) {
-                return Err("Unable to create memory stream");
+        if (!eocd) {
+            return Err("End of central directory not found");
+        }
+        auto record = data.data() + *eocd;
+        uint64_t count = read16(record + 10);
+        uint64_t size = read32(record + 12);
+        uint64_t offset = read32(record + 16);
+
+        // Zip64 archives keep the real values in another record before this one
+        if (count == 0xFFFF || size == 0xFFFFFFFF || offset == 0xFFFFFFFF) {
+            if (*eocd < ZIP64_EOCD_LOCATOR_SIZE) {
+                return Err("Zip64 end of central directory not found");
             }
-            // mz_stream_mem_set_buffer doesn't memcpy so we gotta store the data 
-            // elsewhere
-            if (m_mode == MZ_OPEN_MODE_READ) {
-                mz_stream_mem_set_buffer(m_stream, src.data(), src.size());
+            auto locator = record - ZIP64_EOCD_LOCATOR_SIZE;
+            if (read32(locator) != ZIP64_EOCD_LOCATOR_SIGNATURE) {
+                return Err("Zip64 end of central directory not found");
             }
-            else {
-                mz_stream_mem_set_grow_size(m_stream, 128 * 1024);
+            auto recordOffset = read64(locator + 8);
+            if (data.size() < ZIP64_EOCD_SIZE || recordOffset > data.size() - ZIP64_EOCD_SIZE) {
+                return Err("Zip64 end of central directory is out of bounds");
             }
-            if (mz_stream_open(m_stream, nullptr, m_mode) != MZ_OK) {
-                return Err("Unable to read memory stream");
+            auto record64 = data.data() + recordOffset;
+            if (read32(record64) != ZIP64_EOCD_SIGNATURE) {
+                return Err("Invalid zip64 end of central directory");
             }
+            count = read64(record64 + 32);
+            size = read64(record64 + 40);
+            offset = read64(record64 + 48);
         }
-
-        // open zip
-        m_handle = mz_zip_create();
-        if (!m_handle) {
-            return Err("Unable to create zip handler");
-        }
-        if (mz_zip_open(m_handle, m_stream, m_mode) != MZ_OK) {
-            return Err("Unable to open zip");
+        if (offset > data.size() || size > data.size() - offset) {
+            return Err("Central directory is out of bounds");
         }
 
-        // get list of entries
-        if (!this->loadEntries()) {
-            return Err("Unable to read zip");
+        m_entries.reserve(std::min<uint64_t>(count, size / CENTRAL_HEADER_SIZE));
+        auto pos = offset;
+        auto end = offset + size;
+        while (pos < end) {
+            if (end - pos < CENTRAL_HEADER_SIZE) {
+                return Err("Central directory is truncated");
+            }
+            auto header = data.data() + pos;
+            if (read32(header) != CENTRAL_HEADER_SIGNATURE) {
+                return Err("Invalid central directory entry");
+            }
+            size_t nameLength = read16(header + 28);
+            size_t extraLength = read16(header + 30);
+            auto next = pos + CENTRAL_HEADER_SIZE + nameLength + extraLength + read16(header + 32);
+            if (next > end) {
+                return Err("Central directory is truncated");
+            }
+            auto name = reinterpret_cast<const char*>(header + CENTRAL_HEADER_SIZE);
+            Entry entry {
+                .name = std::string(name, nameLength),
+                .flags = read16(header + 8),
+                .method = read16(header + 10),
+                .compressedSize = read32(header + 20),
+                .size = read32(header + 24),
+                .headerOffset = read32(header + 42),
+            };
+
+            // Values that don't fit in 32 bits are moved to the zip64 extra 
+            // field, in this order
+            auto extra = header + CENTRAL_HEADER_SIZE + nameLength;
+            auto extraEnd = extra + extraLength;
+            while (extraEnd - extra >= 4) {
+                auto id = read16(extra);
+                auto field = extra + 4;
+                auto fieldEnd = field + read16(extra + 2);
+                if (fieldEnd > extraEnd) {
+                    break;
+                }
+                if (id == ZIP64_EXTRA_ID) {
+                    for (auto value : { &entry.size, &entry.compressedSize, &entry.headerOffset }) {
+                        if (*value == 0xFFFFFFFF && fieldEnd - field >= 8) {
+                            *value = read64(field);
+                            field += 8;
+                        }
+                    }
+                    break;
+                }
+                extra = fieldEnd;
+            }
+
+            m_entries.push_back(std::move(entry));
+            pos = next;
         }
 
+        // Stable so the first of any duplicate names is the one found
+        std::stable_sort(m_entries.begin(), m_entries.end(), [](auto const& a, auto const& b) {
+            return a.name < b.name;
+        });
         return Ok();
     }
 
-    bool loadEntries() {
-        uint64_t entryCount;
-        if (mz_zip_get_number_entry(m_handle, &entryCount) != MZ_OK) {
-            return false;
+    Result<std::span<const uint8_t>> getEntryData(Entry const& entry) const {
+        if (entry.flags & FLAG_ENCRYPTED) {
+            return Err("Encrypted entries are not supported");
         }
-        auto err = mz_zip_goto_first_entry(m_handle) != MZ_OK;
-        while (err == MZ_OK) {
-            mz_zip_file* info = nullptr;
-            if (mz_zip_entry_get_info(m_handle, &info) != MZ_OK) {
-                return false;
-            }
-
-            Path filePath;
-            filePath.assign(info->filename, info->filename + info->filename_size);
-            m_entries.insert({ filePath, ZipEntry {
-                .isDirectory = mz_zip_entry_is_dir(m_handle) == MZ_OK,
-                .compressedSize = info->compressed_size,
-                .uncompressedSize = info->uncompressed_size,
-            } });
-
-            err = mz_zip_goto_next_entry(m_handle);
+        auto data = m_data;
+        if (entry.headerOffset > data.size() || data.size() - entry.headerOffset < LOCAL_HEADER_SIZE) {
+            return Err("Entry is out of bounds");
         }
-        return true;
-    }
-
-    static Result<> mzTry(int32_t code) {
-        if (code == MZ_OK) {
-            return Ok();
+        auto header = data.data() + entry.headerOffset;
+        if (read32(header) != LOCAL_HEADER_SIGNATURE) {
+            return Err("Invalid local header");
         }
-        else {
-            return Err(std::to_string(code));
+        // The local header's name and extra field don't have to match the 
+        // central directory's, so its own lengths are used to skip them
+        auto start = entry.headerOffset + LOCAL_HEADER_SIZE + read16(header + 26) + read16(header + 28);
+        if (start > data.size() || entry.compressedSize > data.size() - start) {
+            return Err("Entry is out of bounds");
         }
+        return Ok(data.subspan(start, entry.compressedSize));
     }
 
 public:
-    static Result<std::unique_ptr<Impl>> inFile(Path const& path, int32_t mode) {
+    static Result<std::unique_ptr<Impl>> inFile(Path const& path) {
         auto ret = std::make_unique<Impl>();
-        ret->m_mode = mode;
-        ret->m_srcDest = path;
-        GEODE_UNWRAP(ret->init());
+        ret->m_path = path;
+        GEODE_UNWRAP_INTO(auto file, MappedFile::open(path));
+        ret->m_file = std::move(file);
+        ret->m_data = ret->m_file->data();
+        GEODE_UNWRAP(ret->readDirectory());
         return Ok(std::move(ret));
     }
 
     static Result<std::unique_ptr<Impl>> fromMemory(ByteVector const& raw) {
         auto ret = std::make_unique<Impl>();
-        ret->m_mode = MZ_OPEN_MODE_READ;
-        ret->m_srcDest = raw;
-        GEODE_UNWRAP(ret->init());
-        return Ok(std::move(ret));
-    }
-
-    static Result<std::unique_ptr<Impl>> intoMemory() {
-        auto ret = std::make_unique<Impl>();
-        ret->m_mode = MZ_OPEN_MODE_CREATE;
-        ret->m_srcDest = ByteVector();
-        GEODE_UNWRAP(ret->init());
+        ret->m_memory = raw;
+        ret->m_data = ret->m_memory;
+        GEODE_UNWRAP(ret->readDirectory());
         return Ok(std::move(ret));
     }
 
@@ -295,69 +516,112 @@ public:
         m_progressCallback = callback;
     }
 
-    Result<> extractAt(Path const& dir, Path const& name) {
-        auto entry = m_entries.at(name);
+    void setMaxWorkerCount(size_t count) {
+        m_maxWorkerCount = count;
+    }
 
-        GEODE_UNWRAP(
-            mzTry(mz_zip_entry_read_open(m_handle, 0, nullptr))
-            .mapErr([&](auto error) {
-                return fmt::format("Unable to open entry (code {})", error);
-            })
+    Entry const* find(Path const& name) const {
+        auto str = toEntryName(name);
+        auto it = std::lower_bound(
+            m_entries.begin(), m_entries.end(), str,
+            [](Entry const& entry, std::string const& name) {
+                return entry.name < name;
+            }
         );
+        if (it == m_entries.end() || it->name != str) {
+            return nullptr;
+        }
+        return &*it;
+    }
 
-        // if the file is empty, its data is empty (duh)
-        if (!entry.uncompressedSize) {
-            return Ok();
+    Result<Entry const*> findFile(Path const& name) const {
+        auto entry = this->find(name);
+        if (!entry) {
+            return Err("Entry not found");
+        }
+        if (entry->isDirectory()) {
+            return Err("Entry is directory");
         }
+        return Ok(entry);
+    }
 
-        ByteVector res;
-        res.resize(entry.uncompressedSize);
-        auto read = mz_zip_entry_read(m_handle, res.data(), entry.uncompressedSize);
-        if (read < 0) {
-            mz_zip_entry_close(m_handle);
-            return Err("Unable to read entry (code " + std::to_string(read) + ")");
+    std::vector<Entry> const& getEntries() const {
+        return m_entries;
+    }
+
+    Result<std::span<const uint8_t>> view(Entry const& entry) const {
+        if (entry.method != METHOD_STORED) {
+            return Err("Entry is compressed");
         }
+        GEODE_UNWRAP_INTO(auto data, this->getEntryData(entry));
+        if (data.size() != entry.size) {
+            return Err("Entry has mismatched sizes");
+        }
+        return Ok(data);
+    }
 
-        mz_zip_entry_close(m_handle);
+    Result<> extractInto(Entry const& entry, std::span<uint8_t> buffer) const {
+        if (buffer.size() != entry.size) {
+            return Err("Buffer is {} bytes but the entry is {}", buffer.size(), entry.size);
+        }
+        GEODE_UNWRAP_INTO(auto data, this->getEntryData(entry));
+        switch (entry.method) {
+            case METHOD_STORED: {
+                if (data.size() != entry.size) {
+                    return Err("Entry has mismatched sizes");
+                }
+                std::copy(data.begin(), data.end(), buffer.begin());
+                return Ok();
+            }
+            case METHOD_DEFLATED: {
+                // if the file is empty, its data is empty (duh)
+                if (buffer.empty()) {
+                    return Ok();
+                }
+                return inflateInto(data, buffer);
+            }
+            default: {
+                return Err("Unsupported compression method {}", entry.method);
+            }
+        }
+    }
 
-        GEODE_UNWRAP(file::createDirectoryAll((dir / name).parent_path()));
-        GEODE_UNWRAP(file::writeBinary(dir / name, res).mapErr([&](auto error) {
-            return fmt::format("Unable to write to {}: {}", dir / name, error);
-        }));
+    Result<ByteVector> extract(Entry const& entry) const {
+        if (entry.method == METHOD_DEFLATED && entry.size / MAX_DEFLATE_RATIO > entry.compressedSize) {
+            return Err("Entry has an invalid size");
+        }
+        if (entry.method == METHOD_STORED) {
+            GEODE_UNWRAP_INTO(auto data, this->view(entry));
+            return Ok(ByteVector(data.begin(), data.end()));
+        }
+        ByteVector res(entry.size);
+        GEODE_UNWRAP(this->extractInto(entry, res));
+        return Ok(std::move(res));
+    }
 
-        return Ok();
+    Result<> extractTo(Entry const& entry, Path const& path) const {
+        // Stored entries are written straight from the mapping
+        if (entry.method == METHOD_STORED) {
+            GEODE_UNWRAP_INTO(auto data, this->view(entry));
+            return writeSpan(path, data);
+        }
+        GEODE_UNWRAP_INTO(auto data, this->extract(entry));
+        return writeSpan(path, data);
     }
 
     Result<> extractAllTo(Path const& dir) {
         GEODE_UNWRAP(file::createDirectoryAll(dir));
 
-        GEODE_UNWRAP(
-            mzTry(mz_zip_goto_first_entry(m_handle))
-            .mapErr([&](auto error) {
-                return fmt::format("Unable to navigate to first entry (code {})", error);
-            })
-        );
-
-        uint64_t numEntries;
-
-        GEODE_UNWRAP(
-            mzTry(mz_zip_get_number_entry(m_handle, &numEntries))
-            .mapErr([&](auto error) {
-                return fmt::format("Unable to get number of entries (code {})", error);
-            })
-        );
-
-        uint32_t currentEntry = 0;
-        // while not at MZ_END_OF_LIST
-        do {
-            mz_zip_file* info = nullptr;
-            if (mz_zip_entry_get_info(m_handle, &info) != MZ_OK) {
-                return Err("Unable to get entry info");
-            }
-            currentEntry++;
-
-            Path filePath;
-            filePath.assign(info->filename, info->filename + info->filename_size);
+        // Check every entry and create all of the directories first, so 
+        // writing the files can be split between threads without them 
+        // racing to create the same folders. Entries that end up at the same 
+        // path are only written once, or two threads could be writing the 
+        // same file at the same time
+        std::vector<std::pair<Entry const*, Path>> files;
+        std::unordered_map<std::string, size_t> fileIndices;
+        std::set<Path> directories;
+        for (auto& entry : m_entries) {
+            Path filePath = std::u8string(entry.name.begin(), entry.name.end());
 
             // make sure zip files like root/../../file.txt don't get extracted to 
             // avoid zip attacks
@@ -366,14 +630,26 @@ public:
 #else
             if (!std::filesystem::relative(dir / filePath, dir).empty()) {
 #endif
-                if (m_entries.at(filePath).isDirectory) {
-                    GEODE_UNWRAP(file::createDirectoryAll(dir / filePath));
+                if (entry.isDirectory()) {
+                    directories.insert(dir / filePath);
                 }
                 else {
-                    GEODE_UNWRAP(this->extractAt(dir, filePath));
-                }
-                if (m_progressCallback) {
-                    m_progressCallback(currentEntry, numEntries);
+                    directories.insert((dir / filePath).parent_path());
+                    auto key = toEntryName((dir / filePath).lexically_normal());
+#if defined(GEODE_IS_WINDOWS) || defined(GEODE_IS_MACOS)
+                    // These filesystems are case-insensitive by default
+                    utils::string::toLowerIP(key);
+#endif
+                    // Extracting serially would have left the last one on 
+                    // disk, so that's the one that gets written
+                    auto [it, inserted] = fileIndices.try_emplace(key, files.size());
+                    if (inserted) {
+                        files.push_back({ &entry, dir / filePath });
+                    }
+                    else {
+                        log::warn("Zip entry '{}' overwrites an earlier entry", dir / filePath);
+                        files[it->second] = { &entry, dir / filePath };
+                    }
                 }
             }
             else {
@@ -382,147 +658,104 @@ public:
                     dir / filePath
                 );
             }
-        } while (mz_zip_goto_next_entry(m_handle) == MZ_OK);
-
-        return Ok();
-    }
-
-    Result<ByteVector> extract(Path const& name) {
-        if (!m_entries.count(name)) {
-            return Err("Entry not found");
         }
-
-        auto entry = m_entries.at(name);
-        if (entry.isDirectory) {
-            return Err("Entry is directory");
+        for (auto& path : directories) {
+            GEODE_UNWRAP(file::createDirectoryAll(path));
         }
 
-        GEODE_UNWRAP(
-            mzTry(mz_zip_goto_first_entry(m_handle))
-            .mapErr([&](auto error) {
-                return fmt::format("Unable to navigate to first entry (code {})", error);
-            })
-        );
-
-        GEODE_UNWRAP(
-            mzTry(mz_zip_locate_entry(
-                m_handle,
-                reinterpret_cast<const char*>(name.u8string().c_str()),
-                1
-            ))
-            .mapErr([&](auto error) {
-                return fmt::format("Unable to locate entry (code {})", error);
-            })
+        // Directories, duplicates and skipped entries count as done for the 
+        // progress
+        auto total = static_cast<uint32_t>(m_entries.size());
+        auto skipped = static_cast<uint32_t>(m_entries.size() - files.size());
+
+        // One worker per MIN_FILES_PER_WORKER files, up to one per hardware 
+        // thread. Small zips (like most mods) end up with a single worker, in 
+        // which case everything is just extracted on this thread
+        auto workerCount = std::min<size_t>(
+            m_maxWorkerCount ? m_maxWorkerCount : std::thread::hardware_concurrency(),
+            files.size() / MIN_FILES_PER_WORKER
         );
+        if (workerCount <= 1) {
+            for (size_t i = 0; i < files.size(); i++) {
+                auto& [entry, path] = files[i];
+                GEODE_UNWRAP(this->extractTo(*entry, path).mapErr([&](auto error) {
+                    return fmt::format("Unable to write to {}: {}", path, error);
+                }));
+                if (m_progressCallback) {
+                    m_progressCallback(skipped + i + 1, total);
+                }
+            }
+            return Ok();
+        }
 
-        GEODE_UNWRAP(
-            mzTry(mz_zip_entry_read_open(m_handle, 0, nullptr))
-            .mapErr([&](auto error) {
-                return fmt::format("Unable to open entry (code {})", error);
-            })
-        );
+        // Workers take the next file off a shared counter, so a few large 
+        // entries don't hold up one thread while the others sit idle
+        std::atomic_size_t next = 0;
+        std::atomic_bool failed = false;
+        std::mutex lock;
+        std::condition_variable changed;
+        size_t finished = 0;
+        size_t running = workerCount;
+        std::optional<std::string> error;
+
+        auto work = [&] {
+            utils::thread::setName("Unzip Worker");
+            while (!failed) {
+                auto i = next++;
+                if (i >= files.size()) {
+                    break;
+                }
+                auto& [entry, path] = files[i];
+                auto res = this->extractTo(*entry, path);
 
-        // if the file is empty, its data is empty (duh)
-        if (!entry.uncompressedSize) {
-            return Ok(ByteVector());
+                std::lock_guard guard(lock);
+                if (res.isErr() && !error) {
+                    error = fmt::format("Unable to write to {}: {}", path, res.unwrapErr());
+                    failed = true;
+                }
+                finished += 1;
+                changed.notify_one();
+            }
+            std::lock_guard guard(lock);
+            running -= 1;
+            changed.notify_one();
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; i++) {
+            workers.emplace_back(work);
         }
 
-        ByteVector res;
-        res.resize(entry.uncompressedSize);
-        auto read = mz_zip_entry_read(m_handle, res.data(), entry.uncompressedSize);
-        if (read < 0) {
-            mz_zip_entry_close(m_handle);
-            return Err("Unable to read entry (code " + std::to_string(read) + ")");
+        // The progress callback is still only called from this thread. If 
+        // it's slower than the workers, their progress is reported in batches
+        {
+            std::unique_lock guard(lock);
+            size_t reported = 0;
+            while (running > 0) {
+                changed.wait(guard, [&] { return finished != reported || running == 0; });
+                if (finished != reported) {
+                    reported = finished;
+                    if (!error && m_progressCallback) {
+                        guard.unlock();
+                        m_progressCallback(skipped + reported, total);
+                        guard.lock();
+                    }
+                }
+            }
         }
-        mz_zip_entry_close(m_handle);
-
-        return Ok(res);
-    }
-
-    Result<> addFolder(Path const& path) {
-        auto strPath = path.u8string();
-        if (!strPath.ends_with(u8"/") && !strPath.ends_with(u8"\\")) {
-            strPath += u8"/";
+        for (auto& worker : workers) {
+            worker.join();
         }
 
-        mz_zip_file info = { 0 };
-        info.version_madeby = MZ_VERSION_MADEBY;
-        info.compression_method = MZ_COMPRESS_METHOD_DEFLATE;
-        info.filename = reinterpret_cast<const char*>(strPath.c_str());
-        info.uncompressed_size = 0;
-        info.flag = MZ_ZIP_FLAG_UTF8;
-    #ifdef GEODE_IS_WINDOWS
-        info.external_fa = FILE_ATTRIBUTE_DIRECTORY;
-    #endif
-        info.aes_version = MZ_AES_VERSION;
-
-
-        GEODE_UNWRAP(
-            mzTry(mz_zip_entry_write_open(m_handle, &info, MZ_COMPRESS_LEVEL_DEFAULT, 0, nullptr))
-            .mapErr([&](auto error) {
-                return fmt::format("Unable to open entry for writing (code {})", error);
-            })
-        );
-        mz_zip_entry_close(m_handle);
-
-        return Ok();
-    }
-
-    Result<> add(Path const& path, ByteVector const& data) {
-        mz_zip_file info = { 0 };
-        info.version_madeby = MZ_VERSION_MADEBY;
-        info.compression_method = MZ_COMPRESS_METHOD_DEFLATE;
-        info.filename = reinterpret_cast<const char*>(path.u8string().c_str());
-        info.uncompressed_size = data.size();
-        info.aes_version = MZ_AES_VERSION;
-
-        GEODE_UNWRAP(
-            mzTry(mz_zip_entry_write_open(m_handle, &info, MZ_COMPRESS_LEVEL_DEFAULT, 0, nullptr))
-            .mapErr([&](auto error) {
-                return fmt::format("Unable to open entry for writing (code {})", error);
-            })
-        );
-        auto written = mz_zip_entry_write(m_handle, data.data(), data.size());
-        if (written < 0) {
-            mz_zip_entry_close(m_handle);
-            return Err("Unable to write entry data (code " + std::to_string(written) + ")");
+        if (error) {
+            return Err(*error);
         }
-        mz_zip_entry_close(m_handle);
-
         return Ok();
     }
 
-    ByteVector compressedData() const {
-        if (!std::holds_alternative<ByteVector>(m_srcDest)) {
-            return ByteVector();
-        }
-        const uint8_t* buf = nullptr;
-        mz_stream_mem_get_buffer(m_stream, reinterpret_cast<const void**>(&buf));
-        mz_stream_mem_seek(m_stream, 0, MZ_SEEK_END);
-        auto size = mz_stream_mem_tell(m_stream);
-        return ByteVector(buf, buf + size);
-    }
-
     Path getPath() const {
-        if (std::holds_alternative<Path>(m_srcDest)) {
-            return std::get<Path>(m_srcDest);
-        }
-        return Path();
-    }
-
-    std::unordered_map<Path, ZipEntry, path_hash_t> getEntries() const {
-        return m_entries;
-    }
-
-    ~Impl() {
-        if (m_handle) {
-            mz_zip_close(m_handle);
-            mz_zip_delete(&m_handle);
-        }
-        if (m_stream) {
-            mz_stream_close(m_stream);
-            mz_stream_delete(&m_stream);
-        }
+        return m_path;
     }
 };
 
@@ -537,12 +770,12 @@ Unzip::Unzip(Unzip&& other) : m_impl(std::move(other.m_impl)) {
 }
 
 Result<Unzip> Unzip::create(Path const& file) {
-    GEODE_UNWRAP_INTO(auto impl, Zip::Impl::inFile(file, MZ_OPEN_MODE_READ));
+    GEODE_UNWRAP_INTO(auto impl, Unzip::Impl::inFile(file));
     return Ok(Unzip(std::move(impl)));
 }
 
 Result<Unzip> Unzip::create(ByteVector const& data) {
-    GEODE_UNWRAP_INTO(auto impl, Zip::Impl::fromMemory(data));
+    GEODE_UNWRAP_INTO(auto impl, Unzip::Impl::fromMemory(data));
     return Ok(Unzip(std::move(impl)));
 }
 
@@ -556,29 +789,66 @@ void Unzip::setProgressCallback(
     return m_impl->setProgressCallback(callback);
 }
 
+void Unzip::setMaxWorkerCount(size_t count) {
+    return m_impl->setMaxWorkerCount(count);
+}
+
 std::vector<Unzip::Path> Unzip::getEntries() const {
-    return map::keys(m_impl->getEntries());
+    std::vector<Path> res;
+    res.reserve(m_impl->getEntries().size());
+    for (auto& entry : m_impl->getEntries()) {
+        res.push_back(std::u8string(entry.name.begin(), entry.name.end()));
+    }
+    return res;
 }
 
 bool Unzip::hasEntry(Path const& name) {
-    return m_impl->getEntries().count(name);
+    return m_impl->find(name) != nullptr;
+}
+
+Result<size_t> Unzip::getEntrySize(Path const& name) const {
+    GEODE_UNWRAP_INTO(auto entry, m_impl->findFile(name).mapErr([&](auto error) {
+        return fmt::format("Unable to find entry {}: {}", name.string(), error);
+    }));
+    return Ok(static_cast<size_t>(entry->size));
+}
+
+Result<std::span<const uint8_t>> Unzip::view(Path const& name) const {
+    GEODE_UNWRAP_INTO(auto entry, m_impl->findFile(name).mapErr([&](auto error) {
+        return fmt::format("Unable to view entry {}: {}", name.string(), error);
+    }));
+    return m_impl->view(*entry).mapErr([&](auto error) {
+        return fmt::format("Unable to view entry {}: {}", name.string(), error);
+    });
+}
+
+Result<> Unzip::extractInto(Path const& name, std::span<uint8_t> buffer) const {
+    GEODE_UNWRAP_INTO(auto entry, m_impl->findFile(name).mapErr([&](auto error) {
+        return fmt::format("Unable to extract entry {}: {}", name.string(), error);
+    }));
+    return m_impl->extractInto(*entry, buffer).mapErr([&](auto error) {
+        return fmt::format("Unable to extract entry {}: {}", name.string(), error);
+    });
 }
 
 Result<ByteVector> Unzip::extract(Path const& name) {
-    return m_impl->extract(name).mapErr([&](auto error) {
+    GEODE_UNWRAP_INTO(auto entry, m_impl->findFile(name).mapErr([&](auto error) {
+        return fmt::format("Unable to extract entry {}: {}", name.string(), error);
+    }));
+    return m_impl->extract(*entry).mapErr([&](auto error) {
         return fmt::format("Unable to extract entry {}: {}", name.string(), error);
     });
 }
 
 Result<> Unzip::extractTo(Path const& name, Path const& path) {
-    GEODE_UNWRAP_INTO(auto bytes, m_impl->extract(name).mapErr([&](auto error) {
+    GEODE_UNWRAP_INTO(auto entry, m_impl->findFile(name).mapErr([&](auto error) {
         return fmt::format("Unable to extract entry {}: {}", name.string(), error);
     }));
     // create containing directories for target path
     if (path.has_parent_path()) {
         GEODE_UNWRAP(file::createDirectoryAll(path.parent_path()));
     }
-    GEODE_UNWRAP(file::writeBinary(path, bytes).mapErr([&](auto error) {
+    GEODE_UNWRAP(m_impl->extractTo(*entry, path).mapErr([&](auto error) {
         return fmt::format("Unable to write file {}: {}", path.string(), error);
     }));
     return Ok();
@@ -597,7 +867,6 @@ Result<> Unzip::intoDir(
     // removed
     {
         GEODE_UNWRAP_INTO(auto unzip, Unzip::create(from));
-        // TODO: this is quite slow lol, takes 30 seconds to extract index..
         GEODE_UNWRAP(unzip.extractAllTo(to));
     }
     if (deleteZipAfter) {
@@ -625,6 +894,166 @@ Result<> Unzip::intoDir(
 
 // Zip
 
+class Zip::Impl final {
+public:
+    using Path = Zip::Path;
+
+private:
+    void* m_handle = nullptr;
+    void* m_stream = nullptr;
+    int32_t m_mode;
+    std::variant<Path, ByteVector> m_srcDest;
+
+    Result<> init() {
+        // open stream from file
+        if (std::holds_alternative<Path>(m_srcDest)) {
+            auto& path = std::get<Path>(m_srcDest);
+            // open file
+            m_stream = mz_stream_os_create();
+            if (!m_stream) {
+                return Err("Unable to open file");
+            }
+            if (mz_stream_os_open(
+                m_stream,
+                reinterpret_cast<const char*>(path.u8string().c_str()),
+                m_mode
+            ) != MZ_OK) {
+                return Err("Unable to read file");
+            }
+        }
+        // open stream from memory stream
+        else {
+            m_stream = mz_stream_mem_create();
+            if (!m_stream) {
+                return Err("Unable to create memory stream");
+            }
+            mz_stream_mem_set_grow_size(m_stream, 128 * 1024);
+            if (mz_stream_open(m_stream, nullptr, m_mode) != MZ_OK) {
+                return Err("Unable to read memory stream");
+            }
+        }
+
+        // open zip
+        m_handle = mz_zip_create();
+        if (!m_handle) {
+            return Err("Unable to create zip handler");
+        }
+        if (mz_zip_open(m_handle, m_stream, m_mode) != MZ_OK) {
+            return Err("Unable to open zip");
+        }
+
+        return Ok();
+    }
+
+    static Result<> mzTry(int32_t code) {
+        if (code == MZ_OK) {
+            return Ok();
+        }
+        else {
+            return Err(std::to_string(code));
+        }
+    }
+
+public:
+    static Result<std::unique_ptr<Impl>> inFile(Path const& path, int32_t mode) {
+        auto ret = std::make_unique<Impl>();
+        ret->m_mode = mode;
+        ret->m_srcDest = path;
+        GEODE_UNWRAP(ret->init());
+        return Ok(std::move(ret));
+    }
+
+    static Result<std::unique_ptr<Impl>> intoMemory() {
+        auto ret = std::make_unique<Impl>();
+        ret->m_mode = MZ_OPEN_MODE_CREATE;
+        ret->m_srcDest = ByteVector();
+        GEODE_UNWRAP(ret->init());
+        return Ok(std::move(ret));
+    }
+
+    Result<> addFolder(Path const& path) {
+        auto strPath = path.u8string();
+        if (!strPath.ends_with(u8"/") && !strPath.ends_with(u8"\\")) {
+            strPath += u8"/";
+        }
+
+        mz_zip_file info = { 0 };
+        info.version_madeby = MZ_VERSION_MADEBY;
+        info.compression_method = MZ_COMPRESS_METHOD_DEFLATE;
+        info.filename = reinterpret_cast<const char*>(strPath.c_str());
+        info.uncompressed_size = 0;
+        info.flag = MZ_ZIP_FLAG_UTF8;
+    #ifdef GEODE_IS_WINDOWS
+        info.external_fa = FILE_ATTRIBUTE_DIRECTORY;
+    #endif
+        info.aes_version = MZ_AES_VERSION;
+
+
+        GEODE_UNWRAP(
+            mzTry(mz_zip_entry_write_open(m_handle, &info, MZ_COMPRESS_LEVEL_DEFAULT, 0, nullptr))
+            .mapErr([&](auto error) {
+                return fmt::format("Unable to open entry for writing (code {})", error);
+            })
+        );
+        mz_zip_entry_close(m_handle);
+
+        return Ok();
+    }
+
+    Result<> add(Path const& path, ByteVector const& data) {
+        mz_zip_file info = { 0 };
+        info.version_madeby = MZ_VERSION_MADEBY;
+        info.compression_method = MZ_COMPRESS_METHOD_DEFLATE;
+        info.filename = reinterpret_cast<const char*>(path.u8string().c_str());
+        info.uncompressed_size = data.size();
+        info.aes_version = MZ_AES_VERSION;
+
+        GEODE_UNWRAP(
+            mzTry(mz_zip_entry_write_open(m_handle, &info, MZ_COMPRESS_LEVEL_DEFAULT, 0, nullptr))
+            .mapErr([&](auto error) {
+                return fmt::format("Unable to open entry for writing (code {})", error);
+            })
+        );
+        auto written = mz_zip_entry_write(m_handle, data.data(), data.size());
+        if (written < 0) {
+            mz_zip_entry_close(m_handle);
+            return Err("Unable to write entry data (code " + std::to_string(written) + ")");
+        }
+        mz_zip_entry_close(m_handle);
+
+        return Ok();
+    }
+
+    ByteVector compressedData() const {
+        if (!std::holds_alternative<ByteVector>(m_srcDest)) {
+            return ByteVector();
+        }
+        const uint8_t* buf = nullptr;
+        mz_stream_mem_get_buffer(m_stream, reinterpret_cast<const void**>(&buf));
+        mz_stream_mem_seek(m_stream, 0, MZ_SEEK_END);
+        auto size = mz_stream_mem_tell(m_stream);
+        return ByteVector(buf, buf + size);
+    }
+
+    Path getPath() const {
+        if (std::holds_alternative<Path>(m_srcDest)) {
+            return std::get<Path>(m_srcDest);
+        }
+        return Path();
+    }
+
+    ~Impl() {
+        if (m_handle) {
+            mz_zip_close(m_handle);
+            mz_zip_delete(&m_handle);
+        }
+        if (m_stream) {
+            mz_stream_close(m_stream);
+            mz_stream_delete(&m_stream);
+        }
+    }
+};
+
 Zip::Zip() : m_impl(nullptr) {}
 
 Zip::~Zip() {}
@@ -3,16 +3,28 @@
 #include <filesystem>
 #include <fmt/core.h>
 #include <fstream>
+#include <mutex>
 #include <matjson.hpp>
 #include <system_error>
+#include <variant>
 #define CURL_STATICLIB
 #include <curl/curl.h>
 #include <ca_bundle.h>
 
+#include <Geode/loader/Dirs.hpp>
+#include <Geode/utils/JsonValidation.hpp>
 #include <Geode/utils/web.hpp>
+#include <Geode/utils/file.hpp>
 #include <Geode/utils/map.hpp>
+#include <Geode/utils/string.hpp>
 #include <Geode/utils/terminate.hpp>
+#include <date/date.h>
 #include <sstream>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
 
 using namespace geode::prelude;
 using namespace geode::utils::web;
@@ -137,6 +149,9 @@ Result<matjson::Value> WebResponse::json() const {
 ByteVector WebResponse::data() const {
     return m_impl->m_data;
 }
+size_t WebResponse::size() const {
+    return m_impl->m_data.size();
+}
 Result<> WebResponse::into(std::filesystem::path const& path) const {
     return m_impl->into(path);
 }
@@ -189,6 +204,402 @@ std::optional<float> WebProgress::uploadProgress() const {
     return uploadTotal() > 0 ? std::optional(uploaded() * 100.f / uploadTotal()) : std::nullopt;
 }
 
+class MultipartForm::Impl {
+public:
+    struct Part {
+        std::string name;
+        std::optional<std::string> filename;
+        std::optional<std::string> mimeType;
+        // Shared so copying the form doesn't copy the data
+        std::variant<std::shared_ptr<ByteVector const>, std::filesystem::path> content;
+    };
+    std::vector<Part> m_parts;
+};
+
+MultipartForm::MultipartForm() : m_impl(std::make_shared<Impl>()) {}
+
+MultipartForm& MultipartForm::param(std::string_view name, std::string_view value) {
+    m_impl->m_parts.push_back({
+        .name = std::string(name),
+        .content = std::make_shared<ByteVector const>(value.begin(), value.end()),
+    });
+    return *this;
+}
+MultipartForm& MultipartForm::data(std::string_view name, ByteVector data, std::string_view filename, std::string_view mimeType) {
+    m_impl->m_parts.push_back({
+        .name = std::string(name),
+        .filename = std::string(filename),
+        .mimeType = std::string(mimeType),
+        .content = std::make_shared<ByteVector const>(std::move(data)),
+    });
+    return *this;
+}
+MultipartForm& MultipartForm::file(std::string_view name, std::filesystem::path const& path, std::string_view mimeType) {
+    m_impl->m_parts.push_back({
+        .name = std::string(name),
+        .filename = path.filename().string(),
+        .mimeType = std::string(mimeType),
+        .content = path,
+    });
+    return *this;
+}
+
+// Feeds a request body (or one part of a multipart body) to curl in chunks, 
+// from memory or straight from a file
+struct BodyReader {
+    std::shared_ptr<ByteVector const> data;
+    std::ifstream file;
+    size_t size = 0;
+    size_t offset = 0;
+
+    static Result<std::unique_ptr<BodyReader>> create(std::shared_ptr<ByteVector const> data) {
+        auto reader = std::make_unique<BodyReader>();
+        reader->size = data->size();
+        reader->data = std::move(data);
+        return Ok(std::move(reader));
+    }
+    static Result<std::unique_ptr<BodyReader>> create(std::filesystem::path const& path) {
+        auto reader = std::make_unique<BodyReader>();
+        std::error_code ec;
+        reader->size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return Err(fmt::format("Unable to read {}: {}", path.string(), ec.message()));
+        }
+        reader->file.open(path, std::ios::in | std::ios::binary);
+        if (!reader->file.is_open()) {
+            return Err(fmt::format("Unable to open {}", path.string()));
+        }
+        return Ok(std::move(reader));
+    }
+
+    static size_t read(char* buffer, size_t size, size_t nitems, void* ptr) {
+        auto reader = static_cast<BodyReader*>(ptr);
+        auto count = std::min(size * nitems, reader->size - reader->offset);
+        if (reader->data) {
+            std::copy_n(reader->data->data() + reader->offset, count, buffer);
+        }
+        else {
+            reader->file.read(buffer, count);
+            if (static_cast<size_t>(reader->file.gcount()) != count) {
+                return CURL_READFUNC_ABORT;
+            }
+        }
+        reader->offset += count;
+        return count;
+    }
+    // Curl rewinds the body when it has to send it again, for example after 
+    // following a redirect
+    static int seek(void* ptr, curl_off_t offset, int origin) {
+        auto reader = static_cast<BodyReader*>(ptr);
+        if (origin != SEEK_SET || offset < 0 || static_cast<size_t>(offset) > reader->size) {
+            return CURL_SEEKFUNC_FAIL;
+        }
+        if (!reader->data) {
+            reader->file.clear();
+            reader->file.seekg(offset);
+            if (!reader->file) {
+                return CURL_SEEKFUNC_FAIL;
+            }
+        }
+        reader->offset = static_cast<size_t>(offset);
+        return CURL_SEEKFUNC_OK;
+    }
+    static void free(void* ptr) {
+        delete static_cast<BodyReader*>(ptr);
+    }
+};
+
+using HeaderMap = std::unordered_map<std::string, std::vector<std::string>>;
+
+// Every Transfer that is alive; it only dies once nothing (including 
+// the body and cache workers) has anything left to do for it
+static std::atomic_size_t s_activeRequests = 0;
+
+size_t utils::web::getActiveRequestCount() {
+    return s_activeRequests;
+}
+
+static bool headerNameEquals(std::string_view a, std::string_view b) {
+    return utils::string::caseInsensitiveCompare(a, b) == std::strong_ordering::equal;
+}
+
+// Header names are case-insensitive, and HTTP/2 servers send them in lowercase
+static std::optional<std::string> findHeader(HeaderMap const& headers, std::string_view name) {
+    for (auto const& [key, values] : headers) {
+        if (headerNameEquals(key, name) && !values.empty()) {
+            return values.back();
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * Figure out how long a response may be reused without checking with the 
+ * server first, from its Cache-Control or Expires headers
+ * @returns The time in seconds (which may be zero), or nullopt if the 
+ * response must not be cached at all
+ */
+static std::optional<std::chrono::seconds> getFreshnessLifetime(HeaderMap const& headers) {
+    if (findHeader(headers, "Vary") == "*") {
+        return std::nullopt;
+    }
+    if (auto cacheControl = findHeader(headers, "Cache-Control")) {
+        std::optional<std::chrono::seconds> maxAge;
+        bool noCache = false;
+        for (auto directive : utils::string::split(*cacheControl, ",")) {
+            directive = utils::string::toLower(utils::string::trim(directive));
+            if (directive == "no-store") {
+                return std::nullopt;
+            }
+            if (directive == "no-cache") {
+                noCache = true;
+            }
+            else if (directive.starts_with("max-age=")) {
+                if (auto seconds = numFromString<int64_t>(directive.substr(8))) {
+                    maxAge = std::chrono::seconds(std::max<int64_t>(seconds.unwrap(), 0));
+                }
+            }
+        }
+        if (noCache) {
+            return std::chrono::seconds(0);
+        }
+        if (maxAge) {
+            return maxAge;
+        }
+    }
+    if (auto expires = findHeader(headers, "Expires")) {
+        date::sys_seconds time;
+        std::istringstream ss(*expires);
+        // Invalid dates mean the response has already expired
+        if (!(ss >> date::parse("%a, %d %b %Y %T GMT", time))) {
+            return std::chrono::seconds(0);
+        }
+        auto now = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now());
+        return std::max(time - now, std::chrono::seconds(0));
+    }
+    // Without an explicit lifetime, the response has to be revalidated 
+    // every time it's used
+    return std::chrono::seconds(0);
+}
+
+// The request headers named by a response's Vary header, by lowercase name. 
+// A cached response can only be reused for requests that send the same ones
+using VaryValues = std::map<std::string, std::string>;
+
+static std::vector<std::string> getVaryNames(HeaderMap const& headers) {
+    std::vector<std::string> names;
+    for (auto const& [key, values] : headers) {
+        if (!headerNameEquals(key, "Vary")) {
+            continue;
+        }
+        for (auto const& value : values) {
+            for (auto name : utils::string::split(value, ",")) {
+                name = utils::string::toLower(utils::string::trim(name));
+                if (!name.empty()) {
+                    names.push_back(name);
+                }
+            }
+        }
+    }
+    return names;
+}
+
+static int64_t getUnixSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+struct CachedResponse {
+    std::string url;
+    int code = 0;
+    HeaderMap headers;
+    ByteVector body;
+    VaryValues vary;
+    // Unix time until which the response can be used without revalidating it
+    int64_t freshUntil = 0;
+
+    bool isFresh() const {
+        return getUnixSeconds() < freshUntil;
+    }
+};
+
+/**
+ * Responses to requests made with a cache policy, saved on disk so they can 
+ * be reused across launches. Each response is stored as a JSON file with 
+ * its status and headers, and a file with its body. Once the cache grows 
+ * past its size limit, the least recently used responses are removed
+ */
+class WebCache final {
+protected:
+    static constexpr size_t MAX_SIZE = 64 * 1024 * 1024;
+    // Larger responses aren't worth pushing everything else out for
+    static constexpr size_t MAX_RESPONSE_SIZE = 4 * 1024 * 1024;
+
+    std::mutex m_mutex;
+    // Total size of the cache on disk. Counted once and then kept up to 
+    // date, so storing a response doesn't have to look at every file
+    std::optional<size_t> m_size;
+
+    static std::filesystem::path getDir() {
+        return dirs::getTempDir() / "web-cache";
+    }
+    static std::filesystem::path getPath(std::string const& url) {
+        return getDir() / fmt::format("{:016x}", std::hash<std::string>()(url));
+    }
+
+    static size_t getFileSize(std::filesystem::path const& path) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        return ec ? 0 : static_cast<size_t>(size);
+    }
+    static size_t getEntrySize(std::filesystem::path const& path) {
+        return getFileSize(std::filesystem::path(path).replace_extension(".json")) +
+            getFileSize(std::filesystem::path(path).replace_extension(".bin"));
+    }
+    static void removeFiles(std::filesystem::path const& path) {
+        std::error_code ec;
+        std::filesystem::remove(std::filesystem::path(path).replace_extension(".json"), ec);
+        std::filesystem::remove(std::filesystem::path(path).replace_extension(".bin"), ec);
+    }
+
+    size_t& getSize() {
+        if (!m_size) {
+            size_t total = 0;
+            std::error_code ec;
+            for (auto const& file : std::filesystem::directory_iterator(getDir(), ec)) {
+                total += getFileSize(file.path());
+            }
+            m_size = total;
+        }
+        return *m_size;
+    }
+
+    void remove(std::filesystem::path const& path) {
+        auto& total = this->getSize();
+        total -= std::min(total, getEntrySize(path));
+        removeFiles(path);
+    }
+
+    // Only looks at the files when the cache is actually too large, to find 
+    // out which responses were used least recently
+    void trim() {
+        if (this->getSize() <= MAX_SIZE) {
+            return;
+        }
+        struct Entry {
+            std::filesystem::path path;
+            std::filesystem::file_time_type lastUsed;
+        };
+        std::vector<Entry> entries;
+        std::error_code ec;
+        for (auto const& file : std::filesystem::directory_iterator(getDir(), ec)) {
+            if (file.path().extension() == ".json") {
+                entries.push_back({ file.path(), file.last_write_time(ec) });
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](Entry const& a, Entry const& b) {
+            return a.lastUsed < b.lastUsed;
+        });
+        for (auto const& entry : entries) {
+            if (this->getSize() <= MAX_SIZE) {
+                break;
+            }
+            this->remove(entry.path);
+        }
+    }
+
+public:
+    static WebCache* get() {
+        static auto inst = new WebCache();
+        return inst;
+    }
+
+    std::optional<CachedResponse> load(std::string const& url) {
+        std::unique_lock lock(m_mutex);
+        auto path = getPath(url);
+        auto metaPath = std::filesystem::path(path).replace_extension(".json");
+        auto json = file::readJson(metaPath);
+        if (!json) {
+            return std::nullopt;
+        }
+        auto root = checkJson(json.unwrap(), "CachedResponse");
+
+        CachedResponse response;
+        root.needs("url").into(response.url);
+        root.needs("code").into(response.code);
+        root.needs("fresh-until").into(response.freshUntil);
+        for (auto& [name, values] : root.needs("headers").properties()) {
+            for (auto& value : values.items()) {
+                response.headers[name].push_back(value.get<std::string>());
+            }
+        }
+        for (auto& [name, value] : root.needs("vary").properties()) {
+            response.vary[name] = value.get<std::string>();
+        }
+        // The hash of a different URL may have collided with this one
+        if (!root.ok() || response.url != url) {
+            return std::nullopt;
+        }
+        auto body = file::readBinary(std::filesystem::path(path).replace_extension(".bin"));
+        if (!body) {
+            remove(path);
+            return std::nullopt;
+        }
+        response.body = std::move(body).unwrap();
+
+        // Mark the response as recently used so it's removed last
+        std::error_code ec;
+        std::filesystem::last_write_time(metaPath, std::filesystem::file_time_type::clock::now(), ec);
+        return response;
+    }
+
+    void store(std::string const& url, int code, HeaderMap const& headers, ByteVector const& body, VaryValues const& vary) {
+        auto lifetime = getFreshnessLifetime(headers);
+        if (!lifetime || body.size() > MAX_RESPONSE_SIZE) {
+            return;
+        }
+        // Responses that have to be revalidated are useless without 
+        // something to revalidate them with
+        if (*lifetime == std::chrono::seconds(0) && !findHeader(headers, "ETag") && !findHeader(headers, "Last-Modified")) {
+            return;
+        }
+
+        auto jsonHeaders = matjson::Value::object();
+        for (auto const& [name, values] : headers) {
+            jsonHeaders[name] = std::vector<matjson::Value>(values.begin(), values.end());
+        }
+        auto jsonVary = matjson::Value::object();
+        for (auto const& [name, value] : vary) {
+            jsonVary[name] = value;
+        }
+        auto json = matjson::makeObject({
+            { "url", url },
+            { "code", code },
+            { "fresh-until", getUnixSeconds() + lifetime->count() },
+            { "headers", jsonHeaders },
+            { "vary", jsonVary },
+        }).dump(matjson::NO_INDENTATION);
+
+        std::unique_lock lock(m_mutex);
+        auto path = getPath(url);
+        (void) file::createDirectoryAll(getDir());
+        // Whatever was stored for this URL before is replaced
+        auto& total = this->getSize();
+        total -= std::min(total, getEntrySize(path));
+        // Write the body first, so a response is never found without it
+        if (
+            !file::writeBinary(std::filesystem::path(path).replace_extension(".bin"), body) ||
+            !file::writeString(std::filesystem::path(path).replace_extension(".json"), json)
+        ) {
+            removeFiles(path);
+            return;
+        }
+        total += body.size() + json.size();
+        this->trim();
+    }
+};
+
 class WebRequest::Impl {
 public:
     static std::atomic_size_t s_idCounter;
@@ -200,6 +611,11 @@ public:
     std::optional<std::string> m_userAgent;
     std::optional<std::string> m_acceptEncodingType;
     std::optional<ByteVector> m_body;
+    std::optional<std::filesystem::path> m_bodyFile;
+    std::shared_ptr<MultipartForm::Impl const> m_multipart;
+    std::function<bool(std::span<const uint8_t>)> m_onResponseChunk;
+    std::function<bool(WebResponse const&)> m_onResponseStart;
+    std::optional<std::filesystem::path> m_downloadPath;
     std::optional<std::chrono::seconds> m_timeout;
     std::optional<std::pair<std::uint64_t, std::uint64_t>> m_range;
     bool m_certVerification = true;
@@ -209,20 +625,393 @@ public:
     std::string m_CABundleContent;
     ProxyOpts m_proxyOpts = {};
     HttpVersion m_httpVersion = HttpVersion::DEFAULT;
+    CachePolicy m_cachePolicy = CachePolicy::None;
     size_t m_id;
 
     Impl() : m_id(s_idCounter++) {}
 
+    void clearBody() {
+        m_body.reset();
+        m_bodyFile.reset();
+        m_multipart.reset();
+    }
+
+    // Only plain GETs whose whole response ends up in memory can be cached. 
+    // Requests with their own conditional headers expect to see the 304 
+    // themselves
+    bool isCacheable() const {
+        if (
+            m_cachePolicy == CachePolicy::None || m_method != "GET" || 
+            m_body || m_bodyFile || m_multipart || m_range || !m_transferBody ||
+            m_onResponseChunk || m_onResponseStart || m_downloadPath
+        ) {
+            return false;
+        }
+        for (auto const& [name, values] : m_headers) {
+            if (headerNameEquals(name, "If-None-Match") || headerNameEquals(name, "If-Modified-Since")) {
+                return false;
+            }
+            // Responses to requests with credentials are for whoever sent 
+            // them, and mustn't be handed to other requests for the same URL
+            if (headerNameEquals(name, "Authorization") || headerNameEquals(name, "Cookie")) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The values this request sends for the headers a response varies on
+    VaryValues getVaryValues(HeaderMap const& responseHeaders) const {
+        VaryValues values;
+        for (auto const& name : getVaryNames(responseHeaders)) {
+            // These are passed to curl as options rather than headers
+            if (name == "user-agent") {
+                if (m_userAgent) {
+                    values[name] = *m_userAgent;
+                }
+                continue;
+            }
+            if (name == "accept-encoding") {
+                if (m_acceptEncodingType) {
+                    values[name] = *m_acceptEncodingType;
+                }
+                continue;
+            }
+            for (auto const& [key, headerValues] : m_headers) {
+                if (headerNameEquals(key, name)) {
+                    values[name] = utils::string::join(headerValues, ", ");
+                }
+            }
+        }
+        return values;
+    }
+
     WebResponse makeError(int code, std::string const& msg) {
         auto res = WebResponse();
         res.m_impl->m_code = code;
         res.m_impl->m_data = ByteVector(msg.begin(), msg.end());
         return res;
     }
+
+    class Worker;
+
+    // A request handed over to the networking thread, along with everything 
+    // curl's callbacks need while it's running
+    struct Transfer {
+        std::shared_ptr<Impl> impl;
+        CURL* curl = nullptr;
+        curl_slist* headers = nullptr;
+        curl_mime* mime = nullptr;
+        std::unique_ptr<BodyReader> upload;
+        std::string url;
+        std::optional<CachedResponse> cached;
+        WebResponse response;
+        WebTask::PostResult finish;
+        WebTask::PostProgress progress;
+        WebTask::HasBeenCancelled hasBeenCancelled;
+        bool started = false;
+        // Only set if the body is streamed somewhere instead of collected 
+        // into the response, or has to be checked by onResponseStart first. 
+        // Streaming, checking and collecting the body then happen on this 
+        // worker
+        std::shared_ptr<Worker> bodyWorker;
+        // Whether curl has been told to hold off on the body until the 
+        // worker catches up
+        bool paused = false;
+        // Only set if the body is being downloaded into a file
+        std::ofstream file;
+        bool fileCreated = false;
+        bool keepFile = false;
+        std::optional<std::string> error;
+
+        Transfer() = default;
+        Transfer(Transfer const&) = delete;
+        Transfer& operator=(Transfer const&) = delete;
+        ~Transfer();
+
+        bool openFile();
+        void startBody(WebResponse const& response);
+        void writeBody(std::span<const uint8_t> chunk);
+        bool tryCache();
+        WebResponse responseFromCache() const;
+        void complete(CURLcode result);
+    };
+
+    class Manager;
+
+    static std::shared_ptr<Transfer> createTransfer(
+        std::shared_ptr<Impl> impl,
+        WebTask::PostResult finish,
+        WebTask::PostProgress progress,
+        WebTask::HasBeenCancelled hasBeenCancelled
+    );
 };
 
 std::atomic_size_t WebRequest::Impl::s_idCounter = 0;
 
+/**
+ * Runs jobs one after another on a thread of its own. Everything a request 
+ * does that may block (writing its body to a file, calling its body 
+ * callbacks, reading and writing the cache) goes through one of these, 
+ * since doing it on the networking thread would hold up every other request
+ */
+class WebRequest::Impl::Worker final {
+protected:
+    // How much of a streamed body can be waiting on the worker before the 
+    // transfer is paused
+    static constexpr size_t MAX_QUEUED_BYTES = 4 * 1024 * 1024;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::pair<std::function<void()>, size_t>> m_jobs;
+    size_t m_queuedBytes = 0;
+    bool m_closed = false;
+    std::atomic_bool m_failed = false;
+
+    void run();
+
+public:
+    static std::shared_ptr<Worker> create(std::string name) {
+        auto worker = std::make_shared<Worker>();
+        // The thread keeps the worker alive until it's closed and every job 
+        // has run
+        std::thread([worker, name = std::move(name)] {
+            utils::thread::setName(name);
+            worker->run();
+        }).detach();
+        return worker;
+    }
+
+    // All cache reads and writes happen on this one, so the cache itself 
+    // doesn't need any locking
+    static std::shared_ptr<Worker> cache() {
+        static auto worker = Worker::create("Web Cache");
+        return worker;
+    }
+
+    /**
+     * Queue a job. The bytes count towards isBackedUp until it has run
+     */
+    void push(std::function<void()> job, size_t bytes = 0) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_jobs.emplace_back(std::move(job), bytes);
+            m_queuedBytes += bytes;
+        }
+        m_cv.notify_one();
+    }
+    /**
+     * Let the thread exit once the jobs queued so far have run
+     */
+    void close() {
+        {
+            std::unique_lock lock(m_mutex);
+            m_closed = true;
+        }
+        m_cv.notify_one();
+    }
+    bool isBackedUp() {
+        std::unique_lock lock(m_mutex);
+        return m_queuedBytes >= MAX_QUEUED_BYTES;
+    }
+
+    // Set when a body callback asks to abort, so the remaining body is 
+    // skipped and curl is told to stop
+    void fail() {
+        m_failed = true;
+    }
+    bool hasFailed() const {
+        return m_failed;
+    }
+};
+
+/**
+ * Runs every WebRequest on a single thread through one curl multi handle, 
+ * so connections (and their TLS sessions and HTTP/2 multiplexing), DNS 
+ * lookups and the parsed CA bundle are reused between requests instead of 
+ * paying for a new handshake every time
+ */
+class WebRequest::Impl::Manager final {
+protected:
+    CURLM* m_multi = nullptr;
+    CURLSH* m_share = nullptr;
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<Transfer>> m_queued;
+    std::unordered_map<CURL*, std::shared_ptr<Transfer>> m_running;
+
+    Manager() {
+        m_multi = curl_multi_init();
+        curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+        // The share is only ever used from the networking thread, so it 
+        // doesn't need lock callbacks
+        m_share = curl_share_init();
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
+        std::thread(&Manager::loop, this).detach();
+    }
+
+    void finish(CURL* curl, std::optional<CURLcode> result) {
+        auto it = m_running.find(curl);
+        if (it == m_running.end()) return;
+        auto transfer = std::move(it->second);
+        m_running.erase(it);
+        curl_multi_remove_handle(m_multi, curl);
+
+        // Finishing may close the file or store the response in the cache, 
+        // so it's done after everything else the transfer's worker was given
+        auto worker = transfer->bodyWorker;
+        if (!worker && result && transfer->impl->isCacheable()) {
+            worker = Worker::cache();
+        }
+        if (!worker) {
+            if (result) {
+                transfer->complete(*result);
+            }
+            else {
+                transfer->finish(WebTask::Cancel());
+            }
+            return;
+        }
+        if (!result) {
+            // Don't bother writing out the rest of a cancelled body
+            worker->fail();
+        }
+        // The share isn't locked, so the handle has to leave it before it's 
+        // cleaned up on another thread
+        curl_easy_setopt(curl, CURLOPT_SHARE, nullptr);
+        worker->push([transfer, result] {
+            if (result) {
+                transfer->complete(*result);
+            }
+            else {
+                transfer->finish(WebTask::Cancel());
+            }
+        });
+    }
+
+    void loop() {
+        utils::thread::setName("Web Requests");
+        std::vector<std::shared_ptr<Transfer>> queued;
+        while (true) {
+            {
+                std::unique_lock lock(m_mutex);
+                queued.swap(m_queued);
+            }
+            for (auto& transfer : queued) {
+                curl_easy_setopt(transfer->curl, CURLOPT_SHARE, m_share);
+                curl_multi_add_handle(m_multi, transfer->curl);
+                m_running.emplace(transfer->curl, std::move(transfer));
+            }
+            queued.clear();
+
+            // Requests that are cancelled while waiting on a connection or 
+            // the server don't get their progress callback called, so drop 
+            // them here
+            std::vector<CURL*> cancelled;
+            for (auto& [curl, transfer] : m_running) {
+                if (transfer->hasBeenCancelled()) {
+                    cancelled.push_back(curl);
+                }
+            }
+            for (auto curl : cancelled) {
+                this->finish(curl, std::nullopt);
+            }
+
+            // Pick up paused bodies again once their worker has caught up 
+            // (or failed, so the write callback can abort the transfer)
+            for (auto& [curl, transfer] : m_running) {
+                if (transfer->paused && (transfer->bodyWorker->hasFailed() || !transfer->bodyWorker->isBackedUp())) {
+                    transfer->paused = false;
+                    curl_easy_pause(curl, CURLPAUSE_CONT);
+                }
+            }
+
+            int running = 0;
+            curl_multi_perform(m_multi, &running);
+
+            int left = 0;
+            while (auto msg = curl_multi_info_read(m_multi, &left)) {
+                if (msg->msg == CURLMSG_DONE) {
+                    this->finish(msg->easy_handle, msg->data.result);
+                }
+            }
+
+            // Sleep until there's something to do, or a new request is 
+            // queued. While requests are running wake up regularly anyway 
+            // to notice if they've been cancelled
+            curl_multi_poll(m_multi, nullptr, 0, m_running.empty() ? 60'000 : 100, nullptr);
+        }
+    }
+
+public:
+    static Manager* get() {
+        static auto inst = new Manager();
+        return inst;
+    }
+
+    void enqueue(std::shared_ptr<Transfer> transfer) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_queued.push_back(std::move(transfer));
+        }
+        curl_multi_wakeup(m_multi);
+    }
+
+    void wakeup() {
+        curl_multi_wakeup(m_multi);
+    }
+};
+
+void WebRequest::Impl::Worker::run() {
+    while (true) {
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [this] { return !m_jobs.empty() || m_closed; });
+        if (m_jobs.empty()) {
+            return;
+        }
+        auto [job, bytes] = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        lock.unlock();
+
+        job();
+
+        lock.lock();
+        auto wasBackedUp = m_queuedBytes >= MAX_QUEUED_BYTES;
+        m_queuedBytes -= bytes;
+        auto resume = wasBackedUp && m_queuedBytes < MAX_QUEUED_BYTES;
+        lock.unlock();
+        if (resume) {
+            Manager::get()->wakeup();
+        }
+    }
+}
+
+WebRequest::Impl::Transfer::~Transfer() {
+    curl_easy_cleanup(curl);
+    curl_mime_free(mime);
+    curl_slist_free_all(headers);
+
+    // Don't leave half-downloaded files around
+    file.close();
+    if (fileCreated && !keepFile) {
+        std::error_code ec;
+        std::filesystem::remove(*impl->m_downloadPath, ec);
+    }
+
+    if (bodyWorker) {
+        bodyWorker->close();
+    }
+
+    if (--s_activeRequests == 0) {
+        queueInMainThread([] {
+            WebIdleEvent().post();
+        });
+    }
+}
+
 WebRequest::WebRequest() : m_impl(std::make_shared<Impl>()) {}
 WebRequest::~WebRequest() {}
 
@@ -240,243 +1029,481 @@ static std::string urlParamEncode(std::string_view input) {
     return ss.str();
 }
 
-WebTask WebRequest::send(std::string_view method, std::string_view url) {
-    m_impl->m_method = method;
-    m_impl->m_url = url;
-    return WebTask::run([impl = m_impl](auto progress, auto hasBeenCancelled) -> WebTask::Result {
-        // Init Curl
-        auto curl = curl_easy_init();
-        if (!curl) {
-            return impl->makeError(-1, "Curl not initialized");
-        }
-
-        // todo: in the future, we might want to support downloading directly into 
-        // files / in-memory streams like the old AsyncWebRequest class
-
-        // Struct that holds values for the curl callbacks
-        struct ResponseData {
-            WebResponse response;
-            Impl* impl;
-            WebTask::PostProgress progress;
-            WebTask::HasBeenCancelled hasBeenCancelled;
-        } responseData = {
-            .response = WebResponse(),
-            .impl = impl.get(),
-            .progress = progress,
-            .hasBeenCancelled = hasBeenCancelled,
-        };
+std::shared_ptr<WebRequest::Impl::Transfer> WebRequest::Impl::createTransfer(
+    std::shared_ptr<Impl> impl,
+    WebTask::PostResult finish,
+    WebTask::PostProgress progress,
+    WebTask::HasBeenCancelled hasBeenCancelled
+) {
+    auto transfer = std::make_shared<Transfer>();
+    s_activeRequests += 1;
+    transfer->impl = impl;
+    transfer->finish = std::move(finish);
+    transfer->progress = std::move(progress);
+    transfer->hasBeenCancelled = std::move(hasBeenCancelled);
+
+    // Init Curl
+    auto curl = curl_easy_init();
+    if (!curl) {
+        transfer->error = "Curl not initialized";
+        return transfer;
+    }
+    transfer->curl = curl;
 
-        // Store downloaded response data into a byte vector
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseData);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, +[](char* data, size_t size, size_t nmemb, void* ptr) {
-            auto& target = static_cast<ResponseData*>(ptr)->response.m_impl->m_data;
-            target.insert(target.end(), data, data + size * nmemb);
+    // Store downloaded response data into a byte vector, or pass it on 
+    // to the transfer's worker if it's streamed somewhere else or has to be 
+    // checked before it's stored
+    if (impl->m_onResponseStart || impl->m_onResponseChunk || impl->m_downloadPath) {
+        transfer->bodyWorker = Worker::create(fmt::format("Web Request #{}", impl->m_id));
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, transfer.get());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, +[](char* data, size_t size, size_t nmemb, void* ptr) -> size_t {
+        auto transfer = static_cast<Transfer*>(ptr);
+        long code = 0;
+        curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &code);
+        auto success = 200 <= code && code < 300;
+        if (success && transfer->bodyWorker) {
+            auto const& worker = transfer->bodyWorker;
+            // Returning less than was given aborts the transfer
+            if (worker->hasFailed()) {
+                return 0;
+            }
+            // Curl hands the same data over again once unpaused
+            if (worker->isBackedUp()) {
+                transfer->paused = true;
+                return CURL_WRITEFUNC_PAUSE;
+            }
+            if (!transfer->started) {
+                transfer->started = true;
+                // The worker gets a copy since curl keeps adding to the 
+                // response on this thread
+                auto response = WebResponse();
+                response.m_impl->m_code = static_cast<int>(code);
+                response.m_impl->m_headers = transfer->response.m_impl->m_headers;
+                worker->push([transfer, response = std::move(response)] {
+                    transfer->startBody(response);
+                });
+            }
+            worker->push([transfer, chunk = ByteVector(data, data + size * nmemb)] {
+                transfer->writeBody(chunk);
+            }, size * nmemb);
             return size * nmemb;
-        });
+        }
+        auto& target = transfer->response.m_impl->m_data;
+        target.insert(target.end(), data, data + size * nmemb);
+        return size * nmemb;
+    });
 
-        // Set headers
-        curl_slist* headers = nullptr;
-        for (auto& [name, values] : impl->m_headers) {
-            // Sanitize header name
-            auto header = name;
-            header.erase(std::remove_if(header.begin(), header.end(), [](char c) {
-                return c == '\r' || c == '\n';
-            }), header.end());
-            // Append value
-            for (const auto& value: values) {
-                header += ": " + value;
-                headers = curl_slist_append(headers, header.c_str());
-            }
+    // Set headers
+    for (auto& [name, values] : impl->m_headers) {
+        // Sanitize header name
+        auto header = name;
+        header.erase(std::remove_if(header.begin(), header.end(), [](char c) {
+            return c == '\r' || c == '\n';
+        }), header.end());
+        // Append value
+        for (const auto& value: values) {
+            header += ": " + value;
+            transfer->headers = curl_slist_append(transfer->headers, header.c_str());
         }
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
+
+    // Add parameters to the URL and pass it to curl
+    auto url = impl->m_url;
+    bool first = url.find('?') == std::string::npos;
+    for (auto& [key, value] : impl->m_urlParameters) {
+        url += (first ? "?" : "&") + urlParamEncode(key) + "=" + urlParamEncode(value);
+        first = false;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    transfer->url = url;
+
+    // Set HTTP version
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, unwrapHttpVersion(impl->m_httpVersion));
 
-        // Add parameters to the URL and pass it to curl
-        auto url = impl->m_url;
-        bool first = url.find('?') == std::string::npos;
-        for (auto& [key, value] : impl->m_urlParameters) {
-            url += (first ? "?" : "&") + urlParamEncode(key) + "=" + urlParamEncode(value);
-            first = false;
+    // Wait for a connection that's still being set up to the same host 
+    // rather than opening another one, in case requests can be multiplexed 
+    // over it
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+
+    // Set request method
+    if (impl->m_method != "GET") {
+        if (impl->m_method == "POST") {
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        }
+        else {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, impl->m_method.c_str());
         }
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    }
 
-        // Set HTTP version
-        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, unwrapHttpVersion(impl->m_httpVersion));
+    // Set body if provided
+    if (impl->m_body) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, impl->m_body->data());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, impl->m_body->size());
+    } else if (impl->m_bodyFile) {
+        auto reader = BodyReader::create(*impl->m_bodyFile);
+        if (!reader) {
+            transfer->error = reader.unwrapErr();
+            return transfer;
+        }
+        transfer->upload = std::move(reader).unwrap();
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, &BodyReader::read);
+        curl_easy_setopt(curl, CURLOPT_READDATA, transfer->upload.get());
+        curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, &BodyReader::seek);
+        curl_easy_setopt(curl, CURLOPT_SEEKDATA, transfer->upload.get());
+        auto size = static_cast<curl_off_t>(transfer->upload->size);
+        if (impl->m_method == "POST") {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, size);
+        }
+        else {
+            // Uploads default to PUT, so keep the requested method
+            curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+            curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, size);
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, impl->m_method.c_str());
+        }
+    } else if (impl->m_multipart) {
+        transfer->mime = curl_mime_init(curl);
+        for (auto const& part : impl->m_multipart->m_parts) {
+            auto reader = std::visit([](auto const& content) {
+                return BodyReader::create(content);
+            }, part.content);
+            if (!reader) {
+                transfer->error = reader.unwrapErr();
+                return transfer;
+            }
+            auto owned = std::move(reader).unwrap();
+            auto size = static_cast<curl_off_t>(owned->size);
 
-        // Set request method
-        if (impl->m_method != "GET") {
-            if (impl->m_method == "POST") {
-                curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            auto mimePart = curl_mime_addpart(transfer->mime);
+            curl_mime_name(mimePart, part.name.c_str());
+            if (part.filename) {
+                curl_mime_filename(mimePart, part.filename->c_str());
             }
-            else {
-                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, impl->m_method.c_str());
+            if (part.mimeType) {
+                curl_mime_type(mimePart, part.mimeType->c_str());
             }
+            // Curl owns the reader from here on and frees it along with the 
+            // mime structure
+            curl_mime_data_cb(
+                mimePart, size, &BodyReader::read, &BodyReader::seek,
+                &BodyReader::free, owned.release()
+            );
         }
+        curl_easy_setopt(curl, CURLOPT_MIMEPOST, transfer->mime);
+    } else if (impl->m_method == "POST") {
+        // curl_easy_perform would freeze on a POST request with no fields, so set it to an empty string
+        // why? god knows
+        // SMJS: because the stream isn't complete without a body according to the spec
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
+    }
 
-        // Set body if provided
-        if (impl->m_body) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, impl->m_body->data());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, impl->m_body->size());
-        } else if (impl->m_method == "POST") {
-            // curl_easy_perform would freeze on a POST request with no fields, so set it to an empty string
-            // why? god knows
-            // SMJS: because the stream isn't complete without a body according to the spec
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
-        }
-
-        // Cert verification
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, impl->m_certVerification ? 1 : 0);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2);
+    // Cert verification
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, impl->m_certVerification ? 1 : 0);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2);
 
-        if (impl->m_certVerification) {
-            curl_blob caBundleBlob = {};
+    if (impl->m_certVerification) {
+        // The default bundle outlives every request, so there's no need for 
+        // curl to copy it for each one
+        static std::string defaultCABundle = CA_BUNDLE_CONTENT;
 
-            if (impl->m_CABundleContent.empty()) {
-                impl->m_CABundleContent = CA_BUNDLE_CONTENT;
-            }
-            
+        curl_blob caBundleBlob = {};
+        if (impl->m_CABundleContent.empty()) {
+            caBundleBlob.data = reinterpret_cast<void*>(defaultCABundle.data());
+            caBundleBlob.len = defaultCABundle.size();
+            caBundleBlob.flags = CURL_BLOB_NOCOPY;
+        }
+        else {
             caBundleBlob.data = reinterpret_cast<void*>(impl->m_CABundleContent.data());
             caBundleBlob.len = impl->m_CABundleContent.size();
             caBundleBlob.flags = CURL_BLOB_COPY;
-            curl_easy_setopt(curl, CURLOPT_CAINFO_BLOB, &caBundleBlob);
         }
+        curl_easy_setopt(curl, CURLOPT_CAINFO_BLOB, &caBundleBlob);
+    }
 
-        // Transfer body
-        curl_easy_setopt(curl, CURLOPT_NOBODY, impl->m_transferBody ? 0L : 1L);
+    // Transfer body
+    curl_easy_setopt(curl, CURLOPT_NOBODY, impl->m_transferBody ? 0L : 1L);
 
-        // Set user agent if provided
-        if (impl->m_userAgent) {
-            curl_easy_setopt(curl, CURLOPT_USERAGENT, impl->m_userAgent->c_str());
-        }
+    // Set user agent if provided
+    if (impl->m_userAgent) {
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, impl->m_userAgent->c_str());
+    }
 
-        // Set encoding
-        if (impl->m_acceptEncodingType) {
-            curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, impl->m_acceptEncodingType->c_str());
-        }
+    // Set encoding
+    if (impl->m_acceptEncodingType) {
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, impl->m_acceptEncodingType->c_str());
+    }
 
-        // Set timeout
-        if (impl->m_timeout) {
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, impl->m_timeout->count());
-        }
+    // Set timeout
+    if (impl->m_timeout) {
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, impl->m_timeout->count());
+    }
+
+    // Set range
+    if (impl->m_range) {
+        curl_easy_setopt(curl, CURLOPT_RANGE, fmt::format("{}-{}", impl->m_range->first, impl->m_range->second).c_str());
+    }
+
+    // Set proxy options
+    auto const& proxyOpts = impl->m_proxyOpts;
+    if (!proxyOpts.address.empty()) {
+        curl_easy_setopt(curl, CURLOPT_PROXY, proxyOpts.address.c_str());
 
-        // Set range
-        if (impl->m_range) {
-            curl_easy_setopt(curl, CURLOPT_RANGE, fmt::format("{}-{}", impl->m_range->first, impl->m_range->second).c_str());
+        if (proxyOpts.port.has_value()) {
+            curl_easy_setopt(curl, CURLOPT_PROXYPORT, proxyOpts.port.value());
         }
 
-        // Set proxy options
-        auto const& proxyOpts = impl->m_proxyOpts;
-        if (!proxyOpts.address.empty()) {
-            curl_easy_setopt(curl, CURLOPT_PROXY, proxyOpts.address.c_str());
+        curl_easy_setopt(curl, CURLOPT_PROXYTYPE, unwrapProxyType(proxyOpts.type));
 
-            if (proxyOpts.port.has_value()) {
-                curl_easy_setopt(curl, CURLOPT_PROXYPORT, proxyOpts.port.value());
-            }
+        if (!proxyOpts.username.empty() || !proxyOpts.username.empty()) {
+            curl_easy_setopt(curl, CURLOPT_PROXYAUTH, unwrapHttpAuth(proxyOpts.auth));
+            curl_easy_setopt(curl, CURLOPT_PROXYUSERPWD,
+                fmt::format("{}:{}", proxyOpts.username, proxyOpts.password).c_str());
+        }
 
-            curl_easy_setopt(curl, CURLOPT_PROXYTYPE, unwrapProxyType(proxyOpts.type));
+        curl_easy_setopt(curl, CURLOPT_HTTPPROXYTUNNEL, proxyOpts.tunneling ? 1 : 0);
+        curl_easy_setopt(curl, CURLOPT_PROXY_SSL_VERIFYPEER, proxyOpts.certVerification ? 1 : 0);
+        curl_easy_setopt(curl, CURLOPT_PROXY_SSL_VERIFYHOST, 2);
+    }
 
-            if (!proxyOpts.username.empty() || !proxyOpts.username.empty()) {
-                curl_easy_setopt(curl, CURLOPT_PROXYAUTH, unwrapHttpAuth(proxyOpts.auth));
-                curl_easy_setopt(curl, CURLOPT_PROXYUSERPWD,
-                    fmt::format("{}:{}", proxyOpts.username, proxyOpts.password).c_str());
+    // Follow request through 3xx responses
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, impl->m_followRedirects ? 1L : 0L);
+
+    // Ignore content length
+    curl_easy_setopt(curl, CURLOPT_IGNORE_CONTENT_LENGTH, impl->m_ignoreContentLength ? 1L : 0L);
+
+    // Track progress
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0);
+
+    // don't change the method from POST to GET when following a redirect
+    curl_easy_setopt(curl, CURLOPT_POSTREDIR, CURL_REDIR_POST_ALL);
+
+    // Do not fail if response code is 4XX or 5XX
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 0L);
+
+    // Get headers from the response
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, transfer.get());
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, (+[](char* buffer, size_t size, size_t nitems, void* ptr) {
+        auto& headers = static_cast<Transfer*>(ptr)->response.m_impl->m_headers;
+        std::string line;
+        std::stringstream ss(std::string(buffer, size * nitems));
+        while (std::getline(ss, line)) {
+            auto colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            auto key = line.substr(0, colon);
+            auto value = line.substr(colon + 2);
+            if (value.ends_with('\r')) {
+                value = value.substr(0, value.size() - 1);
+            }
+            // Create a new vector and add to it or add to an already existing one
+            if (headers.contains(key)) {
+                headers.at(key).push_back(value);
+            } else {
+                headers.insert_or_assign(key, std::vector{value});
             }
-
-            curl_easy_setopt(curl, CURLOPT_HTTPPROXYTUNNEL, proxyOpts.tunneling ? 1 : 0);
-            curl_easy_setopt(curl, CURLOPT_PROXY_SSL_VERIFYPEER, proxyOpts.certVerification ? 1 : 0);
-            curl_easy_setopt(curl, CURLOPT_PROXY_SSL_VERIFYHOST, 2);
         }
+        return size * nitems;
+    }));
 
-        // Follow request through 3xx responses
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, impl->m_followRedirects ? 1L : 0L);
+    // Track & post progress on the Promise
+    curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, transfer.get());
+    curl_easy_setopt(curl, CURLOPT_PROGRESSFUNCTION, +[](void* ptr, double dtotal, double dnow, double utotal, double unow) -> int {
+        auto transfer = static_cast<Transfer*>(ptr);
 
-        // Ignore content length
-        curl_easy_setopt(curl, CURLOPT_IGNORE_CONTENT_LENGTH, impl->m_ignoreContentLength ? 1L : 0L);
+        // Check for cancellation and abort if so
+        if (transfer->hasBeenCancelled()) {
+            return 1;
+        }
 
-        // Track progress
-        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0);
+        // Post progress to Promise listener
+        auto progress = WebProgress();
+        progress.m_impl->m_downloadTotal = dtotal;
+        progress.m_impl->m_downloadCurrent = dnow;
+        progress.m_impl->m_uploadTotal = utotal;
+        progress.m_impl->m_uploadCurrent = unow;
+        transfer->progress(std::move(progress));
 
-        // don't change the method from POST to GET when following a redirect
-        curl_easy_setopt(curl, CURLOPT_POSTREDIR, CURL_REDIR_POST_ALL);
+        // Continue as normal
+        return 0;
+    });
 
-        // Do not fail if response code is 4XX or 5XX
-        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 0L);
+    return transfer;
+}
 
-        // Get headers from the response
-        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &responseData);
-        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, (+[](char* buffer, size_t size, size_t nitems, void* ptr) {
-            auto& headers = static_cast<ResponseData*>(ptr)->response.m_impl->m_headers;
-            std::string line;
-            std::stringstream ss(std::string(buffer, size * nitems));
-            while (std::getline(ss, line)) {
-                auto colon = line.find(':');
-                if (colon == std::string::npos) continue;
-                auto key = line.substr(0, colon);
-                auto value = line.substr(colon + 2);
-                if (value.ends_with('\r')) {
-                    value = value.substr(0, value.size() - 1);
-                }
-                // Create a new vector and add to it or add to an already existing one
-                if (headers.contains(key)) {
-                    headers.at(key).push_back(value);
-                } else {
-                    headers.insert_or_assign(key, std::vector{value});
-                }
-            }
-            return size * nitems;
-        }));
+bool WebRequest::Impl::Transfer::openFile() {
+    auto const& path = *impl->m_downloadPath;
+    file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        error = fmt::format("Unable to open {} for writing", path.string());
+        return false;
+    }
+    fileCreated = true;
+    return true;
+}
 
-        // Track & post progress on the Promise
-        curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, &responseData);
-        curl_easy_setopt(curl, CURLOPT_PROGRESSFUNCTION, +[](void* ptr, double dtotal, double dnow, double utotal, double unow) -> int {
-            auto data = static_cast<ResponseData*>(ptr);
+void WebRequest::Impl::Transfer::startBody(WebResponse const& response) {
+    if (impl->m_onResponseStart && !impl->m_onResponseStart(response)) {
+        bodyWorker->fail();
+    }
+}
 
-            // Check for cancellation and abort if so
-            if (data->hasBeenCancelled()) {
-                return 1;
-            }
+void WebRequest::Impl::Transfer::writeBody(std::span<const uint8_t> chunk) {
+    if (bodyWorker->hasFailed()) {
+        return;
+    }
+    if (impl->m_downloadPath) {
+        if (!file.is_open() && !this->openFile()) {
+            bodyWorker->fail();
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+        if (!file) {
+            error = fmt::format("Unable to write to {}", impl->m_downloadPath->string());
+            bodyWorker->fail();
+        }
+        return;
+    }
+    if (impl->m_onResponseChunk) {
+        if (!impl->m_onResponseChunk(chunk)) {
+            bodyWorker->fail();
+        }
+        return;
+    }
+    // Only onResponseStart was set, so the body is still collected into 
+    // the response, just on the worker instead of curl's thread
+    auto& target = response.m_impl->m_data;
+    target.insert(target.end(), chunk.begin(), chunk.end());
+}
 
-            // Post progress to Promise listener
-            auto progress = WebProgress();
-            progress.m_impl->m_downloadTotal = dtotal;
-            progress.m_impl->m_downloadCurrent = dnow;
-            progress.m_impl->m_uploadTotal = utotal;
-            progress.m_impl->m_uploadCurrent = unow;
-            data->progress(std::move(progress));
+bool WebRequest::Impl::Transfer::tryCache() {
+    if (!impl->isCacheable()) {
+        return false;
+    }
+    cached = WebCache::get()->load(url);
+    if (!cached) {
+        return false;
+    }
+    // The cached response was for a request with different headers
+    if (cached->vary != impl->getVaryValues(cached->headers)) {
+        cached.reset();
+        return false;
+    }
+    if (impl->m_cachePolicy == CachePolicy::Default && cached->isFresh()) {
+        finish(this->responseFromCache());
+        return true;
+    }
 
-            // Continue as normal
-            return 0;
-        });
+    // Ask the server to only send the response if it has changed
+    if (auto etag = findHeader(cached->headers, "ETag")) {
+        headers = curl_slist_append(headers, ("If-None-Match: " + *etag).c_str());
+    }
+    if (auto lastModified = findHeader(cached->headers, "Last-Modified")) {
+        headers = curl_slist_append(headers, ("If-Modified-Since: " + *lastModified).c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    return false;
+}
+
+WebResponse WebRequest::Impl::Transfer::responseFromCache() const {
+    auto res = WebResponse();
+    res.m_impl->m_code = cached->code;
+    res.m_impl->m_headers = cached->headers;
+    res.m_impl->m_data = cached->body;
+    return res;
+}
 
-        // Make the actual web request
-        auto curlResponse = curl_easy_perform(curl);
+void WebRequest::Impl::Transfer::complete(CURLcode result) {
+    // Get the response code; note that this will be invalid if the 
+    // result is not CURLE_OK
+    long code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+    response.m_impl->m_code = static_cast<int>(code);
+
+    // A body callback may have asked to abort after curl already had the 
+    // whole body
+    if (result == CURLE_OK && bodyWorker && bodyWorker->hasFailed()) {
+        result = CURLE_WRITE_ERROR;
+    }
 
-        // Get the response code; note that this will be invalid if the 
-        // curlResponse is not CURLE_OK
-        long code = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
-        responseData.response.m_impl->m_code = static_cast<int>(code);
+    // Check if the request failed on curl's side or because of cancellation
+    if (result != CURLE_OK) {
+        if (hasBeenCancelled()) {
+            finish(WebTask::Cancel());
+        }
+        else if (error) {
+            finish(impl->makeError(-1, *error));
+        }
+        else {
+            finish(impl->makeError(-1, "Curl failed: " + std::string(curl_easy_strerror(result))));
+        }
+        return;
+    }
 
-        // Free up curl memory
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+    // Successful responses with an empty body still produce the file
+    if (impl->m_downloadPath && response.ok()) {
+        if (!file.is_open() && !this->openFile()) {
+            finish(impl->makeError(-1, *error));
+            return;
+        }
+        file.close();
+        if (!file) {
+            finish(impl->makeError(-1, fmt::format("Unable to write to {}", impl->m_downloadPath->string())));
+            return;
+        }
+        keepFile = true;
+    }
 
-        // Check if the request failed on curl's side or because of cancellation
-        if (curlResponse != CURLE_OK) {
-            if (hasBeenCancelled()) {
-                return WebTask::Cancel();
-            }
-            else {
-                return impl->makeError(-1, "Curl failed: " + std::string(curl_easy_strerror(curlResponse)));
+    if (impl->isCacheable()) {
+        // The cached response is still up to date, so use it along with 
+        // any headers the server updated
+        if (code == 304 && cached) {
+            for (auto const& [name, values] : response.m_impl->m_headers) {
+                if (headerNameEquals(name, "Content-Length")) {
+                    continue;
+                }
+                std::erase_if(cached->headers, [&](auto const& pair) {
+                    return headerNameEquals(pair.first, name);
+                });
+                cached->headers.insert_or_assign(name, values);
             }
+            WebCache::get()->store(url, cached->code, cached->headers, cached->body, cached->vary);
+            finish(this->responseFromCache());
+            return;
         }
-        
-        // Check if the response was an error code
-        if (code >= 400 && code <= 600) {
-            return std::move(responseData.response);
+        if (code == 200) {
+            auto const& headers = response.m_impl->m_headers;
+            WebCache::get()->store(url, response.m_impl->m_code, headers, response.m_impl->m_data, impl->getVaryValues(headers));
         }
+    }
 
-        // Otherwise resolve with success :-)
-        return std::move(responseData.response);
-    }, fmt::format("{} request to {}", method, url));
+    // Otherwise resolve with the response, even if it's an error code
+    finish(std::move(response));
+}
+
+WebTask WebRequest::send(std::string_view method, std::string_view url) {
+    m_impl->m_method = method;
+    m_impl->m_url = url;
+
+    auto spawned = WebTask::spawn(fmt::format("{} request to {}", method, url));
+    auto transfer = Impl::createTransfer(
+        m_impl, std::get<1>(spawned), std::get<2>(spawned), std::get<3>(spawned)
+    );
+    if (transfer->error) {
+        transfer->finish(m_impl->makeError(-1, *transfer->error));
+    }
+    else if (m_impl->isCacheable()) {
+        // Looking the request up reads from disk, so it's done on the 
+        // cache's worker instead of here or on the networking thread
+        Impl::Worker::cache()->push([transfer] {
+            if (!transfer->tryCache()) {
+                Impl::Manager::get()->enqueue(transfer);
+            }
+        });
+    }
+    else {
+        Impl::Manager::get()->enqueue(std::move(transfer));
+    }
+    return std::get<0>(spawned);
 }
 WebTask WebRequest::post(std::string_view url) {
     return this->send("POST", url);
@@ -603,19 +1630,52 @@ WebRequest& WebRequest::acceptEncoding(std::string_view str) {
 }
 
 WebRequest& WebRequest::body(ByteVector raw) {
-    m_impl->m_body = raw;
+    m_impl->clearBody();
+    m_impl->m_body = std::move(raw);
     return *this;
 }
 WebRequest& WebRequest::bodyString(std::string_view str) {
+    m_impl->clearBody();
     m_impl->m_body = ByteVector { str.begin(), str.end() };
     return *this;
 }
 WebRequest& WebRequest::bodyJSON(matjson::Value const& json) {
     this->header("Content-Type", "application/json");
     std::string str = json.dump(matjson::NO_INDENTATION);
+    m_impl->clearBody();
     m_impl->m_body = ByteVector { str.begin(), str.end() };
     return *this;
 }
+WebRequest& WebRequest::bodyFile(std::filesystem::path const& path) {
+    m_impl->clearBody();
+    m_impl->m_bodyFile = path;
+    return *this;
+}
+WebRequest& WebRequest::bodyMultipart(MultipartForm const& form) {
+    m_impl->clearBody();
+    // Copy the list of parts so later changes to the form don't affect this 
+    // request; the contents of the parts are shared
+    m_impl->m_multipart = std::make_shared<MultipartForm::Impl const>(*form.m_impl);
+    return *this;
+}
+
+WebRequest& WebRequest::cachePolicy(CachePolicy policy) {
+    m_impl->m_cachePolicy = policy;
+    return *this;
+}
+
+WebRequest& WebRequest::onResponseChunk(std::function<bool(std::span<const uint8_t>)> callback) {
+    m_impl->m_onResponseChunk = std::move(callback);
+    return *this;
+}
+WebRequest& WebRequest::downloadInto(std::filesystem::path const& path) {
+    m_impl->m_downloadPath = path;
+    return *this;
+}
+WebRequest& WebRequest::onResponseStart(std::function<bool(WebResponse const&)> callback) {
+    m_impl->m_onResponseStart = std::move(callback);
+    return *this;
+}
 
 size_t WebRequest::getID() const {
     return m_impl->m_id;
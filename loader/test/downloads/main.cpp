@@ -0,0 +1,722 @@
+// Tests downloading mod packages against a local server, using the same code
+// the loader downloads them with. The resume scenarios cut the first attempt
+// off halfway, then check what the next attempt asks the server for and that
+// the package it ends up with is intact. The delta update scenarios update an
+// installed package, checking that only the changed parts are requested and
+// that falling back to the whole package works. Only runs when the game is
+// launched with --geode:geode.downloads-test.run
+
+// The server has to be included before anything pulls in windows.h
+#include "../web-bench/LoopbackServer.hpp"
+
+#include <server/DeltaUpdate.hpp>
+#include <server/ResumableDownload.hpp>
+#include <Geode/Loader.hpp>
+#include <Geode/utils/file.hpp>
+#include <mutex>
+#include <random>
+
+using namespace geode::prelude;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+// A stand-in for a mod package on the server, which can be resumed with range
+// requests unless told otherwise
+static constexpr size_t PACKAGE_SIZE = 8 * 1024 * 1024;
+static constexpr std::string_view PACKAGE_ETAG = "\"test-package\"";
+static std::string const PACKAGE_ID = "geode.downloads-test-package";
+
+enum class RangeMode {
+    Honor,
+    // Send the whole package with a 200 like servers without range support
+    Ignore,
+    // Answer every range with a 416
+    Refuse,
+};
+
+struct PackageState {
+    std::mutex mutex;
+    RangeMode mode = RangeMode::Honor;
+    // Cut the next response off halfway through the body
+    bool dropNext = false;
+    std::vector<LoopbackRequest> requests;
+};
+static PackageState s_package;
+
+static std::string const& getPackage() {
+    static auto const package = [] {
+        std::string data(PACKAGE_SIZE, '\0');
+        std::mt19937 rng(4321);
+        for (auto& c : data) {
+            c = static_cast<char>(rng());
+        }
+        return data;
+    }();
+    return package;
+}
+static std::string const& getPackageHash() {
+    static auto const hash = [] {
+        auto const& package = getPackage();
+        IncrementalHash hash;
+        hash.update(std::span(reinterpret_cast<uint8_t const*>(package.data()), package.size()));
+        return hash.finish();
+    }();
+    return hash;
+}
+
+static LoopbackResponse servePackage(LoopbackRequest const& request) {
+    auto const& package = getPackage();
+    std::unique_lock lock(s_package.mutex);
+    s_package.requests.push_back(request);
+
+    LoopbackResponse response {
+        .headers = {
+            { "Content-Type", "application/zip" },
+            { "ETag", std::string(PACKAGE_ETAG) },
+        },
+    };
+    size_t start = 0;
+    auto range = request.header("Range");
+    if (range && s_package.mode != RangeMode::Ignore) {
+        // Only "bytes=<start>-" is needed here
+        constexpr std::string_view PREFIX = "bytes=";
+        std::optional<size_t> from;
+        if (range->starts_with(PREFIX) && range->ends_with("-")) {
+            auto parsed = numFromString<size_t>(
+                std::string_view(*range).substr(PREFIX.size(), range->size() - PREFIX.size() - 1)
+            );
+            if (parsed) {
+                from = parsed.unwrap();
+            }
+        }
+        if (s_package.mode == RangeMode::Refuse || !from || *from >= package.size()) {
+            response.code = 416;
+            response.headers.push_back({ "Content-Range", fmt::format("bytes */{}", package.size()) });
+            return response;
+        }
+        start = *from;
+        response.code = 206;
+        response.headers.push_back({
+            "Content-Range", fmt::format("bytes {}-{}/{}", start, package.size() - 1, package.size())
+        });
+    }
+    response.body = package.substr(start);
+    if (std::exchange(s_package.dropNext, false)) {
+        response.dropAfter = response.body.size() / 2;
+    }
+    return response;
+}
+
+static std::optional<LoopbackRequest> getPackageRequest(size_t index) {
+    std::unique_lock lock(s_package.mutex);
+    if (index < s_package.requests.size()) {
+        return s_package.requests[index];
+    }
+    return std::nullopt;
+}
+
+static std::filesystem::path getDownloadsDir() {
+    return Mod::get()->getSaveDir() / "downloads";
+}
+static std::filesystem::path getPartPath() {
+    return getDownloadsDir() / (PACKAGE_ID + ".geode.part");
+}
+static void clearDownloadsDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(getDownloadsDir(), ec);
+    std::filesystem::create_directories(getDownloadsDir(), ec);
+}
+
+// Claim and open the file to download the package into, like ModDownload 
+// does before starting a download
+static Result<server::ClaimedDownload> claimPackage() {
+    auto claimed = server::claimDownloadFile(getDownloadsDir(), PACKAGE_ID, getPackageHash());
+    if (!claimed.file->open(claimed.partial ? claimed.partial->size : 0)) {
+        return Err("Unable to open {}", claimed.file->path.string());
+    }
+    return Ok(std::move(claimed));
+}
+
+// Let go of the file, and wait for the request to do the same since it may 
+// hold on to it for a moment after finishing. The file is only cleaned up 
+// once nothing holds it anymore
+static Result<> releasePackage(server::ClaimedDownload& claimed) {
+    std::weak_ptr<server::DownloadFile> file = claimed.file;
+    claimed.file.reset();
+    auto until = Clock::now() + 5s;
+    while (!file.expired()) {
+        if (Clock::now() > until) {
+            return Err("Download file was never released");
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return Ok();
+}
+
+// Download the package into a claimed file. Returns the status code, or -1 
+// if the request failed without one
+static int downloadPackage(server::ClaimedDownload const& claimed) {
+    auto req = web::WebRequest();
+    req.timeout(30s);
+    server::setUpDownloadRequest(req, claimed.file, claimed.partial, getPackageHash());
+
+    auto task = req.get(LoopbackServer::get()->url("/package"));
+    while (task.isPending()) {
+        std::this_thread::sleep_for(1ms);
+    }
+    auto response = task.getFinishedValue();
+    if (!response) {
+        return -1;
+    }
+    if (!response->ok()) {
+        server::handleFailedDownload(*claimed.file, *response);
+    }
+    return response->code();
+}
+
+struct ResumeScenario {
+    std::string name;
+    RangeMode mode;
+    // What the server should answer the retry with
+    int retryCode;
+};
+
+static Result<> runResumeScenario(ResumeScenario const& scenario) {
+    LoopbackServer::get()->setOptions({});
+    {
+        std::unique_lock lock(s_package.mutex);
+        s_package.mode = scenario.mode;
+        s_package.dropNext = true;
+        s_package.requests.clear();
+    }
+    clearDownloadsDir();
+    auto start = Clock::now();
+
+    // Letting go of the file after the connection drops keeps what was 
+    // received so far
+    {
+        GEODE_UNWRAP_INTO(auto first, claimPackage());
+        if (first.partial) {
+            return Err("Found a partial download before the first attempt");
+        }
+        if (auto code = downloadPackage(first); code != -1) {
+            return Err("Interrupted request finished with {}", code);
+        }
+        GEODE_UNWRAP(releasePackage(first));
+    }
+    std::error_code ec;
+    auto offset = std::filesystem::file_size(getPartPath(), ec);
+    if (ec || offset == 0 || offset >= PACKAGE_SIZE) {
+        return Err("Interrupted request kept {} bytes", ec ? 0 : offset);
+    }
+    if (server::findPartialDownload(getPartPath(), "not the package hash")) {
+        return Err("Partial download would be resumed for a different package");
+    }
+
+    GEODE_UNWRAP_INTO(auto claimed, claimPackage());
+    if (!claimed.partial || claimed.partial->size != offset) {
+        return Err("Partial download of {} bytes wasn't picked up", offset);
+    }
+    if (claimed.partial->validator != PACKAGE_ETAG) {
+        return Err("Partial download didn't record the ETag");
+    }
+
+    // While one attempt has the partial download, another one for the same 
+    // mod has to leave it alone
+    {
+        auto other = server::claimDownloadFile(getDownloadsDir(), PACKAGE_ID, getPackageHash());
+        if (other.partial || other.file->path == claimed.file->path) {
+            return Err("Partial download was claimed twice");
+        }
+    }
+
+    auto code = downloadPackage(claimed);
+    auto retry = getPackageRequest(1);
+    if (!retry) {
+        return Err("Retry never reached the server");
+    }
+    auto range = retry->header("Range");
+    if (range != fmt::format("bytes={}-", offset)) {
+        return Err("Retry asked for '{}' instead of the rest after {} bytes", range.value_or(""), offset);
+    }
+    if (retry->header("If-Range") != PACKAGE_ETAG) {
+        return Err("Retry didn't check that the package is unchanged");
+    }
+    if (code != scenario.retryCode) {
+        return Err("Retry got {} instead of {}", code, scenario.retryCode);
+    }
+
+    // Nothing can be continued after a 416, so the data is thrown away and 
+    // the next attempt has to ask for the whole package
+    if (code == 416) {
+        GEODE_UNWRAP(releasePackage(claimed));
+        if (std::filesystem::exists(getPartPath()) || std::filesystem::exists(server::getPartialInfoPath(getPartPath()))) {
+            return Err("Kept the data the server refused to continue from");
+        }
+        GEODE_UNWRAP_INTO(claimed, claimPackage());
+        code = downloadPackage(claimed);
+        auto restart = getPackageRequest(2);
+        if (!restart || restart->header("Range")) {
+            return Err("Attempt after the 416 still asked for a range");
+        }
+        if (code != 200) {
+            return Err("Attempt after the 416 got {}", code);
+        }
+    }
+
+    GEODE_UNWRAP(server::verifyDownload(*claimed.file, PACKAGE_ID, getPackageHash()));
+    auto size = std::filesystem::file_size(claimed.file->path, ec);
+    if (ec || size != PACKAGE_SIZE) {
+        return Err("Downloaded {} bytes instead of {}", ec ? 0 : size, PACKAGE_SIZE);
+    }
+    log::info(
+        "{}: cut off after {} bytes, finished in {:.1f} ms",
+        scenario.name, offset, std::chrono::duration<double, std::milli>(Clock::now() - start).count()
+    );
+    return Ok();
+}
+
+// Partial downloads that were left alone for too long are deleted on startup
+static Result<> runCleanupScenario() {
+    clearDownloadsDir();
+    auto createPart = [](std::string const& name, std::chrono::hours age) -> Result<std::filesystem::path> {
+        auto path = getDownloadsDir() / name;
+        GEODE_UNWRAP(file::writeString(path, "partial"));
+        GEODE_UNWRAP(file::writeString(server::getPartialInfoPath(path), "{}"));
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - age, ec);
+        if (ec) {
+            return Err("Unable to age {}", name);
+        }
+        return Ok(path);
+    };
+    GEODE_UNWRAP_INTO(auto stale, createPart("stale.geode.part", server::PARTIAL_DOWNLOAD_MAX_AGE + 1h));
+    GEODE_UNWRAP_INTO(auto recent, createPart("recent.geode.part", server::PARTIAL_DOWNLOAD_MAX_AGE - 1h));
+
+    server::removeStalePartialDownloads(getDownloadsDir());
+    if (std::filesystem::exists(stale) || std::filesystem::exists(server::getPartialInfoPath(stale))) {
+        return Err("Stale partial download was kept");
+    }
+    if (!std::filesystem::exists(recent) || !std::filesystem::exists(server::getPartialInfoPath(recent))) {
+        return Err("Recent partial download was deleted");
+    }
+    return Ok();
+}
+
+// Zip entries laid out the way packaging tools write them: stored, with the 
+// sizes in the local headers and no data descriptors, so delta updates can 
+// find and reuse them
+struct PackageEntry {
+    std::string name;
+    std::string data;
+};
+struct Package {
+    std::string data;
+    // Where each entry's data is in the package, in the same order
+    std::vector<std::pair<size_t, size_t>> entryData;
+};
+
+static std::string randomData(size_t size, uint32_t seed) {
+    std::string data(size, '\0');
+    std::mt19937 rng(seed);
+    for (auto& c : data) {
+        c = static_cast<char>(rng());
+    }
+    return data;
+}
+
+static uint32_t crc32(std::string_view data) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (auto c : data) {
+        crc ^= static_cast<uint8_t>(c);
+        for (size_t i = 0; i < 8; i += 1) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static Package createPackage(std::vector<PackageEntry> const& entries) {
+    auto put16 = [](std::string& out, uint16_t value) {
+        out.push_back(static_cast<char>(value & 0xFF));
+        out.push_back(static_cast<char>(value >> 8));
+    };
+    auto put32 = [&](std::string& out, uint32_t value) {
+        put16(out, static_cast<uint16_t>(value & 0xFFFF));
+        put16(out, static_cast<uint16_t>(value >> 16));
+    };
+
+    Package package;
+    std::string directory;
+    for (auto const& entry : entries) {
+        auto offset = package.data.size();
+        auto crc = crc32(entry.data);
+        auto size = static_cast<uint32_t>(entry.data.size());
+        auto nameLength = static_cast<uint16_t>(entry.name.size());
+
+        // Local header: version, flags, method, time, date, CRC, sizes, name 
+        // and extra field lengths
+        auto& out = package.data;
+        put32(out, 0x04034b50);
+        put16(out, 20);
+        put16(out, 0);
+        put16(out, 0);
+        put16(out, 0);
+        put16(out, 0);
+        put32(out, crc);
+        put32(out, size);
+        put32(out, size);
+        put16(out, nameLength);
+        put16(out, 0);
+        out += entry.name;
+        package.entryData.push_back({ out.size(), out.size() + size });
+        out += entry.data;
+
+        // Central directory header: the same plus comment length, disk, 
+        // attributes and where the local header is
+        put32(directory, 0x02014b50);
+        put16(directory, 20);
+        put16(directory, 20);
+        put16(directory, 0);
+        put16(directory, 0);
+        put16(directory, 0);
+        put16(directory, 0);
+        put32(directory, crc);
+        put32(directory, size);
+        put32(directory, size);
+        put16(directory, nameLength);
+        put16(directory, 0);
+        put16(directory, 0);
+        put16(directory, 0);
+        put16(directory, 0);
+        put32(directory, 0);
+        put32(directory, static_cast<uint32_t>(offset));
+        directory += entry.name;
+    }
+
+    auto directoryOffset = package.data.size();
+    package.data += directory;
+    auto count = static_cast<uint16_t>(entries.size());
+    put32(package.data, 0x06054b50);
+    put16(package.data, 0);
+    put16(package.data, 0);
+    put16(package.data, count);
+    put16(package.data, count);
+    put32(package.data, static_cast<uint32_t>(directory.size()));
+    put32(package.data, static_cast<uint32_t>(directoryOffset));
+    put16(package.data, 0);
+    return package;
+}
+
+static std::string createModJson(std::string_view version) {
+    return matjson::makeObject({
+        { "geode", Loader::get()->getVersion().toNonVString() },
+        { "id", "geode.delta-test" },
+        { "name", "Delta Test" },
+        { "version", std::string(version) },
+        { "developer", "Geode Team" },
+    }).dump();
+}
+
+struct DeltaServerState {
+    std::mutex mutex;
+    bool honorRanges = true;
+    std::string package;
+    std::vector<std::string> ranges;
+};
+static DeltaServerState s_delta;
+
+// Parse "bytes=<start>-<end>", "bytes=<start>-" and "bytes=-<suffix length>" 
+// into where the range starts and ends (exclusive)
+static std::optional<std::pair<size_t, size_t>> parseRange(std::string_view range, size_t size) {
+    constexpr std::string_view PREFIX = "bytes=";
+    auto dash = range.find('-');
+    if (!range.starts_with(PREFIX) || dash == std::string_view::npos) {
+        return std::nullopt;
+    }
+    auto first = range.substr(PREFIX.size(), dash - PREFIX.size());
+    auto last = range.substr(dash + 1);
+    if (first.empty()) {
+        auto suffix = numFromString<size_t>(last);
+        if (!suffix || suffix.unwrap() == 0) {
+            return std::nullopt;
+        }
+        return std::make_pair(size - std::min(suffix.unwrap(), size), size);
+    }
+    auto start = numFromString<size_t>(first);
+    if (!start || start.unwrap() >= size) {
+        return std::nullopt;
+    }
+    auto end = size;
+    if (!last.empty()) {
+        auto parsed = numFromString<size_t>(last);
+        if (!parsed || parsed.unwrap() < start.unwrap()) {
+            return std::nullopt;
+        }
+        end = std::min(parsed.unwrap() + 1, size);
+    }
+    return std::make_pair(start.unwrap(), end);
+}
+
+static LoopbackResponse serveDeltaPackage(LoopbackRequest const& request) {
+    std::unique_lock lock(s_delta.mutex);
+    auto const& package = s_delta.package;
+
+    LoopbackResponse response {
+        .headers = { { "Content-Type", "application/zip" } },
+    };
+    auto range = request.header("Range");
+    if (!range || !s_delta.honorRanges) {
+        response.body = package;
+        return response;
+    }
+    s_delta.ranges.push_back(*range);
+    auto parsed = parseRange(*range, package.size());
+    if (!parsed) {
+        response.code = 416;
+        response.headers.push_back({ "Content-Range", fmt::format("bytes */{}", package.size()) });
+        return response;
+    }
+    auto [start, end] = *parsed;
+    response.code = 206;
+    response.headers.push_back({
+        "Content-Range", fmt::format("bytes {}-{}/{}", start, end - 1, package.size())
+    });
+    response.body = package.substr(start, end - start);
+    return response;
+}
+
+struct DeltaScenario {
+    std::string name;
+    Package installed;
+    Package update;
+    // Which entries of the update are the same as in the installed package
+    std::vector<bool> unchanged;
+    bool honorRanges = true;
+    // Whether the update should be put together from the changed parts, or 
+    // fall back to downloading the whole package
+    bool expectDelta = true;
+};
+
+static Result<> runDeltaScenario(DeltaScenario const& scenario) {
+    LoopbackServer::get()->setOptions({});
+    {
+        std::unique_lock lock(s_delta.mutex);
+        s_delta.honorRanges = scenario.honorRanges;
+        s_delta.package = scenario.update.data;
+        s_delta.ranges.clear();
+    }
+    clearDownloadsDir();
+    auto start = Clock::now();
+
+    auto installedPath = getDownloadsDir() / "installed.geode";
+    GEODE_UNWRAP(file::writeBinary(installedPath, ByteVector(scenario.installed.data.begin(), scenario.installed.data.end())));
+    auto updateHash = calculateHash(std::span(
+        reinterpret_cast<uint8_t const*>(scenario.update.data.data()), scenario.update.data.size()
+    ));
+
+    // Same as ModDownload, the update is put together in the file the whole 
+    // package would've been downloaded into
+    auto claimed = server::claimDownloadFile(getDownloadsDir(), "geode.delta-test", updateHash);
+    if (!claimed.file->open(0)) {
+        return Err("Unable to open {}", claimed.file->path.string());
+    }
+    claimed.file->keep = false;
+    auto task = server::downloadDeltaUpdate(
+        LoopbackServer::get()->url("/delta/update.geode"), installedPath, "Geode Downloads Test",
+        [file = claimed.file](std::span<const uint8_t> chunk) {
+            return file->write(chunk);
+        }
+    );
+    while (task.isPending()) {
+        std::this_thread::sleep_for(1ms);
+    }
+    auto result = task.getFinishedValue();
+    if (!result) {
+        return Err("Delta update was cancelled");
+    }
+
+    std::vector<std::string> ranges;
+    {
+        std::unique_lock lock(s_delta.mutex);
+        ranges = s_delta.ranges;
+    }
+    auto size = scenario.update.data.size();
+
+    if (!scenario.expectDelta) {
+        if (result->isOk()) {
+            return Err("Delta update was used instead of falling back");
+        }
+        // Only the end of the package should've been downloaded to find out 
+        // that it isn't worth it
+        if (scenario.honorRanges && (ranges.size() != 1 || !ranges[0].starts_with("bytes=-"))) {
+            return Err("Requested {} ranges before falling back", ranges.size());
+        }
+
+        // Download the whole package instead, like ModDownload does
+        claimed.file->keep = true;
+        if (!claimed.file->restart()) {
+            return Err("Unable to restart the download");
+        }
+        auto req = web::WebRequest();
+        req.timeout(30s);
+        server::setUpDownloadRequest(req, claimed.file, std::nullopt, updateHash);
+        auto fallback = req.get(LoopbackServer::get()->url("/delta/update.geode"));
+        while (fallback.isPending()) {
+            std::this_thread::sleep_for(1ms);
+        }
+        auto response = fallback.getFinishedValue();
+        if (!response || response->code() != 200) {
+            return Err("Falling back to the whole package got {}", response ? response->code() : -1);
+        }
+        GEODE_UNWRAP(server::verifyDownload(*claimed.file, "geode.delta-test", updateHash));
+        GEODE_UNWRAP(releasePackage(claimed));
+        log::info(
+            "{}: fell back ({}), finished in {:.1f} ms",
+            scenario.name, result->unwrapErr(),
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count()
+        );
+        return Ok();
+    }
+
+    if (result->isErr()) {
+        return Err("Delta update failed: {}", result->unwrapErr());
+    }
+    GEODE_UNWRAP(server::verifyDownload(*claimed.file, "geode.delta-test", updateHash));
+    GEODE_UNWRAP_INTO(auto rebuilt, file::readBinary(claimed.file->path));
+    if (calculateHash(rebuilt) != updateHash) {
+        return Err("Rebuilt package on disk doesn't match the update");
+    }
+
+    // The first request reads the end of the package to find the central 
+    // directory, which may include the end of an unchanged entry. After 
+    // that, only the changed parts should be asked for
+    if (ranges.empty() || !ranges[0].starts_with("bytes=-")) {
+        return Err("Delta update didn't start from the end of the package");
+    }
+    size_t requested = 0;
+    for (auto const& range : std::span(ranges).subspan(1)) {
+        auto parsed = parseRange(range, size);
+        if (!parsed) {
+            return Err("Delta update asked for an invalid range '{}'", range);
+        }
+        auto [from, to] = *parsed;
+        requested += to - from;
+        for (size_t i = 0; i < scenario.unchanged.size(); i += 1) {
+            auto [dataStart, dataEnd] = scenario.update.entryData[i];
+            if (scenario.unchanged[i] && from < dataEnd && dataStart < to) {
+                return Err("Range '{}' includes unchanged entry {}", range, i);
+            }
+        }
+    }
+    size_t changed = 0;
+    for (size_t i = 0; i < scenario.unchanged.size(); i += 1) {
+        if (!scenario.unchanged[i]) {
+            changed += scenario.update.entryData[i].second - scenario.update.entryData[i].first;
+        }
+    }
+    if (requested < changed) {
+        return Err("Only {} bytes were requested, but {} bytes changed", requested, changed);
+    }
+    GEODE_UNWRAP(releasePackage(claimed));
+    log::info(
+        "{}: {} of {} bytes requested in {} ranges, finished in {:.1f} ms",
+        scenario.name, requested, size, ranges.size() - 1,
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count()
+    );
+    return Ok();
+}
+
+static std::vector<DeltaScenario> createDeltaScenarios() {
+    // Large enough to be worth reusing and too incompressible to be stored 
+    // any other way
+    auto binary = randomData(1024 * 1024, 1);
+    auto sprites = randomData(1024 * 1024, 2);
+    auto sounds = randomData(512 * 1024, 3);
+    auto logo = randomData(100 * 1024, 4);
+
+    auto installed = createPackage({
+        { "mod.json", createModJson("1.0.0") },
+        { "geode.delta-test.dll", binary },
+        { "resources/sprites.png", sprites },
+        { "resources/sounds.ogg", sounds },
+        { "logo.png", logo },
+    });
+    // Usually only the binary changes between versions
+    auto update = createPackage({
+        { "mod.json", createModJson("1.1.0") },
+        { "geode.delta-test.dll", randomData(1024 * 1024, 5) },
+        { "resources/sprites.png", sprites },
+        { "resources/sounds.ogg", sounds },
+        { "logo.png", logo },
+    });
+    auto rewrite = createPackage({
+        { "mod.json", createModJson("2.0.0") },
+        { "geode.delta-test.dll", randomData(1024 * 1024, 6) },
+        { "resources/sprites.png", randomData(1024 * 1024, 7) },
+        { "resources/sounds.ogg", randomData(512 * 1024, 8) },
+        { "logo.png", logo },
+    });
+    std::vector<bool> unchanged = { false, false, true, true, true };
+
+    return {
+        { .name = "Delta update", .installed = installed, .update = update, .unchanged = unchanged },
+        {
+            .name = "Delta update without range support", .installed = installed, .update = update,
+            .unchanged = unchanged, .honorRanges = false, .expectDelta = false,
+        },
+        {
+            .name = "Delta update of a mostly changed package", .installed = installed, .update = rewrite,
+            .unchanged = { false, false, false, false, true }, .expectDelta = false,
+        },
+    };
+}
+
+$on_mod(Loaded) {
+    if (!Mod::get()->getLaunchFlag("run")) {
+        return;
+    }
+    std::thread([] {
+        utils::thread::setName("Downloads Test");
+
+        auto server = LoopbackServer::get();
+        server->route("/package", &servePackage);
+        server->route("/delta/", &serveDeltaPackage);
+        if (auto res = server->start(); !res) {
+            log::error("Unable to start server: {}", res.unwrapErr());
+            return;
+        }
+
+        size_t failed = 0;
+        std::vector<ResumeScenario> scenarios = {
+            { .name = "Resume download", .mode = RangeMode::Honor, .retryCode = 206 },
+            { .name = "Resume without range support", .mode = RangeMode::Ignore, .retryCode = 200 },
+            { .name = "Resume refused", .mode = RangeMode::Refuse, .retryCode = 416 },
+        };
+        for (auto const& scenario : scenarios) {
+            if (auto res = runResumeScenario(scenario); !res) {
+                log::error("{} failed: {}", scenario.name, res.unwrapErr());
+                failed += 1;
+            }
+        }
+        for (auto const& scenario : createDeltaScenarios()) {
+            if (auto res = runDeltaScenario(scenario); !res) {
+                log::error("{} failed: {}", scenario.name, res.unwrapErr());
+                failed += 1;
+            }
+        }
+        if (auto res = runCleanupScenario(); !res) {
+            log::error("Partial download cleanup failed: {}", res.unwrapErr());
+            failed += 1;
+        }
+
+        std::error_code ec;
+        std::filesystem::remove_all(getDownloadsDir(), ec);
+        if (failed) {
+            log::error("Downloads test failed ({} scenarios)", failed);
+        }
+        else {
+            log::info("Downloads test passed");
+        }
+    }).detach();
+}
@@ -0,0 +1,228 @@
+// Tests the offline mod index against a local stand-in for the index server.
+// Syncs the mirror, caches a lookup of two mods that the listing doesn't have
+// details for, then updates only one of them on the server and syncs again.
+// Only the updated mod should have to be looked up from the server again.
+// Needs the loader to be pointed at the stand-in, so run it with
+//     --geode:geode.index-mirror-test.run
+//     --geode:server-url=http://127.0.0.1:<port>/v1
+//     --geode:mod-index-sync-interval=0
+
+// The server has to be included before anything pulls in windows.h
+#include "../web-bench/LoopbackServer.hpp"
+
+#include <Geode/Loader.hpp>
+#include <Geode/ui/GeodeUI.hpp>
+#include <Geode/utils/file.hpp>
+#include <future>
+
+using namespace geode::prelude;
+using namespace std::chrono_literals;
+
+static constexpr std::string_view MOD_A = "geode.mirror-test-a";
+static constexpr std::string_view MOD_B = "geode.mirror-test-b";
+
+// Which version of the index the server is handing out
+static std::atomic_int s_stage = 1;
+static std::mutex s_lookupsMutex;
+static std::unordered_map<std::string, size_t> s_lookups;
+
+static size_t getLookups(std::string_view id) {
+    std::unique_lock lock(s_lookupsMutex);
+    auto it = s_lookups.find(std::string(id));
+    return it != s_lookups.end() ? it->second : 0;
+}
+
+// Just enough of a listing for the loader to accept it. There's no "about",
+// so looking the mod up still has to go to the server
+static matjson::Value makeListing(std::string_view id, std::string_view description, std::string_view updatedAt) {
+    return matjson::makeObject({
+        { "id", std::string(id) },
+        { "featured", false },
+        { "download_count", 10 },
+        { "updated_at", std::string(updatedAt) },
+        { "developers", std::vector<matjson::Value> {
+            matjson::makeObject({
+                { "username", "geode" },
+                { "display_name", "Geode Team" },
+                { "is_owner", true },
+            }),
+        } },
+        { "versions", std::vector<matjson::Value> {
+            matjson::makeObject({
+                { "mod_id", std::string(id) },
+                { "name", std::string(id) },
+                { "description", std::string(description) },
+                { "version", "1.0.0" },
+                { "geode", Loader::get()->getVersion().toNonVString() },
+                { "gd", matjson::makeObject({ { GEODE_PLATFORM_SHORT_IDENTIFIER, "*" } }) },
+                { "download_link", "" },
+                { "download_count", 10 },
+                { "hash", "" },
+                { "api", false },
+            }),
+        } },
+    });
+}
+
+static LoopbackResponse respondWithPayload(matjson::Value const& payload) {
+    return LoopbackResponse {
+        .headers = { { "Content-Type", "application/json" } },
+        .body = matjson::makeObject({ { "error", "" }, { "payload", payload } }).dump(matjson::NO_INDENTATION),
+    };
+}
+
+static void addRoutes(LoopbackServer* server) {
+    // Looking up a single mod. The answer doesn't matter, only that the
+    // loader had to ask
+    server->route("/v1/mods/", [](LoopbackRequest const& request) {
+        auto id = request.path.substr(std::string_view("/v1/mods/").size());
+        if (id.find('/') == std::string::npos) {
+            std::unique_lock lock(s_lookupsMutex);
+            s_lookups[id] += 1;
+        }
+        return LoopbackResponse { .code = 404 };
+    });
+    // Newest updates first, like the real server sorts for syncing
+    server->route("/v1/mods", [](LoopbackRequest const&) {
+        std::vector<matjson::Value> mods;
+        if (s_stage == 1) {
+            mods.push_back(makeListing(MOD_A, "First description", "2024-01-02T00:00:00Z"));
+            mods.push_back(makeListing(MOD_B, "First description", "2024-01-01T00:00:00Z"));
+        }
+        else {
+            mods.push_back(makeListing(MOD_A, "Updated description", "2024-02-01T00:00:00Z"));
+            mods.push_back(makeListing(MOD_B, "First description", "2024-01-01T00:00:00Z"));
+        }
+        return respondWithPayload(matjson::makeObject({
+            { "count", mods.size() },
+            { "data", mods },
+        }));
+    });
+    server->route("/v1/detailed-tags", [](LoopbackRequest const&) {
+        return respondWithPayload(std::vector<matjson::Value>());
+    });
+}
+
+// Run something on the main thread and wait for it
+template <class F>
+static void onMainThread(F&& func) {
+    std::promise<void> done;
+    queueInMainThread([&] {
+        func();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+static bool waitFor(std::function<bool()> condition, std::chrono::milliseconds timeout = 10s) {
+    auto until = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > until) {
+            return false;
+        }
+        std::this_thread::sleep_for(50ms);
+    }
+    return true;
+}
+
+static Result<> runTest() {
+    auto loader = Loader::get()->getLoadedMod("geode.loader");
+    auto mirrorPath = loader->getSaveDir() / "mod-index.json";
+    auto wasEnabled = loader->getSettingValue<bool>("offline-mod-index");
+
+    // The mirror syncs when it's turned on and out of date, which it always
+    // is with a sync interval of 0
+    auto sync = [&](std::string_view expected) -> Result<> {
+        onMainThread([&] {
+            loader->setSettingValue<bool>("offline-mod-index", false);
+            loader->setSettingValue<bool>("offline-mod-index", true);
+        });
+        auto synced = waitFor([&] {
+            auto saved = file::readString(mirrorPath);
+            return saved && saved.unwrap().find(expected) != std::string::npos;
+        });
+        if (!synced) {
+            return Err("Mirror was not synced");
+        }
+        // The new copy is only used once it gets to the main thread
+        std::this_thread::sleep_for(1s);
+        return Ok();
+    };
+    auto lookUp = [&] {
+        onMainThread([] {
+            openInfoPopup(std::string(MOD_A));
+            openInfoPopup(std::string(MOD_B));
+        });
+    };
+
+    auto steps = [&]() -> Result<> {
+        GEODE_UNWRAP(sync("First description"));
+
+        lookUp();
+        if (!waitFor([] { return getLookups(MOD_A) == 1 && getLookups(MOD_B) == 1; })) {
+            return Err("Mods were not looked up from the server");
+        }
+
+        s_stage = 2;
+        GEODE_UNWRAP(sync("Updated description"));
+
+        lookUp();
+        waitFor([] { return getLookups(MOD_A) == 2; });
+        // Give an unexpected second lookup of B time to arrive as well
+        std::this_thread::sleep_for(1s);
+
+        if (getLookups(MOD_A) != 2) {
+            return Err("Updated mod was still cached ({} lookups)", getLookups(MOD_A));
+        }
+        if (getLookups(MOD_B) != 1) {
+            return Err("Unchanged mod was dropped from the cache ({} lookups)", getLookups(MOD_B));
+        }
+        return Ok();
+    };
+
+    // Start from nothing, and don't leave a copy of the stand-in's index
+    // behind either way
+    std::error_code ec;
+    std::filesystem::remove(mirrorPath, ec);
+    auto res = steps();
+    onMainThread([&] {
+        loader->setSettingValue<bool>("offline-mod-index", wasEnabled);
+    });
+    std::filesystem::remove(mirrorPath, ec);
+    return res;
+}
+
+$on_mod(Loaded) {
+    if (!Mod::get()->getLaunchFlag("run")) {
+        return;
+    }
+    // The loader reads the server URL once, so the stand-in has to listen on
+    // the port it was given
+    auto url = Loader::get()->getLaunchArgument("server-url").value_or("");
+    constexpr std::string_view PREFIX = "http://127.0.0.1:";
+    Result<uint16_t> port = Err("No port");
+    if (url.starts_with(PREFIX)) {
+        auto end = url.find('/', PREFIX.size());
+        port = numFromString<uint16_t>(std::string_view(url).substr(PREFIX.size(), end - PREFIX.size()));
+    }
+    if (!port) {
+        log::error("Index mirror test needs --geode:server-url=http://127.0.0.1:<port>/v1");
+        return;
+    }
+
+    auto server = LoopbackServer::get();
+    addRoutes(server);
+    if (auto res = server->start(port.unwrap()); !res) {
+        log::error("Unable to start server: {}", res.unwrapErr());
+        return;
+    }
+    std::thread([] {
+        utils::thread::setName("Index Mirror Test");
+        if (auto res = runTest(); !res) {
+            log::error("Index mirror test failed: {}", res.unwrapErr());
+        }
+        else {
+            log::info("Index mirror test passed");
+        }
+    }).detach();
+}
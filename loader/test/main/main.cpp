@@ -175,3 +175,134 @@ struct GJGarageLayerTest2 : Modify<GJGarageLayerTest2, GJGarageLayer> {
         return true;
     }
 };
+
+// Layouts
+#include <cmath>
+#include <random>
+
+// Fingerprints of the layouts generated below as laid out by the AxisLayout 
+// solver before it was made iterative, which the current one must reproduce
+static constexpr uint64_t LAYOUT_FINGERPRINTS[] = {
+    0xb6a3a06571d0a9d0, 0x4c84d41abb904822, 0xd715584ecf4ae893, 0x2b024f2b66eb5e1e,
+    0xac10d38e1d4c8d2c, 0xa8ccbaf46be7107e, 0x4834769f9a20956e, 0xfcfbd280a3f0da98,
+    0xffa2bc15f09474f0, 0x680bd37cffe2387a, 0xec2c06f11693b2f3, 0x90abc0dedf7d3ce5,
+    0x00aa835f96dd7ea3, 0x1d3736a45b98d914, 0x73311f9526b282d2, 0x6d3bb33be4130b58,
+    0x15d3dba870b8d1da, 0xa8afd1fa4c24f35f, 0x791070ec140d9fe3, 0x22854a64ec94c1ea,
+    0xfee0f9991f6bfed7, 0xb4759b5c815b9504, 0x4066c8826d8cbc70, 0xbfffdbcf43e8a949,
+    0x83dd4bee7d83f9eb, 0x0821c5ebfae9b02c, 0xed5ff8b0f9dc0cf5, 0xcdc17b6eb07bcf4c,
+    0x3622ac7ffbd19bd6, 0x11e63baa97dbd492, 0xbbf50958d1ddebb1, 0xb744eceeaed129e1,
+    0xbded5980a20824d5, 0x4e677b9e1764cf99, 0x3271ecf8ec115ade, 0xec0780fa90369460,
+    0xd164f9b5c3e91543, 0xb840c9900eef8eac, 0xfcaf4115878589f4, 0x49d8b8f57ba0ee57,
+    0xda566a07f5d5b7f3, 0x178da8384476b620, 0x9e3554576fc59092, 0x3c17084ab5581f74,
+    0x3680ea24bbf45208, 0x4b1dddaac447818d, 0x504daefa042697ee, 0x5a77310fca0a0650,
+    0xe9d0e44ec83746a3, 0xc073036a4fe4fdad, 0xf4faa91a47e66455, 0x122d2d5b1fa17523,
+    0xff06718566bb04bc, 0xcd3e7999d466e44a, 0x5968c2c595698778, 0x70f598df106b186f,
+    0xa407dd3ccb6b262e, 0xcd3052276b8e25a1, 0xe54caeb6c9fe3203, 0x05f9f151f5758a84,
+    0xaa5411945a7f211d, 0x10f41f59580be50b, 0xa0bb872db24a730a, 0x55c9e6923c969fd4,
+    0xe6de271de2a8c12a, 0xcb7d6b93d1bf05d0, 0xbb04dd176e1f9ac1, 0x9b8ebfbccce76372,
+    0x28d7ecf670a36ed8, 0x046a86ffe0b93337, 0xf207d4ffda3f58d7, 0x82b1bcf062302fdd,
+    0xdb3a1caa5c969870, 0x3ef083163025e146, 0xcb8de99826f39658, 0x65b88f8c7125ffbd,
+    0xe8d48682cad0685a, 0x4e5824eb53daca69, 0x082fcd6495ab23dd, 0xc06a433932ddaf39,
+    0xd11d54d4d8670991, 0x1b7da94ea3ff3508, 0x05f65a86c0b52d47, 0x382c42ef014f9d1e,
+    0xb3ca807956bf8dae, 0x9a32c320d7d8ed2e, 0xd21dad1cf7808ead, 0x793d5ee717717362,
+    0xbdccb8702fc3572e, 0xae2aea5b99423658, 0xcf39e8ed8f850ad8, 0x3dc08931cc279e40,
+    0x6c5483af7dc5708c, 0xdeb439233f53d9f9, 0x45ffd35e5356d14e, 0x824095b588e6e4d7,
+    0x46cd26251f3fe5a7, 0x1c2de2e690d7dba9, 0xde3c728acc5ca76f, 0x3c2f32836c172868,
+    0xd63d929fc1d74185, 0x3ba4c27e8748264d, 0xcfa35630fda1182f, 0x77eab2ca691f9547,
+    0x58ddbd7d56597661, 0x907971061a8700c4, 0x1fb295549e130147, 0x264940ddbfa26830,
+    0xe2cfceb116566f8d, 0x14f348f18176f751, 0xf3b975ad1bcaa1e3, 0x8a44cdf77e666228,
+    0x61a38e39b0cfa38e, 0x8be69a476cc0c7ac, 0x530bae243739ad81, 0x502c920c98fec741,
+    0x6fa37d1e5818439a, 0x3045cc3d7d7db738, 0x84b02d83952cc250, 0xbdedcf9553250a31,
+    0x1328094fd86f5c66, 0xbc9fb1b35509151e, 0x4bfbcdee5d612dab, 0xf40627654c68c8dc,
+    0xc2887f641d76d6bf, 0x38a6ce35aa3c3795, 0x1a0ba795957d5987, 0x12f21f7201e71d47,
+    0xab26af3be21f0bb7, 0xa0bd7e5881f6f55a, 0x7ed2210eb679fa22, 0x0510e2db68ced908,
+    0xee4f5e66edc36ba5, 0xc3b1f4259ef84f88, 0xc8e59708ce2d41d4, 0xfad06bf6722f5a03,
+    0x078923ced36f0eb7, 0x76c5d269223a307b, 0xa0480e6244b9bb2a, 0xaff56dba76dbe407,
+    0xa44ffcbf81eacdb5, 0x7e579c26d6b448a7, 0x1951cfaffcf4a928, 0x49aadfd3e174879b,
+    0xaa9ac83d939163f3, 0x62fd335ecf05ebba, 0xf780e2bb7c8840b8, 0x8f900dedb69ed75b,
+    0xec834a579a4d95d8, 0xa1f6bb1baf612a77, 0xf20ea5332b2b3395, 0xcb3a4f7b60606eb4,
+    0xb12d0900269a3f77, 0x583978d9aec00ce9, 0x1bf50f280cab8d86, 0x42dda709ce490698,
+    0x87d114e718333d07, 0xf56dd5af165671eb, 0xe4dc68459ef5911e, 0x28e77165bb35b8e2,
+    0x594e93f761c088f2, 0x2eba6808045d0727, 0x69e71b2b3c80a87b, 0x8115a3f373d63274,
+    0x371e85192f7fef64, 0xcc8b2cbd43f10c09, 0x34e0665a912d5c74, 0x06cd597a69411659,
+    0x8e1782ed5b17c0c8, 0x3700e3e2326cefd6, 0xf29b7f69aeb33478, 0x94a2e831a11d1833,
+    0x6319c6eae9d090a2, 0x43266f0df40f9f51, 0x28062b7af5682e9e, 0x761af125bda2f63a,
+    0x7296723354fadc8b, 0xd9499b5644574bf3, 0x820ff6e5b5e6149f, 0xd3b3d58b3b236423,
+    0xdbd96855603b2aa1, 0xb9adf0329833eb92, 0xf94357d0e310372a, 0x6ff7bb9ed8aab6db,
+    0x99f532513ae929b4, 0xd51f04aa80eec8f4, 0x6dd48c50725638a4, 0xb3d54ed9c4092d86,
+    0x3f0b1af263ca4dc6, 0xb02af33cf89469ff, 0x2fc6a0aab0eb0e3d, 0xaa27f4a11bb575da,
+    0xdf8d94e2eb70213c, 0x00badad515fe0525, 0x0dcbd949d38b6927, 0x6fdc587449ea5083,
+    0x2283a8107f631a34, 0x35fc91f0432d63d5, 0x5387b3d181cee7e9, 0xd0745dd04f1e914f,
+};
+
+$on_mod(Loaded) {
+    // Lay out a bunch of generated node trees, check that every one of them 
+    // ends up exactly like it did with the old solver and log how long it took
+    std::mt19937 rng(1907);
+    // Not std::uniform_real_distribution, whose output differs between 
+    // standard libraries. Only 10 bits of randomness so the result is exact 
+    // however the compiler evaluates it
+    auto rand = [&](int min, int max) {
+        return static_cast<float>(min) + static_cast<float>(max - min) * static_cast<float>(rng() >> 22) / 1024.f;
+    };
+
+    // FNV-1a over values rounded to a precision, so differences in the last 
+    // few bits of floating point math between platforms don't count
+    uint64_t fingerprint;
+    auto hashValue = [&](float value, float precision) {
+        auto rounded = static_cast<uint64_t>(std::llround(value / precision));
+        for (int b = 0; b < 8; b += 1) {
+            fingerprint = (fingerprint ^ ((rounded >> (b * 8)) & 0xff)) * 0x100000001b3;
+        }
+    };
+
+    std::vector<int> mismatches;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 200; i += 1) {
+        auto layout = AxisLayout::create(i % 2 ? Axis::Row : Axis::Column)
+            ->setGrowCrossAxis(i % 3 != 0)
+            ->setCrossAxisOverflow(i % 5 == 0)
+            ->setAutoScale(i % 7 != 0)
+            ->setGap(rand(0, 10));
+        auto node = CCNode::create();
+        node->setContentSize({ rand(50, 400), rand(50, 300) });
+        auto count = 1 + i % 60;
+        for (int j = 0; j < count; j += 1) {
+            auto child = CCNode::create();
+            child->setContentSize({ rand(5, 80), rand(5, 40) });
+            child->setLayoutOptions(
+                AxisLayoutOptions::create()
+                    ->setScalePriority(j % 3)
+                    ->setBreakLine(j % 17 == 16),
+                false
+            );
+            node->addChild(child);
+        }
+        node->setLayout(layout);
+
+        fingerprint = 0xcbf29ce484222325;
+        for (auto child : CCArrayExt<CCNode*>(node->getChildren())) {
+            hashValue(child->getPositionX(), .1f);
+            hashValue(child->getPositionY(), .1f);
+            hashValue(child->getScale(), .001f);
+        }
+        hashValue(node->getContentWidth(), .1f);
+        hashValue(node->getContentHeight(), .1f);
+        if (fingerprint != LAYOUT_FINGERPRINTS[i]) {
+            mismatches.push_back(i);
+        }
+    }
+    auto took = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+
+    if (mismatches.empty()) {
+        log::info("Laid out 200 generated layouts in {}us, all match", took);
+    }
+    else {
+        log::error(
+            "Laid out 200 generated layouts in {}us, {} don't match the old solver: {}",
+            took, mismatches.size(), fmt::join(mismatches, ", ")
+        );
+    }
+}
@@ -0,0 +1,334 @@
+#pragma once
+
+// A minimal local HTTP server for testing utils::web and the things built on
+// top of it. Has to be included before anything that pulls in windows.h
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+#include <Geode/Loader.hpp>
+#include <Geode/utils/string.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+    using Socket = SOCKET;
+    static constexpr Socket INVALID_SOCKET_VALUE = INVALID_SOCKET;
+    static void closeSocket(Socket socket) {
+        closesocket(socket);
+    }
+#else
+    using Socket = int;
+    static constexpr Socket INVALID_SOCKET_VALUE = -1;
+    static void closeSocket(Socket socket) {
+        close(socket);
+    }
+#endif
+
+#ifdef MSG_NOSIGNAL
+    static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    static constexpr int SEND_FLAGS = 0;
+#endif
+
+// How the local server behaves, can be changed between scenarios
+struct ServerOptions {
+    // Delay before every response
+    std::chrono::milliseconds latency { 0 };
+    // Bytes per second for every response body, or 0 for no limit
+    size_t bandwidth = 0;
+    // Share of requests whose connection is dropped without an answer
+    double failureRate = 0;
+};
+
+struct LoopbackRequest {
+    std::string method;
+    // Without the query string
+    std::string path;
+    std::string query;
+    // Header names are lowercased
+    std::unordered_map<std::string, std::string> headers;
+
+    std::optional<std::string> header(std::string_view name) const {
+        auto it = headers.find(geode::utils::string::toLower(std::string(name)));
+        if (it == headers.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+};
+
+struct LoopbackResponse {
+    int code = 200;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    // Drop the connection after sending this much of the body, as if the
+    // network went away in the middle of it
+    std::optional<size_t> dropAfter;
+};
+
+/**
+ * A minimal HTTP/1.1 server that answers `GET /bytes/<n>` with n bytes of
+ * data, plus any routes added with `route`, keeping connections open between
+ * requests. Every connection gets its own thread
+ */
+class LoopbackServer final {
+public:
+    using Handler = std::function<LoopbackResponse(LoopbackRequest const&)>;
+
+protected:
+    Socket m_socket = INVALID_SOCKET_VALUE;
+    uint16_t m_port = 0;
+    std::mutex m_mutex;
+    ServerOptions m_options;
+    std::vector<std::pair<std::string, Handler>> m_routes;
+    std::atomic_size_t m_connections = 0;
+    std::atomic_size_t m_liveThreads = 0;
+
+    static bool sendAll(Socket client, char const* data, size_t size) {
+        while (size > 0) {
+            auto sent = send(client, data, static_cast<int>(std::min<size_t>(size, 1 << 20)), SEND_FLAGS);
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= sent;
+        }
+        return true;
+    }
+
+    static std::optional<LoopbackRequest> readRequest(Socket client, std::string& buffer) {
+        char chunk[4096];
+        size_t end;
+        while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            auto received = recv(client, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return std::nullopt;
+            }
+            buffer.append(chunk, received);
+        }
+        auto lines = geode::utils::string::split(buffer.substr(0, end), "\r\n");
+        buffer.erase(0, end + 4);
+
+        // As in "GET /bytes/123?a=b HTTP/1.1"
+        LoopbackRequest request;
+        auto parts = geode::utils::string::split(lines.at(0), " ");
+        if (parts.size() < 2) {
+            return std::nullopt;
+        }
+        request.method = parts[0];
+        request.path = parts[1];
+        if (auto query = request.path.find('?'); query != std::string::npos) {
+            request.query = request.path.substr(query + 1);
+            request.path.erase(query);
+        }
+        for (size_t i = 1; i < lines.size(); i += 1) {
+            auto colon = lines[i].find(':');
+            if (colon != std::string::npos) {
+                request.headers.insert_or_assign(
+                    geode::utils::string::toLower(lines[i].substr(0, colon)),
+                    geode::utils::string::trim(lines[i].substr(colon + 1))
+                );
+            }
+        }
+        return request;
+    }
+
+    static std::string_view reasonPhrase(int code) {
+        switch (code) {
+            case 200: return "OK";
+            case 206: return "Partial Content";
+            case 404: return "Not Found";
+            case 416: return "Range Not Satisfiable";
+            default: return "Unknown";
+        }
+    }
+
+    static bool sendResponse(Socket client, LoopbackResponse const& response) {
+        auto head = fmt::format("HTTP/1.1 {} {}\r\n", response.code, reasonPhrase(response.code));
+        for (auto const& [name, value] : response.headers) {
+            head += fmt::format("{}: {}\r\n", name, value);
+        }
+        head += fmt::format("Content-Length: {}\r\n\r\n", response.body.size());
+        if (!sendAll(client, head.data(), head.size())) {
+            return false;
+        }
+        if (response.dropAfter) {
+            sendAll(client, response.body.data(), std::min(*response.dropAfter, response.body.size()));
+            return false;
+        }
+        return sendAll(client, response.body.data(), response.body.size());
+    }
+
+    bool respond(Socket client, LoopbackRequest const& request, ServerOptions const& options) {
+        static std::string const filler(64 * 1024, 'x');
+
+        std::optional<Handler> handler;
+        {
+            std::unique_lock lock(m_mutex);
+            for (auto const& [prefix, route] : m_routes) {
+                if (request.path.starts_with(prefix)) {
+                    handler = route;
+                    break;
+                }
+            }
+        }
+        if (handler) {
+            std::this_thread::sleep_for(options.latency);
+            return sendResponse(client, (*handler)(request));
+        }
+
+        constexpr std::string_view PREFIX = "/bytes/";
+        if (!request.path.starts_with(PREFIX)) {
+            return sendResponse(client, LoopbackResponse { .code = 404 });
+        }
+        auto size = geode::utils::numFromString<size_t>(
+            std::string_view(request.path).substr(PREFIX.size())
+        ).unwrapOr(0);
+
+        std::this_thread::sleep_for(options.latency);
+
+        auto header = fmt::format(
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/octet-stream\r\n"
+            "Content-Length: {}\r\n\r\n",
+            size
+        );
+        if (!sendAll(client, header.data(), header.size())) {
+            return false;
+        }
+
+        // Send the body in pieces, waiting between them to stay under the
+        // bandwidth limit
+        auto pieceSize = options.bandwidth ?
+            std::clamp<size_t>(options.bandwidth / 20, 1, filler.size()) :
+            filler.size();
+        auto start = std::chrono::steady_clock::now();
+        size_t sent = 0;
+        while (sent < size) {
+            auto piece = std::min(pieceSize, size - sent);
+            if (!sendAll(client, filler.data(), piece)) {
+                return false;
+            }
+            sent += piece;
+            if (options.bandwidth) {
+                std::this_thread::sleep_until(start + std::chrono::microseconds(
+                    sent * 1'000'000 / options.bandwidth
+                ));
+            }
+        }
+        return true;
+    }
+
+    void serve(Socket client) {
+        std::minstd_rand random(std::random_device{}());
+        std::uniform_real_distribution<double> chance(0, 1);
+        std::string buffer;
+        while (auto request = readRequest(client, buffer)) {
+            ServerOptions options;
+            {
+                std::unique_lock lock(m_mutex);
+                options = m_options;
+            }
+            if (options.failureRate > 0 && chance(random) < options.failureRate) {
+                break;
+            }
+            if (!this->respond(client, *request, options)) {
+                break;
+            }
+        }
+        closeSocket(client);
+        m_liveThreads -= 1;
+    }
+
+public:
+    static LoopbackServer* get() {
+        static auto inst = new LoopbackServer();
+        return inst;
+    }
+
+    /**
+     * Start listening on 127.0.0.1
+     * @param port Port to listen on, or 0 to pick any free one
+     */
+    geode::Result<> start(uint16_t port = 0) {
+#ifdef _WIN32
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+            return geode::Err("Unable to initialize sockets");
+        }
+#endif
+        m_socket = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_socket == INVALID_SOCKET_VALUE) {
+            return geode::Err("Unable to create socket");
+        }
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            return geode::Err("Unable to bind socket");
+        }
+        if (listen(m_socket, 256) != 0) {
+            return geode::Err("Unable to listen on socket");
+        }
+        socklen_t length = sizeof(address);
+        getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &length);
+        m_port = ntohs(address.sin_port);
+
+        std::thread([this] {
+            geode::utils::thread::setName("Loopback Server");
+            while (true) {
+                auto client = accept(m_socket, nullptr, nullptr);
+                if (client == INVALID_SOCKET_VALUE) {
+                    continue;
+                }
+#ifdef SO_NOSIGPIPE
+                int on = 1;
+                setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+                m_connections += 1;
+                m_liveThreads += 1;
+                std::thread(&LoopbackServer::serve, this, client).detach();
+            }
+        }).detach();
+        return geode::Ok();
+    }
+
+    void setOptions(ServerOptions const& options) {
+        std::unique_lock lock(m_mutex);
+        m_options = options;
+    }
+    /**
+     * Answer requests whose path starts with `prefix` with `handler`, which
+     * is called on the connection's thread. Routes are checked in the order
+     * they were added
+     */
+    void route(std::string prefix, Handler handler) {
+        std::unique_lock lock(m_mutex);
+        m_routes.emplace_back(std::move(prefix), std::move(handler));
+    }
+
+    std::string url(std::string_view path) const {
+        return fmt::format("http://127.0.0.1:{}{}", m_port, path);
+    }
+    size_t getConnections() const {
+        return m_connections;
+    }
+    size_t getLiveThreads() const {
+        return m_liveThreads;
+    }
+};
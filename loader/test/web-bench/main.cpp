@@ -0,0 +1,237 @@
+// Benchmarks for utils::web. Starts a local HTTP server on 127.0.0.1 and
+// runs a few request patterns the loader and mods commonly produce against
+// it, logging latency, throughput, threads and memory for each. Only runs
+// when the game is launched with --geode:geode.web-bench.run
+
+// The server has to be included before anything pulls in windows.h
+#include "LoopbackServer.hpp"
+
+#include <Geode/Loader.hpp>
+#include <Geode/utils/string.hpp>
+#include <Geode/utils/web.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#ifdef GEODE_IS_WINDOWS
+    #include <psapi.h>
+    #include <tlhelp32.h>
+#endif
+#ifdef GEODE_IS_MACOS
+    #include <mach/mach.h>
+#endif
+
+using namespace geode::prelude;
+using Clock = std::chrono::steady_clock;
+
+struct ProcessStats {
+    size_t threads = 0;
+    size_t residentBytes = 0;
+};
+
+static ProcessStats sampleProcess() {
+    ProcessStats stats;
+#if defined(GEODE_IS_WINDOWS)
+    auto snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot != INVALID_HANDLE_VALUE) {
+        THREADENTRY32 entry = {};
+        entry.dwSize = sizeof(entry);
+        auto pid = GetCurrentProcessId();
+        for (auto ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry)) {
+            if (entry.th32OwnerProcessID == pid) {
+                stats.threads += 1;
+            }
+        }
+        CloseHandle(snapshot);
+    }
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        stats.residentBytes = counters.WorkingSetSize;
+    }
+#elif defined(GEODE_IS_MACOS)
+    thread_act_array_t threads;
+    mach_msg_type_number_t threadCount = 0;
+    if (task_threads(mach_task_self(), &threads, &threadCount) == KERN_SUCCESS) {
+        stats.threads = threadCount;
+        for (mach_msg_type_number_t i = 0; i < threadCount; i += 1) {
+            mach_port_deallocate(mach_task_self(), threads[i]);
+        }
+        vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(threads), sizeof(thread_t) * threadCount);
+    }
+    mach_task_basic_info_data_t info = {};
+    mach_msg_type_number_t infoCount = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &infoCount) == KERN_SUCCESS) {
+        stats.residentBytes = info.resident_size;
+    }
+#else
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.starts_with("Threads:")) {
+            stats.threads = numFromString<size_t>(utils::string::trim(line.substr(8))).unwrapOr(0);
+        }
+        else if (line.starts_with("VmRSS:")) {
+            auto kb = utils::string::trim(line.substr(6));
+            kb = kb.substr(0, kb.find(' '));
+            stats.residentBytes = numFromString<size_t>(kb).unwrapOr(0) * 1024;
+        }
+    }
+#endif
+    return stats;
+}
+
+struct Scenario {
+    std::string name;
+    ServerOptions server;
+    std::string path;
+    size_t requests;
+    // How many requests are kept running at once
+    size_t concurrency;
+    // Cancel requests that have been running for this long
+    std::optional<std::chrono::milliseconds> cancelAfter;
+    // Download into files instead of memory
+    bool toFile = false;
+};
+
+static double percentile(std::vector<double> const& sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+static void runScenario(Scenario const& scenario) {
+    using namespace std::chrono_literals;
+
+    auto server = LoopbackServer::get();
+    server->setOptions(scenario.server);
+
+    struct Running {
+        web::WebTask task;
+        Clock::time_point started;
+        std::filesystem::path file;
+    };
+    std::vector<Running> running;
+    std::vector<double> latencies;
+    size_t failed = 0;
+    size_t cancelled = 0;
+    size_t bytes = 0;
+
+    // Server threads live in the same process, so leave them out of the count
+    auto clientThreads = [&](ProcessStats const& stats) {
+        return static_cast<ptrdiff_t>(stats.threads) - static_cast<ptrdiff_t>(server->getLiveThreads());
+    };
+    auto baseline = sampleProcess();
+    auto connectionsBefore = server->getConnections();
+    ptrdiff_t peakThreads = 0;
+    ptrdiff_t peakMemory = 0;
+    auto lastSample = Clock::time_point();
+
+    auto start = Clock::now();
+    size_t next = 0;
+    while (next < scenario.requests || !running.empty()) {
+        while (next < scenario.requests && running.size() < scenario.concurrency) {
+            auto req = web::WebRequest();
+            req.timeout(30s);
+            std::filesystem::path file;
+            if (scenario.toFile) {
+                file = dirs::getTempDir() / fmt::format("web-bench-{}.bin", next);
+                req.downloadInto(file);
+            }
+            running.push_back({ req.get(server->url(scenario.path)), Clock::now(), file });
+            next += 1;
+        }
+
+        auto now = Clock::now();
+        for (auto it = running.begin(); it != running.end();) {
+            if (it->task.isPending()) {
+                if (scenario.cancelAfter && now - it->started >= *scenario.cancelAfter) {
+                    it->task.cancel();
+                }
+                ++it;
+                continue;
+            }
+            if (auto response = it->task.getFinishedValue()) {
+                latencies.push_back(std::chrono::duration<double, std::milli>(now - it->started).count());
+                if (response->ok()) {
+                    // The body isn't kept for downloads into files, so go by
+                    // the reported size
+                    if (auto length = response->header("Content-Length")) {
+                        bytes += numFromString<size_t>(*length).unwrapOr(0);
+                    }
+                }
+                else {
+                    failed += 1;
+                }
+            }
+            else {
+                cancelled += 1;
+            }
+            if (!it->file.empty()) {
+                std::error_code ec;
+                std::filesystem::remove(it->file, ec);
+            }
+            it = running.erase(it);
+        }
+
+        // Sampling the process isn't free, so don't do it on every check
+        if (now - lastSample >= 10ms) {
+            lastSample = now;
+            auto stats = sampleProcess();
+            peakThreads = std::max(peakThreads, clientThreads(stats) - clientThreads(baseline));
+            peakMemory = std::max(
+                peakMemory,
+                static_cast<ptrdiff_t>(stats.residentBytes) - static_cast<ptrdiff_t>(baseline.residentBytes)
+            );
+        }
+        std::this_thread::sleep_for(500us);
+    }
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    log::info("{}: {} requests, {} failed, {} cancelled", scenario.name, scenario.requests, failed, cancelled);
+    log::NestScope nest;
+    log::info("Latency: p50 {:.1f} ms, p99 {:.1f} ms", percentile(latencies, .5), percentile(latencies, .99));
+    log::info("Throughput: {:.1f} MB/s ({:.1f} MB in {:.2f} s)", bytes / seconds / 1e6, bytes / 1e6, seconds);
+    log::info(
+        "Peak: {} extra threads, {:.1f} MB extra memory; {} connections opened",
+        peakThreads, peakMemory / 1e6, server->getConnections() - connectionsBefore
+    );
+}
+
+$on_mod(Loaded) {
+    if (!Mod::get()->getLaunchFlag("run")) {
+        return;
+    }
+    std::thread([] {
+        using namespace std::chrono_literals;
+        utils::thread::setName("Web Benchmark");
+
+        auto server = LoopbackServer::get();
+        if (auto res = server->start(); !res) {
+            log::error("Unable to start server: {}", res.unwrapErr());
+            return;
+        }
+        log::info("Running web benchmarks against {}", server->url("/"));
+
+        std::vector<Scenario> scenarios = {
+            // Opening the mods list loads a page of logos at once
+            { .name = "Logo burst", .server = { .latency = 20ms }, .path = "/bytes/30000", .requests = 50, .concurrency = 50 },
+            { .name = "API calls", .server = { .latency = 50ms }, .path = "/bytes/2000", .requests = 200, .concurrency = 16 },
+            { .name = "Large download", .path = "/bytes/104857600", .requests = 1, .concurrency = 1 },
+            { .name = "Large download to file", .path = "/bytes/104857600", .requests = 1, .concurrency = 1, .toFile = true },
+            // Scrolling quickly through the mods list cancels most requests it starts
+            {
+                .name = "Cancellation storm", .server = { .bandwidth = 256 * 1024 }, .path = "/bytes/1048576",
+                .requests = 100, .concurrency = 100, .cancelAfter = 100ms
+            },
+            {
+                .name = "Flaky server", .server = { .latency = 10ms, .failureRate = .2 }, .path = "/bytes/10000",
+                .requests = 100, .concurrency = 16
+            },
+        };
+        for (auto const& scenario : scenarios) {
+            runScenario(scenario);
+        }
+        log::info("Web benchmarks finished");
+    }).detach();
+}
@@ -0,0 +1,135 @@
+// Benchmarks for utils::file::Unzip. Generates a zip with 10k entries laid
+// out like the index or a large resource pack, then times opening it, looking
+// entries up, extracting them into memory and extracting the whole thing to
+// disk, both on one thread and on as many as it wants. Only runs when the
+// game is launched with --geode:geode.zip-bench.run
+
+#include <Geode/Loader.hpp>
+#include <Geode/utils/file.hpp>
+#include <chrono>
+#include <random>
+#include <thread>
+
+using namespace geode::prelude;
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t ENTRY_COUNT = 10000;
+static constexpr size_t FOLDER_COUNT = 100;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static void logResult(std::string_view name, size_t entries, size_t bytes, double seconds) {
+    log::info("{}: {:.2f} s", name, seconds);
+    log::NestScope nest;
+    log::info("{:.0f} entries/s, {:.1f} MB/s", entries / seconds, bytes / seconds / 1e6);
+}
+
+// Mostly small json and text files with a few larger ones mixed in, which is
+// roughly what the index and resource packs look like
+static Result<size_t> createZip(std::filesystem::path const& path) {
+    GEODE_UNWRAP_INTO(auto zip, file::Zip::create(path));
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<size_t> smallSize(200, 4000);
+    std::uniform_int_distribution<int> chance(0, 99);
+    size_t bytes = 0;
+    for (size_t i = 0; i < ENTRY_COUNT; i += 1) {
+        auto size = chance(rng) < 2 ? 256 * 1024 : smallSize(rng);
+        std::string data;
+        data.reserve(size);
+        while (data.size() < size) {
+            data += fmt::format("{{\"entry\": {}, \"value\": {}}}\n", i, rng());
+        }
+        GEODE_UNWRAP(zip.add(fmt::format("folder-{}/entry-{}.json", i % FOLDER_COUNT, i), data));
+        bytes += data.size();
+    }
+    return Ok(bytes);
+}
+
+static Result<> runBenchmarks(std::filesystem::path const& dir) {
+    auto zipPath = dir / "bench.zip";
+    auto start = Clock::now();
+    GEODE_UNWRAP_INTO(auto bytes, createZip(zipPath));
+    log::info(
+        "Created {} entries ({:.1f} MB) in {:.2f} s",
+        ENTRY_COUNT, bytes / 1e6, secondsSince(start)
+    );
+
+    start = Clock::now();
+    GEODE_UNWRAP_INTO(auto unzip, file::Unzip::create(zipPath));
+    logResult("Open", ENTRY_COUNT, 0, secondsSince(start));
+
+    auto entries = unzip.getEntries();
+    start = Clock::now();
+    size_t found = 0;
+    for (auto const& entry : entries) {
+        found += unzip.hasEntry(entry);
+    }
+    logResult("Look up every entry", found, 0, secondsSince(start));
+
+    start = Clock::now();
+    for (auto const& entry : entries) {
+        GEODE_UNWRAP(unzip.extract(entry));
+    }
+    logResult("Extract every entry to memory", entries.size(), bytes, secondsSince(start));
+
+    // Reuses one buffer instead of allocating one per entry
+    start = Clock::now();
+    ByteVector buffer;
+    for (auto const& entry : entries) {
+        GEODE_UNWRAP_INTO(auto size, unzip.getEntrySize(entry));
+        buffer.resize(size);
+        GEODE_UNWRAP(unzip.extractInto(entry, buffer));
+    }
+    logResult("Extract every entry into one buffer", entries.size(), bytes, secondsSince(start));
+
+    size_t progressCalls = 0;
+    unzip.setProgressCallback([&](uint32_t, uint32_t) {
+        progressCalls += 1;
+    });
+
+    // Serial baseline for the multithreaded extraction below
+    unzip.setMaxWorkerCount(1);
+    start = Clock::now();
+    GEODE_UNWRAP(unzip.extractAllTo(dir / "extracted-serial"));
+    logResult("Extract all to disk on one thread", entries.size(), bytes, secondsSince(start));
+
+    progressCalls = 0;
+    unzip.setMaxWorkerCount(0);
+    start = Clock::now();
+    GEODE_UNWRAP(unzip.extractAllTo(dir / "extracted"));
+    logResult("Extract all to disk", entries.size(), bytes, secondsSince(start));
+    log::info(
+        "({} progress updates on {} hardware threads)",
+        progressCalls, std::thread::hardware_concurrency()
+    );
+
+    return Ok();
+}
+
+$on_mod(Loaded) {
+    if (!Mod::get()->getLaunchFlag("run")) {
+        return;
+    }
+    std::thread([] {
+        utils::thread::setName("Zip Benchmark");
+
+        auto dir = dirs::getTempDir() / "zip-bench";
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        if (auto res = file::createDirectoryAll(dir); !res) {
+            log::error("Unable to create {}: {}", dir, res.unwrapErr());
+            return;
+        }
+
+        log::info("Running zip benchmarks in {}", dir);
+        if (auto res = runBenchmarks(dir); !res) {
+            log::error("Zip benchmark failed: {}", res.unwrapErr());
+        }
+        else {
+            log::info("Zip benchmarks finished");
+        }
+        std::filesystem::remove_all(dir, ec);
+    }).detach();
+}